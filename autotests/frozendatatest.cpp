@@ -0,0 +1,162 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Concurrent reads of frozen profile data
+ */
+
+#include <QBuffer>
+#include <QList>
+#include <QThread>
+#include <QtTest>
+
+#include "coverage.h"
+#include "dominators.h"
+#include "eventtype.h"
+#include "groupcallgraph.h"
+#include "memorycheck.h"
+#include "tracedata.h"
+
+/*
+ * Sums up everything a view may read from frozen data: function and
+ * call costs for all event types (real and derived), edges of the
+ * file call graph, dominated cost and coverage.
+ *
+ * Run this under ThreadSanitizer (-DECM_ENABLE_SANITIZERS=thread) to
+ * check that freeze() leaves no lazily filled cache behind.
+ */
+static double checksum(TraceData* d)
+{
+    EventTypeSet* types = d->eventTypes();
+    int typeCount = types->realCount() + types->derivedCount();
+    double sum = 0.0;
+
+    for (int i = 0; i < typeCount; i++) {
+        EventType* t = (i < types->realCount()) ?
+            types->realType(i) :
+            types->derivedType(i - types->realCount());
+
+        TraceFunctionMap::Iterator it;
+        for ( it = d->functionMap().begin();
+              it != d->functionMap().end(); ++it ) {
+            TraceFunction* f = &(*it);
+            sum += f->subCost(t);
+            sum += f->inclusive()->subCost(t);
+            sum += d->dominators()->dominatedCost(f, t);
+            foreach(TraceCall* c, f->callings())
+                sum += c->subCost(t) + c->callCount();
+        }
+
+        GroupCallGraph* g = d->groupCallGraph(ProfileContext::File);
+        foreach(GroupCallEdge* e, g->edges())
+            sum += e->subCost(t) + e->callCount();
+    }
+
+    // coverage of the function with the highest inclusive cost
+    TraceFunction* top = nullptr;
+    TraceFunctionMap::Iterator it;
+    for ( it = d->functionMap().begin();
+          it != d->functionMap().end(); ++it ) {
+        if (!top || (*it).inclusive()->subCost(types->realType(0)) >
+            top->inclusive()->subCost(types->realType(0)))
+            top = &(*it);
+    }
+    CoverageMap map;
+    Coverage::coverage(top, Coverage::Called, types->realType(0), &map);
+    foreach(Coverage* c, map)
+        sum += c->inclusive() + c->callCount();
+    qDeleteAll(map);
+    return sum;
+}
+
+class ReadThread: public QThread
+{
+public:
+    ReadThread(TraceData* d, double reference, int rounds)
+    { _data = d; _reference = reference; _rounds = rounds; _mismatches = 0; }
+
+    int mismatches() const { return _mismatches; }
+
+protected:
+    void run() override
+    {
+        for (int r = 0; r < _rounds; r++)
+            if (checksum(_data) != _reference) _mismatches++;
+    }
+
+private:
+    TraceData* _data;
+    double _reference;
+    int _rounds, _mismatches;
+};
+
+class FrozenDataTest: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void concurrentReads();
+
+private:
+    TraceData* _data;
+};
+
+void FrozenDataTest::initTestCase()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    MemoryCheck::generateProfile(&buffer, 2000);
+    buffer.seek(0);
+
+    _data = new TraceData();
+    QVERIFY(_data->load(&buffer, QStringLiteral("generated")) > 0);
+    _data->eventTypes()->addKnownDerivedTypes();
+    _data->eventTypes()->add(new EventType(QStringLiteral("DA"),
+                                           QStringLiteral("Data Accesses"),
+                                           QStringLiteral("Dr + Dw")));
+    _data->freeze();
+}
+
+void FrozenDataTest::cleanupTestCase()
+{
+    delete _data;
+}
+
+void FrozenDataTest::concurrentReads()
+{
+    const int threadCount = 8;
+    double reference = checksum(_data);
+    QVERIFY(reference > 0.0);
+
+    QList<ReadThread*> threads;
+    for (int i = 0; i < threadCount; i++)
+        threads.append(new ReadThread(_data, reference, 2));
+    foreach(ReadThread* t, threads)
+        t->start();
+    foreach(ReadThread* t, threads) {
+        t->wait();
+        QCOMPARE(t->mismatches(), 0);
+    }
+    qDeleteAll(threads);
+}
+
+QTEST_GUILESS_MAIN(FrozenDataTest)
+
+#include "frozendatatest.moc"
@@ -0,0 +1,286 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Scheduler of parallel jobs and task groups
+ */
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QtTest>
+
+#include "parallel.h"
+
+/* Marks every index it is run on, and records the highest worker */
+class MarkJob: public ParallelJob
+{
+public:
+    explicit MarkJob(int count)
+        : marks(count), maxWorker(-1)
+    {}
+
+    void run(int from, int to, int worker) override
+    {
+        for(int i=from; i<to; i++)
+            marks[i].ref();
+        int m = maxWorker.loadAcquire();
+        while((worker > m) && !maxWorker.testAndSetOrdered(m, worker))
+            m = maxWorker.loadAcquire();
+    }
+
+    QVector<QAtomicInt> marks;
+    QAtomicInt maxWorker;
+};
+
+/* Collects chunk starts, and remembers which worker ran which chunk */
+class OrderJob: public ParallelReduceJob<QVector<int> >
+{
+public:
+    OrderJob()
+        : ParallelReduceJob<QVector<int> >(QVector<int>()),
+          chunks(workers())
+    {}
+
+    void reduce(int from, int, QVector<int>& acc) override
+    { acc.append(from); }
+
+    void run(int from, int to, int worker) override
+    {
+        {
+            QMutexLocker locker(&mutex);
+            chunks[worker].append(from);
+        }
+        ParallelReduceJob<QVector<int> >::run(from, to, worker);
+    }
+
+    QMutex mutex;
+    QVector<QVector<int> > chunks;
+};
+
+/* Runs an inner job for every index, summing up inner indexes */
+class InnerJob: public ParallelJob
+{
+public:
+    explicit InnerJob(QAtomicInt* sum) { _sum = sum; }
+
+    void run(int from, int to, int) override
+    {
+        for(int i=from; i<to; i++)
+            _sum->fetchAndAddOrdered(i);
+    }
+
+private:
+    QAtomicInt* _sum;
+};
+
+class InnerTask: public ParallelTask
+{
+public:
+    explicit InnerTask(QAtomicInt* sum) { _sum = sum; }
+
+    void run() override
+    {
+        InnerJob job(_sum);
+        Parallel::run(&job, 100, 1);
+    }
+
+private:
+    QAtomicInt* _sum;
+};
+
+class OuterJob: public ParallelJob
+{
+public:
+    explicit OuterJob(QAtomicInt* sum) { _sum = sum; }
+
+    void run(int from, int to, int) override
+    {
+        for(int i=from; i<to; i++) {
+            // nested job, and nested task group running nested jobs
+            InnerJob job(_sum);
+            Parallel::run(&job, 100, 1);
+
+            InnerTask t1(_sum), t2(_sum);
+            ParallelTaskGroup group;
+            group.add(&t1);
+            group.add(&t2);
+            group.wait();
+        }
+    }
+
+private:
+    QAtomicInt* _sum;
+};
+
+/* Cancels the job when reaching index <at> */
+class CancelJob: public ParallelJob
+{
+public:
+    CancelJob(ParallelCancel* cancel, int at)
+    { _cancel = cancel; _at = at; }
+
+    void run(int from, int to, int) override
+    {
+        for(int i=from; i<to; i++) {
+            done.ref();
+            if (i == _at) _cancel->cancel();
+        }
+    }
+
+    QAtomicInt done;
+
+private:
+    ParallelCancel* _cancel;
+    int _at;
+};
+
+class CountTask: public ParallelTask
+{
+public:
+    explicit CountTask(QAtomicInt* count) { _count = count; }
+
+    void run() override { _count->ref(); }
+
+private:
+    QAtomicInt* _count;
+};
+
+class ParallelTest: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanupTestCase();
+    void allIndexesOnce();
+    void workersClamp();
+    void reduceCombineOrder();
+    void nesting();
+    void cancelJob();
+    void cancelTaskGroup();
+};
+
+void ParallelTest::init()
+{
+    // worker counts set by tests are overridden by the environment
+    if (qEnvironmentVariableIsSet("KCACHEGRIND_THREADS"))
+        QSKIP("KCACHEGRIND_THREADS is set");
+    Parallel::setWorkerCount(4);
+}
+
+void ParallelTest::cleanupTestCase()
+{
+    Parallel::setWorkerCount(0);
+}
+
+void ParallelTest::allIndexesOnce()
+{
+    MarkJob job(10000);
+    QVERIFY(Parallel::run(&job, 10000, 7));
+    for(int i=0; i<10000; i++)
+        QCOMPARE(job.marks[i].loadAcquire(), 1);
+}
+
+void ParallelTest::workersClamp()
+{
+    // storage of the job is sized for 2 workers
+    Parallel::setWorkerCount(2);
+    MarkJob job(1000);
+    QCOMPARE(job.workers(), 2);
+
+    Parallel::setWorkerCount(8);
+    QVERIFY(Parallel::run(&job, 1000, 1));
+    QVERIFY(job.maxWorker.loadAcquire() < 2);
+    for(int i=0; i<1000; i++)
+        QCOMPARE(job.marks[i].loadAcquire(), 1);
+}
+
+void ParallelTest::reduceCombineOrder()
+{
+    OrderJob job;
+    QVERIFY(Parallel::run(&job, 1000, 1));
+
+    // partial results are combined in worker order, and chunks of
+    // one worker are taken in increasing order
+    QVector<int> expected;
+    for(int w=0; w<job.chunks.count(); w++)
+        expected += job.chunks.at(w);
+    QCOMPARE(job.result(), expected);
+    QCOMPARE(expected.count(), 1000);
+}
+
+void ParallelTest::nesting()
+{
+    // less workers than nesting levels must not dead-lock
+    Parallel::setWorkerCount(2);
+    QAtomicInt sum;
+    OuterJob job(&sum);
+    QVERIFY(Parallel::run(&job, 20, 1));
+
+    // each outer index: one inner job and two tasks with a job each
+    QCOMPARE(sum.loadAcquire(), 20 * 3 * 4950);
+}
+
+void ParallelTest::cancelJob()
+{
+    // single worker: chunks run in order, all after index 100 skipped
+    Parallel::setWorkerCount(1);
+    ParallelCancel cancel;
+    CancelJob job(&cancel, 100);
+    QVERIFY(!Parallel::run(&job, 1000, 1, &cancel));
+    QCOMPARE(job.done.loadAcquire(), 101);
+
+    // with more workers, only chunks in progress finish
+    Parallel::setWorkerCount(4);
+    cancel.reset();
+    CancelJob job2(&cancel, 100);
+    QVERIFY(!Parallel::run(&job2, 100000, 1, &cancel));
+    QVERIFY(job2.done.loadAcquire() < 100000);
+}
+
+void ParallelTest::cancelTaskGroup()
+{
+    QAtomicInt count;
+    ParallelCancel cancel;
+    cancel.cancel();
+
+    QVector<CountTask*> tasks;
+    ParallelTaskGroup group(&cancel);
+    for(int i=0; i<50; i++) {
+        tasks.append(new CountTask(&count));
+        group.add(tasks.last());
+    }
+    QVERIFY(!group.wait());
+    QCOMPARE(count.loadAcquire(), 0);
+    qDeleteAll(tasks);
+
+    // without cancellation, all tasks run
+    cancel.reset();
+    ParallelTaskGroup group2(&cancel);
+    CountTask t(&count);
+    for(int i=0; i<50; i++)
+        group2.add(&t);
+    QVERIFY(group2.wait());
+    QCOMPARE(count.loadAcquire(), 50);
+}
+
+QTEST_GUILESS_MAIN(ParallelTest)
+
+#include "paralleltest.moc"
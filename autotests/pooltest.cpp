@@ -0,0 +1,177 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Pools for small objects: merging and chunk growth of FixPool
+ */
+
+#include <QVector>
+#include <QtTest>
+
+#include "parallel.h"
+#include "pool.h"
+
+/* Allocates <count> objects, each filled with its index */
+static QVector<quint64*> fill(FixPool* pool, int count, quint64 tag)
+{
+    QVector<quint64*> objects;
+    for(int i=0; i<count; i++) {
+        quint64* o = (quint64*) pool->allocate(4 * sizeof(quint64));
+        for(int j=0; j<4; j++)
+            o[j] = tag + i;
+        objects.append(o);
+    }
+    return objects;
+}
+
+static bool check(const QVector<quint64*>& objects, quint64 tag)
+{
+    for(int i=0; i<objects.count(); i++)
+        for(int j=0; j<4; j++)
+            if (objects[i][j] != tag + i) return false;
+    return true;
+}
+
+/* Every worker fills its own pool, like a parallel load would */
+class FillJob: public ParallelJob
+{
+public:
+    FillJob()
+        : pools(workers()), objects(workers())
+    {
+        for(int w=0; w<workers(); w++)
+            pools[w] = new FixPool;
+    }
+    ~FillJob() override { qDeleteAll(pools); }
+
+    void run(int from, int to, int worker) override
+    {
+        for(int i=from; i<to; i++)
+            objects[worker] += fill(pools[worker], 1000, (quint64) i << 32);
+    }
+
+    QVector<FixPool*> pools;
+    QVector<QVector<quint64*> > objects;
+};
+
+class PoolTest: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void mergeKeepsObjects();
+    void mergeIntoEmpty();
+    void mergeNothing();
+    void mergeWorkerPools();
+    void chunkGrowth();
+};
+
+void PoolTest::mergeKeepsObjects()
+{
+    FixPool pool, other;
+    QVector<quint64*> a = fill(&pool, 10000, 1);
+    QVector<quint64*> b = fill(&other, 20000, 100000);
+    quint64 size = pool.size() + other.size();
+    quint64 capacity = pool.capacity() + other.capacity();
+
+    pool.merge(&other);
+    QCOMPARE(pool.count(), quint64(30000));
+    QCOMPARE(pool.size(), size);
+    QCOMPARE(pool.capacity(), capacity);
+    QCOMPARE(other.count(), quint64(0));
+    QCOMPARE(other.size(), quint64(0));
+    QCOMPARE(other.capacity(), quint64(0));
+    QVERIFY(check(a, 1));
+    QVERIFY(check(b, 100000));
+
+    // both pools stay usable; free space of our last chunk is reused
+    QVector<quint64*> c = fill(&pool, 10, 500000);
+    QCOMPARE(pool.capacity(), capacity);
+    QVector<quint64*> d = fill(&other, 10, 600000);
+    QVERIFY(check(a, 1));
+    QVERIFY(check(b, 100000));
+    QVERIFY(check(c, 500000));
+    QVERIFY(check(d, 600000));
+}
+
+void PoolTest::mergeIntoEmpty()
+{
+    FixPool pool, other;
+    QVector<quint64*> a = fill(&other, 5000, 7);
+
+    pool.merge(&other);
+    QCOMPARE(pool.count(), quint64(5000));
+    QVector<quint64*> b = fill(&pool, 5000, 9);
+    QCOMPARE(pool.count(), quint64(10000));
+    QVERIFY(check(a, 7));
+    QVERIFY(check(b, 9));
+}
+
+void PoolTest::mergeNothing()
+{
+    FixPool pool, empty;
+    QVector<quint64*> a = fill(&pool, 100, 3);
+    quint64 capacity = pool.capacity();
+
+    pool.merge(&empty);
+    pool.merge(&pool);
+    pool.merge(nullptr);
+    QCOMPARE(pool.count(), quint64(100));
+    QCOMPARE(pool.capacity(), capacity);
+    QVERIFY(check(a, 3));
+}
+
+void PoolTest::mergeWorkerPools()
+{
+    FillJob job;
+    QVERIFY(Parallel::run(&job, 64, 1));
+
+    FixPool pool;
+    foreach(FixPool* p, job.pools)
+        pool.merge(p);
+    QCOMPARE(pool.count(), quint64(64 * 1000));
+
+    // objects of all workers survive deleting their (now empty) pools
+    qDeleteAll(job.pools);
+    job.pools.clear();
+    int found = 0;
+    foreach(const QVector<quint64*>& objects, job.objects) {
+        for(int i=0; i<objects.count(); i++) {
+            quint64 v = objects[i][0];
+            QCOMPARE(v & 0xffffffff, quint64(i % 1000));
+            for(int j=1; j<4; j++)
+                QCOMPARE(objects[i][j], v);
+        }
+        found += objects.count();
+    }
+    QCOMPARE(found, 64 * 1000);
+}
+
+void PoolTest::chunkGrowth()
+{
+    // chunks grow by at most 1/8 of the space already allocated
+    FixPool pool;
+    for(int i=0; i<8; i++) {
+        fill(&pool, 128 * 1024, 0);
+        QVERIFY(pool.capacity() - pool.size() <= pool.size() / 8 + 200000);
+    }
+}
+
+QTEST_GUILESS_MAIN(PoolTest)
+
+#include "pooltest.moc"
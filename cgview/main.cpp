@@ -16,14 +16,31 @@
    Boston, MA 02110-1301, USA.
 */
 
+#include <algorithm>
+
+#include <QBuffer>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QTextStream>
+#include <QVector>
 
 #include "tracedata.h"
 #include "loader.h"
 #include "config.h"
 #include "globalconfig.h"
 #include "logger.h"
+#include "hotlines.h"
+#include "dominators.h"
+#include "addressindex.h"
+#include "loadstats.h"
+#include "warehouse.h"
+#include "parallel.h"
+#include "phasedetection.h"
+#include "fleetstats.h"
+#include "inlinedindex.h"
+#include "memorycheck.h"
+#include "costkernels.h"
 
 /*
  * Just a simple command line tool using libcore
@@ -42,12 +59,450 @@ void showHelp(QTextStream& out, bool fullHelp = true)
                " -e        Sort list according to exclusive cost\n"
                " -s <ev>   Sort and show counters for event <ev>\n"
                " -c        Sort by call count\n"
+               " -d        Sort by dominated cost, show immediate dominator\n"
                " -b        Show butterfly (callers and callees)\n"
-               " -n        Do not detect recursive cycles" << endl;
+               " -n        Do not detect recursive cycles\n"
+               " -l <n>    Show <n> hottest source lines per event type\n"
+               " -i <n>    Show <n> hottest ranges of inlined code\n"
+               " -a <addr> Show function containing hex address <addr>\n"
+               " -p <pct>  Fold functions below <pct> percent into '(other)'\n"
+               " -j <n>    Use <n> worker threads (0: number of CPU cores)\n"
+               " --stats   Show loading statistics, diagnostics and\n"
+               "           utilization of worker threads\n"
+               " --phases <n>  Split parts into at most <n> program phases\n"
+               " --fleet <n>   Load each file as one host, at most <n> in parallel,\n"
+               "           and show percentiles of normalized function costs\n"
+               " --freeze-check <n>  Freeze data and compare <n> rounds of\n"
+               "           concurrent cost reads with sequential ones\n"
+               " --memcheck <n>  Load <n> generated profiles of doubling size\n"
+               "           (no profile files needed), fail if over memory budget\n"
+               " --kernel-bench <n>  Time adding/maximizing <n> million costs per\n"
+               "           vector length: scalar loop vs. selected SIMD kernel\n"
+               " --dominator-bench <n>  Time dominator calculation on a generated\n"
+               "           profile with <n> functions (no profile files needed)\n"
+               "\nRun warehouse (directory <dir>, no profile files needed for queries):\n"
+               " --store <dir>              Add loaded profile as new run\n"
+               " --runs <dir>               List runs\n"
+               " --history <dir> <fn>       Show costs of function <fn> over all runs\n"
+               " --movers <dir> <r1> <r2>   Functions with largest change from run\n"
+               "                            <r1> to <r2> (negative: from last run)\n"
+               "                            by inclusive cost, or -e / -c metric" << endl;
 
     exit(1);
 }
 
+// reads costs of functions and their calls for all event types
+class CostReadJob: public ParallelReduceJob<uint64>
+{
+public:
+    CostReadJob(const QList<TraceFunction*>& functions,
+                const QList<EventType*>& types)
+        : ParallelReduceJob<uint64>(0), _functions(functions), _types(types)
+    {}
+
+    void reduce(int from, int to, uint64& sum) override
+    {
+        for(int i=from; i<to; i++) {
+            TraceFunction* f = _functions.at(i);
+            sum += f->calledCount();
+            foreach(EventType* et, _types) {
+                sum += f->subCost(et) + f->inclusive()->subCost(et);
+                foreach(TraceCall* c, f->callings())
+                    sum += c->subCost(et);
+            }
+        }
+    }
+
+private:
+    const QList<TraceFunction*>& _functions;
+    const QList<EventType*>& _types;
+};
+
+// sums up timing of parallel jobs for --stats
+class ParallelStats: public ParallelObserver
+{
+public:
+    ParallelStats()
+        : _jobs(0), _chunks(0), _tasks(0), _jobTime(0), _busyTime(0)
+    {}
+
+    void jobStarted(ParallelJob*, int, int) override
+    {
+        QMutexLocker l(&_mutex);
+        _jobs++;
+    }
+
+    void chunkFinished(ParallelJob*, int, int, int, qint64 time) override
+    {
+        QMutexLocker l(&_mutex);
+        _chunks++;
+        _busyTime += time;
+    }
+
+    void jobFinished(ParallelJob*, qint64 time) override
+    {
+        QMutexLocker l(&_mutex);
+        _jobTime += time;
+    }
+
+    void taskFinished(ParallelTask*, qint64 time) override
+    {
+        QMutexLocker l(&_mutex);
+        _tasks++;
+        _busyTime += time;
+    }
+
+    void print(QTextStream& out)
+    {
+        QMutexLocker l(&_mutex);
+        out << "Parallel jobs: " << _jobs << " with " << _chunks
+            << " chunks, " << _tasks << " tasks, "
+            << Parallel::workerCount() << " workers\n";
+        if (_jobTime > 0)
+            out << "  wall " << _jobTime / 1000000 << " ms, busy "
+                << _busyTime / 1000000 << " ms, utilization "
+                << QString::number(100.0 * _busyTime /
+                                   (_jobTime * Parallel::workerCount()),
+                                   'f', 1)
+                << "%\n";
+        out << endl;
+    }
+
+private:
+    QMutex _mutex;
+    int _jobs, _chunks, _tasks;
+    qint64 _jobTime, _busyTime;
+};
+
+// Returns exit code
+int freezeCheck(QTextStream& out, TraceData* d, int rounds)
+{
+    d->freeze();
+
+    QList<TraceFunction*> functions;
+    TraceFunctionMap::Iterator it;
+    for ( it = d->functionMap().begin(); it != d->functionMap().end(); ++it )
+        functions.append(&(*it));
+    foreach(TraceFunction* f, d->functionCycles())
+        functions.append(f);
+
+    EventTypeSet* m = d->eventTypes();
+    QList<EventType*> types;
+    for (int i=0;i<m->realCount();i++)
+        types.append(m->realType(i));
+    for (int i=0;i<m->derivedCount();i++)
+        types.append(m->derivedType(i));
+
+    // concurrent rounds first: the first reads must not depend on
+    // anything done lazily by a sequential pass
+    QVector<uint64> results;
+    for(int r=0; r<rounds; r++) {
+        // chunk size 1: maximize interleaving of readers
+        CostReadJob job(functions, types);
+        Parallel::run(&job, functions.count(), 1);
+        results.append(job.result());
+    }
+
+    CostReadJob seq(functions, types);
+    seq.run(0, functions.count(), 0);
+
+    int failed = 0;
+    foreach(uint64 r, results)
+        if (r != seq.result()) failed++;
+
+    out << "Frozen data: " << rounds << " rounds of concurrent reads with "
+        << Parallel::workerCount() << " workers, "
+        << failed << " mismatches." << endl;
+    return (failed > 0) ? 1 : 0;
+}
+
+// Run warehouse queries. Returns exit code
+int queryWarehouse(QTextStream& out, const QStringList& query,
+                   const QString& showEvent, Warehouse::Metric metric)
+{
+    Warehouse w(query[1]);
+    QString error;
+    if (!w.open(&error)) {
+        out << "Error: " << error << endl;
+        return 1;
+    }
+
+    if (query[0] == QLatin1String("--runs")) {
+        for(int r=0; r<w.runCount(); r++) {
+            const WarehouseRun& run = w.run(r);
+            out << r << "  " << run.time.toString(Qt::ISODate)
+                << "  " << run.traceName << " (" << run.parts << " parts)";
+            if (!run.command.isEmpty()) out << "  " << run.command;
+            out << "\n";
+        }
+        out << endl;
+        return 0;
+    }
+
+    QString eventName = showEvent;
+    if (eventName.isEmpty() && !w.events().isEmpty())
+        eventName = w.events().first();
+    int event = w.eventId(eventName);
+    if (event < 0) {
+        out << "Error: event '" << eventName << "' not found." << endl;
+        return 1;
+    }
+
+    if (query[0] == QLatin1String("--history")) {
+        QList<int> functions = w.findFunctions(query[2]);
+        if (functions.isEmpty()) {
+            out << "Error: function '" << query[2] << "' not found." << endl;
+            return 1;
+        }
+        foreach(int f, functions) {
+            out << "\n" << w.functionName(f) << ", event " << eventName
+                << ": Inclusive, Exclusive, Called\n\n";
+            for(int r=0; r<w.runCount(); r++) {
+                SubCost incl, excl, calls;
+                if (!w.value(r, f, Warehouse::Inclusive, event, &incl)) continue;
+                w.value(r, f, Warehouse::Exclusive, event, &excl);
+                w.value(r, f, Warehouse::Calls, event, &calls);
+                out.setFieldAlignment(QTextStream::AlignRight);
+                out.setFieldWidth(5);
+                out << r;
+                out.setFieldWidth(0);
+                out << "  " << w.run(r).time.toString(Qt::ISODate);
+                out.setFieldWidth(14);
+                out << incl.pretty() << excl.pretty() << calls.pretty();
+                out.setFieldWidth(0);
+                out << "\n";
+            }
+        }
+        out << endl;
+        return 0;
+    }
+
+    // --movers
+    int r1 = query[2].toInt(), r2 = query[3].toInt();
+    if (r1 < 0) r1 += w.runCount();
+    if (r2 < 0) r2 += w.runCount();
+    if ((r1 < 0) || (r1 >= w.runCount()) || (r2 < 0) || (r2 >= w.runCount())) {
+        out << "Error: run number out of range." << endl;
+        return 1;
+    }
+    out << "Changes from run " << r1 << " to run " << r2
+        << ((metric == Warehouse::Calls) ? ", call count" :
+            (metric == Warehouse::Exclusive) ? ", exclusive " : ", inclusive ")
+        << ((metric == Warehouse::Calls) ? QString() : eventName) << ":\n\n";
+    foreach(const WarehouseMover& mv, w.topMovers(r1, r2, metric, event, 50)) {
+        out.setFieldAlignment(QTextStream::AlignRight);
+        out.setFieldWidth(14);
+        out << mv.from.pretty() << mv.to.pretty();
+        out.setFieldWidth(10);
+        if (mv.from > 0)
+            out << QStringLiteral("%1%").arg(100.0 * ((double)(uint64) mv.to -
+                                                     (double)(uint64) mv.from)
+                                             / (double)(uint64) mv.from,
+                                             0, 'f', 1);
+        else
+            out << "new";
+        out.setFieldWidth(0);
+        out << "  " << w.functionName(mv.function) << "\n";
+    }
+    out << endl;
+    return 0;
+}
+
+// Percentiles of function costs over files, each one host. Returns exit code
+int fleetReport(QTextStream& out, const QStringList& files,
+                const QString& showEvent, bool sortByExcl, int maxConcurrent)
+{
+    FleetStatistics fleet;
+    int loaded = fleet.load(files, showEvent, maxConcurrent);
+    if (loaded == 0) {
+        out << "Error: No profile with event '"
+            << (showEvent.isEmpty() ? QStringLiteral("(first)") : showEvent)
+            << "' loaded." << endl;
+        return 1;
+    }
+
+    // sort by median, descending
+    QVector<QPair<double, int> > order;
+    for(int i=0; i<fleet.functionCount(); i++)
+        order.append(qMakePair(sortByExcl ? fleet.exclusive(i, 0.5) :
+                                            fleet.inclusive(i, 0.5), i));
+    std::sort(order.begin(), order.end());
+    std::reverse(order.begin(), order.end());
+
+    out << "Percentiles over " << fleet.hostCount() << " hosts ("
+        << fleet.functionCount() << " functions, "
+        << fleet.centroidCount() << " sketch centroids), sorted by "
+        << (sortByExcl ? "exclusive" : "inclusive") << " P50:\n\n"
+        << "    Incl. P50     P90     P99    Excl. P50     P90     P99"
+        << "   Function name (DSO)\n"
+        << " ========================================================="
+        << "==========================\n";
+
+    static const double q[] = { 0.5, 0.9, 0.99 };
+    for(int k=0; (k<order.count()) && (k<50); k++) {
+        int i = order.at(k).second;
+        out.setFieldAlignment(QTextStream::AlignRight);
+        for(int j=0; j<3; j++) {
+            out.setFieldWidth(j ? 8 : 13);
+            out << QString::number(100.0 * fleet.inclusive(i, q[j]), 'f', 2);
+        }
+        for(int j=0; j<3; j++) {
+            out.setFieldWidth(j ? 8 : 13);
+            out << QString::number(100.0 * fleet.exclusive(i, q[j]), 'f', 2);
+        }
+        out.setFieldWidth(0);
+        const FleetFunction& f = fleet.function(i);
+        out << "   " << f.name;
+        if (!f.object.isEmpty()) out << " (" << f.object << ")";
+        out << "\n";
+    }
+    out << endl;
+    return 0;
+}
+
+// Memory usage of loading generated profiles. Returns exit code
+int memoryCheck(QTextStream& out, int steps)
+{
+    MemoryCheck check;
+    check.setSteps(steps);
+    bool ok = check.run();
+
+    out << "Memory usage (budgets: " << MemoryCheck::MaxBytesPerInputByte
+        << " bytes per input byte, " << MemoryCheck::MaxBytesPerCostLine
+        << " pool bytes per cost line):\n\n"
+        << "   Functions  Input kB  Cost lines  Peak RSS kB  Pool kB"
+        << "  B/input  B/line    ms\n"
+        << " ==================================================="
+        << "=========================\n";
+    out.setFieldAlignment(QTextStream::AlignRight);
+    foreach(const MemoryUsage& u, check.usage()) {
+        out.setFieldWidth(12);
+        out << u.functions;
+        out.setFieldWidth(10);
+        out << u.inputBytes / 1024;
+        out.setFieldWidth(12);
+        out << u.costLines;
+        out.setFieldWidth(13);
+        out << (u.peakRss - u.baseRss) / 1024;
+        out.setFieldWidth(9);
+        out << (u.fixPoolSize + u.dynPoolSize) / 1024;
+        out << QString::number(u.bytesPerInputByte(), 'f', 1);
+        out.setFieldWidth(8);
+        out << QString::number(u.bytesPerCostLine(), 'f', 1);
+        out.setFieldWidth(6);
+        out << u.loadTime;
+        out.setFieldWidth(0);
+        out << "\n";
+    }
+    out << "\n";
+
+    foreach(const QString& f, check.failures())
+        out << "Over budget: " << f << "\n";
+    out << (ok ? "Memory check passed." : "Memory check failed.") << endl;
+    return ok ? 0 : 1;
+}
+
+// one timing round of a cost vector operation, in ms
+typedef void (*CostVectorOp)(SubCost*, const SubCost*, int);
+
+static double timeCostVectorOp(CostVectorOp op, QVector<SubCost>& dst,
+                               const QVector<SubCost>& src, int len, int count)
+{
+    int vectors = src.size() / len;
+    QElapsedTimer timer;
+    timer.start();
+    for(int i=0; i<count; i++)
+        op(dst.data(), src.constData() + (i % vectors) * len, len);
+    return timer.nsecsElapsed() / 1000000.0;
+}
+
+static void addCostVectorScalar(SubCost* dst, const SubCost* src, int n)
+{
+    for(int i=0; i<n; i++)
+        dst[i].v += src[i].v;
+}
+
+static void maxCostVectorScalar(SubCost* dst, const SubCost* src, int n)
+{
+    for(int i=0; i<n; i++)
+        if (dst[i].v < src[i].v) dst[i].v = src[i].v;
+}
+
+// Timing of cost vector kernels against scalar loops. Returns exit code
+int kernelBench(QTextStream& out, int millions)
+{
+    static const int lengths[] = { 1, 2, 4, 8, 13, 32, 256 };
+    // large enough to not only run from L1 cache
+    QVector<SubCost> src(1 << 16);
+    for(int i=0; i<src.size(); i++)
+        src[i] = (uint64) (i * 7919) % 1000;
+
+    out << "Cost vector operations on " << millions << " million costs "
+        << "per length (ms; inline loops below length "
+        << CostKernelMinLength << "):\n\n"
+        << "  Length  add scalar  add kernel  max scalar  max kernel\n"
+        << " =======================================================\n";
+    out.setFieldAlignment(QTextStream::AlignRight);
+    uint64 check = 0;
+    for(unsigned l=0; l<sizeof(lengths)/sizeof(int); l++) {
+        int len = lengths[l];
+        // same number of costs for each length
+        int count = (int) qMin(1000000LL * millions / len, 1000000000LL);
+        QVector<SubCost> dst(len);
+        double t[4];
+        t[0] = timeCostVectorOp(addCostVectorScalar, dst, src, len, count);
+        t[1] = timeCostVectorOp(addCostVectorKernel, dst, src, len, count);
+        t[2] = timeCostVectorOp(maxCostVectorScalar, dst, src, len, count);
+        t[3] = timeCostVectorOp(maxCostVectorKernel, dst, src, len, count);
+        for(int i=0; i<len; i++)
+            check += dst[i].v;
+
+        out.setFieldWidth(8);
+        out << len;
+        out.setFieldWidth(12);
+        for(int i=0; i<4; i++)
+            out << QString::number(t[i], 'f', 1);
+        out.setFieldWidth(0);
+        out << "\n";
+    }
+    // keeps the compiler from dropping the loops
+    out << "\n(checksum " << check << ")" << endl;
+    return 0;
+}
+
+// Timing of dominator calculation on a generated call graph. Returns exit code
+int dominatorBench(QTextStream& out, int functions)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    MemoryCheck::generateProfile(&buffer, functions);
+    buffer.close();
+
+    QElapsedTimer timer;
+    timer.start();
+    TraceData* d = new TraceData(new Logger);
+    if (d->load(&buffer, QStringLiteral("dominatorbench.out")) == 0) {
+        out << "Error: Generated profile not loaded." << endl;
+        delete d;
+        return 1;
+    }
+    qint64 loadTime = timer.elapsed();
+
+    out << "Dominators of " << d->functionMap().count()
+        << " functions (loaded in " << loadTime << " ms):\n";
+    Dominators* dom = d->dominators();
+    for(int round=0; round<3; round++) {
+        dom->invalidate();
+        timer.start();
+        dom->calculate();
+        out << "  Round " << round + 1 << ": " << timer.elapsed() << " ms\n";
+    }
+    out << endl;
+
+    delete d;
+    return 0;
+}
+
 
 int main(int argc, char** argv)
 {
@@ -64,9 +519,22 @@ int main(int argc, char** argv)
 
     bool sortByExcl = false;
     bool sortByCount = false;
+    bool sortByDominated = false;
     bool showCalls = false;
+    bool showStats = false;
+    int hotLineCount = 0;
+    int inlinedCount = 0;
     QString showEvent;
     QStringList files;
+    QVector<Addr> addrs;
+    QString storeDir;
+    QStringList query;
+    int freezeRounds = 0;
+    int maxPhases = 0;
+    int fleetConcurrency = -1;
+    int memcheckSteps = 0;
+    int kernelBenchCount = 0;
+    int dominatorBenchCount = 0;
 
     for(int arg = 0; arg<list.count(); arg++) {
         if      (list[arg] == QLatin1String("-h")) showHelp(out);
@@ -74,19 +542,99 @@ int main(int argc, char** argv)
         else if (list[arg] == QLatin1String("-n")) GlobalConfig::setShowCycles(false);
         else if (list[arg] == QLatin1String("-b")) showCalls = true;
         else if (list[arg] == QLatin1String("-c")) sortByCount = true;
+        else if (list[arg] == QLatin1String("-d")) sortByDominated = true;
         else if (list[arg] == QLatin1String("-s")) showEvent = list[++arg];
+        else if (list[arg] == QLatin1String("-l")) hotLineCount = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("-i")) inlinedCount = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("-a")) {
+            QString a = list[++arg];
+            if (a.startsWith(QLatin1String("0x"))) a = a.mid(2);
+            addrs.append(Addr(a.toULongLong(nullptr, 16)));
+        }
+        else if (list[arg] == QLatin1String("--stats")) showStats = true;
+        else if (list[arg] == QLatin1String("--store")) storeDir = list[++arg];
+        else if (list[arg] == QLatin1String("--freeze-check"))
+            freezeRounds = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("--phases"))
+            maxPhases = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("--fleet"))
+            fleetConcurrency = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("--memcheck"))
+            memcheckSteps = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("--kernel-bench"))
+            kernelBenchCount = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("--dominator-bench"))
+            dominatorBenchCount = list[++arg].toInt();
+        else if ((list[arg] == QLatin1String("--runs")) ||
+                 (list[arg] == QLatin1String("--history")) ||
+                 (list[arg] == QLatin1String("--movers"))) {
+            int args = (list[arg] == QLatin1String("--runs")) ? 1 :
+                       (list[arg] == QLatin1String("--history")) ? 2 : 3;
+            if (arg + args >= list.count()) showHelp(out);
+            query = list.mid(arg, args + 1);
+            arg += args;
+        }
+        else if (list[arg] == QLatin1String("-p"))
+            GlobalConfig::setPruneThreshold(list[++arg].toDouble());
+        else if (list[arg] == QLatin1String("-j"))
+            GlobalConfig::setThreadCount(list[++arg].toInt());
         else
             files << list[arg];
     }
+
+    ParallelStats parallelStats;
+    if (showStats) Parallel::setObserver(&parallelStats);
+
+    if (!query.isEmpty())
+        return queryWarehouse(out, query, showEvent,
+                              sortByCount ? Warehouse::Calls :
+                              sortByExcl ? Warehouse::Exclusive :
+                              Warehouse::Inclusive);
+
+    if (memcheckSteps > 0)
+        return memoryCheck(out, memcheckSteps);
+
+    if (kernelBenchCount > 0)
+        return kernelBench(out, kernelBenchCount);
+
+    if (dominatorBenchCount > 0)
+        return dominatorBench(out, dominatorBenchCount);
+
+    if (fleetConcurrency >= 0)
+        return fleetReport(out, files, showEvent, sortByExcl,
+                           fleetConcurrency);
+
     TraceData* d = new TraceData(new Logger);
     d->load(files);
 
+    if (showStats && d->loadStatistics()) {
+        out << "\nLoading statistics:\n";
+        foreach(const QString& s, d->loadStatistics()->summary())
+            out << "  " << s << "\n";
+        out << endl;
+    }
+    if (showStats) parallelStats.print(out);
+
     EventTypeSet* m = d->eventTypes();
     if (m->realCount() == 0) {
         out << "Error: No event types found." << endl;
         return 1;
     }
 
+    if (freezeRounds > 0)
+        return freezeCheck(out, d, freezeRounds);
+
+    if (!storeDir.isEmpty()) {
+        Warehouse w(storeDir);
+        QString error;
+        if (!w.open(&error) || !w.addRun(d, &error)) {
+            out << "Error: " << error << endl;
+            return 1;
+        }
+        out << "Stored as run " << w.runCount()-1
+            << " in '" << storeDir << "'." << endl;
+    }
+
     out << "\nTotals for event types:\n";
 
     EventType* et;
@@ -94,7 +642,7 @@ int main(int argc, char** argv)
         et = m->realType(i);
         out.setFieldWidth(14);
         out.setFieldAlignment(QTextStream::AlignRight);
-        out << d->subCost(et).pretty();
+        out << d->prettySubCost(et);
         out.setFieldWidth(0);
         out << "   " << et->longName() << " (" << et->name() << ")\n";
     }
@@ -102,13 +650,35 @@ int main(int argc, char** argv)
         et = m->derivedType(i);
         out.setFieldWidth(14);
         out.setFieldAlignment(QTextStream::AlignRight);
-        out << d->subCost(et).pretty();
+        out << d->prettySubCost(et);
         out.setFieldWidth(0);
         out << "   " << et->longName() <<
                " (" << et->name() << " = " << et->formula() << ")\n";
     }
     out << endl;
 
+    if (!addrs.isEmpty()) {
+        // batch lookup in each object with sorted addresses
+        std::sort(addrs.begin(), addrs.end());
+        QVector<TraceFunction*> found(addrs.count(), nullptr);
+        QVector<TraceFunction*> res(addrs.count());
+        TraceObjectMap::Iterator oit;
+        for (oit = d->objectMap().begin(); oit != d->objectMap().end(); ++oit) {
+            (*oit).addressIndex()->functions(addrs.constData(), addrs.count(),
+                                             res.data());
+            for (int i=0; i<addrs.count(); i++)
+                if (!found[i]) found[i] = res[i];
+        }
+        for (int i=0; i<addrs.count(); i++) {
+            out << "0x" << addrs[i].toString() << ": ";
+            if (found[i])
+                out << found[i]->name() << " (" << found[i]->object()->name() << ")\n";
+            else
+                out << "(unknown)\n";
+        }
+        out << endl;
+    }
+
     if (showEvent.isEmpty())
         et = m->realType(0);
     else {
@@ -119,9 +689,31 @@ int main(int argc, char** argv)
         }
     }
     Q_ASSERT( et!=nullptr );
-    out << "Sorted by: " << (sortByExcl ? "Exclusive ":"Inclusive ")
+
+    if (maxPhases > 0) {
+        PhaseDetection pd(d);
+        pd.setEventType(et);
+        pd.setMaxPhases(maxPhases);
+        pd.detect();
+        out << "Phases of " << d->parts().count() << " parts by "
+            << et->longName() << ":\n";
+        for(int i=0; i<pd.count(); i++) {
+            const ProgramPhase& ph = pd.phase(i);
+            out.setFieldWidth(14);
+            out.setFieldAlignment(QTextStream::AlignRight);
+            out << ph.cost.pretty();
+            out.setFieldWidth(0);
+            out << "   " << ph.name() << "\n";
+        }
+        out << endl;
+    }
+
+    out << "Sorted by: "
+        << (sortByDominated ? "Dominated " : sortByExcl ? "Exclusive ":"Inclusive ")
         << et->longName() << " (" << et->name() << ")" << endl;
 
+    Dominators* dom = sortByDominated ? d->dominators() : nullptr;
+
     QList<TraceFunction*> flist;
     HighestCostList hc;
     hc.clear(50);
@@ -136,6 +728,8 @@ int main(int argc, char** argv)
     foreach(f, flist) {
         if (sortByCount)
             hc.addCost(f, f->calledCount());
+        else if (dom)
+            hc.addCost(f, dom->dominatedCost(f, et));
         else if (sortByExcl)
             hc.addCost(f, f->subCost(et));
         else
@@ -143,8 +737,12 @@ int main(int argc, char** argv)
     }
 
 
-    out << "\n     Inclusive     Exclusive       Called  Function name (DSO)\n";
-    out << " ==================================================================\n";
+    out << "\n     Inclusive     Exclusive       Called  ";
+    if (dom) out << "   Dominated  ";
+    out << "Function name (DSO)\n";
+    out << " ==================================================================";
+    if (dom) out << "==============";
+    out << "\n";
 
     out.setFieldAlignment(QTextStream::AlignRight);
     for(int i=0; i<hc.realCount(); i++) {
@@ -155,7 +753,7 @@ int main(int argc, char** argv)
             foreach(TraceCall* c, f->callers()) {
                 out << "  ";
                 out.setFieldWidth(14);
-                out << c->subCost(et).pretty();
+                out << c->prettySubCost(et);
                 out.setFieldWidth(0);
                 out << "            ";
                 out.setFieldWidth(13);
@@ -166,18 +764,27 @@ int main(int argc, char** argv)
         }
 
         out.setFieldWidth(14);
-        out << f->inclusive()->subCost(et).pretty();
-        out << f->subCost(et).pretty();
+        out << f->inclusive()->prettySubCost(et);
+        out << f->prettySubCost(et);
         out.setFieldWidth(13);
         out << f->prettyCalledCount();
+        if (dom) {
+            out.setFieldWidth(14);
+            out << et->prettySubCost(dom->dominatedCost(f, et));
+        }
         out.setFieldWidth(0);
-        out << "  " << f->name() << " (" << f->object()->name() << ")" << endl;
+        out << "  " << f->name() << " (" << f->object()->name() << ")";
+        if (dom) {
+            TraceFunction* idom = dom->immediateDominator(f);
+            out << ", dominated by " << (idom ? idom->prettyName() : QStringLiteral("(root)"));
+        }
+        out << endl;
 
         if (showCalls) {
             foreach(TraceCall* c, f->callings()) {
                 out << "  ";
                 out.setFieldWidth(14);
-                out << c->subCost(et).pretty();
+                out << c->prettySubCost(et);
                 out.setFieldWidth(0);
                 out << "            ";
                 out.setFieldWidth(13);
@@ -188,5 +795,72 @@ int main(int argc, char** argv)
         }
 
     }
-}
 
+    if (inlinedCount > 0) {
+        // cost of inlined code summed up over all containing functions
+        InlinedIndex ii;
+        ii.calculate(d);
+        int total;
+        QVector<int> top = ii.top(et, inlinedCount, &total);
+        out << "\nInlined hotspots for " << et->longName()
+            << " (" << et->name() << "), " << total << " ranges:\n\n";
+
+        foreach(int i, top) {
+            const InlinedRange& r = ii.range(i);
+            out.setFieldAlignment(QTextStream::AlignRight);
+            out.setFieldWidth(14);
+            out << et->prettySubCost(ii.subCost(i, et));
+            out.setFieldWidth(0);
+            out << "  " << r.file->name() << ":" << r.firstLineno;
+            if (r.lastLineno > r.firstLineno) out << "-" << r.lastLineno;
+            if (r.inlinedFunction)
+                out << " [" << r.inlinedFunction->prettyName() << "]";
+            out << " in " << r.functionCount << " function(s)";
+            if (r.function)
+                out << ", most in " << r.function->prettyName();
+            out << endl;
+        }
+    }
+
+    if (hotLineCount <= 0) return 0;
+
+    // hottest source lines over all functions, for each event type
+    HotLines hl;
+    hl.calculate(d);
+
+    QList<EventType*> types;
+    for (int i=0;i<m->realCount();i++)
+        types.append(m->realType(i));
+    for (int i=0;i<m->derivedCount();i++)
+        types.append(m->derivedType(i));
+
+    foreach(et, types) {
+        QVector<int> top = hl.top(et, hotLineCount);
+        if (top.isEmpty()) continue;
+
+        EventType* at = HotLines::accessType(et);
+        out << "\nHot lines for " << et->longName() << " (" << et->name() << ")";
+        if (at) out << ", miss ratio to " << at->name();
+        out << ":\n\n";
+
+        foreach(int i, top) {
+            const HotLine& l = hl.line(i);
+            out.setFieldAlignment(QTextStream::AlignRight);
+            out.setFieldWidth(14);
+            out << et->prettySubCost(hl.subCost(i, et));
+            if (at) {
+                double r = hl.missRatio(i, et);
+                out.setFieldWidth(9);
+                out << ((r < 0.0) ? QString() :
+                        QStringLiteral("%1%").arg(100.0 * r, 0, 'f', 2));
+            }
+            out.setFieldWidth(0);
+            out << "  " << l.file->name() << ":" << l.lineno;
+            if (l.function)
+                out << " (" << l.function->prettyName() << ")";
+            out << endl;
+        }
+    }
+
+    return 0;
+}
@@ -42,6 +42,7 @@ public:
     QString toString() const;
     // similar to toString(), but adds a space every 4 digits
     QString pretty() const;
+    uint64 value() const { return _v; }
 
     // returns true if this address is in [a-distance;a+distance]
     bool isInRange(Addr a, int distance);
@@ -0,0 +1,129 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Address to function lookup for an ELF object
+ */
+
+#include "addressindex.h"
+
+#include <algorithm>
+
+#include "tracedata.h"
+#include "fixcost.h"
+
+
+//---------------------------------------------------
+// AddressIndex
+
+AddressIndex::AddressIndex(TraceObject* o)
+{
+    foreach(TraceFunction* f, o->functions()) {
+        Addr first, last;
+        bool found = false;
+
+        // address 0 is used for cost without address information
+        foreach(TraceInclusiveCost* icost, f->deps()) {
+            TracePartFunction* pf = (TracePartFunction*) icost;
+
+            // a cost can cover an address region up to toAddr()
+            for(FixCost* fc = pf->firstFixCost(); fc;
+                fc = fc->nextCostOfPartFunction()) {
+                if (fc->addr() == Addr(0)) continue;
+                Addr end = fc->toAddr();
+                if (end < fc->addr()) end = fc->addr();
+                if (!found || fc->addr() < first) first = fc->addr();
+                if (!found || end > last) last = end;
+                found = true;
+            }
+            for(FixJump* fj = pf->firstFixJump(); fj;
+                fj = fj->nextJumpOfPartFunction()) {
+                if (fj->addr() == Addr(0)) continue;
+                if (!found || fj->addr() < first) first = fj->addr();
+                if (!found || fj->addr() > last) last = fj->addr();
+                found = true;
+            }
+            foreach(TracePartCall* pc, pf->partCallings()) {
+                for(FixCallCost* fcc = pc->firstFixCallCost(); fcc;
+                    fcc = fcc->nextCostOfPartCall()) {
+                    if (fcc->addr() == Addr(0)) continue;
+                    if (!found || fcc->addr() < first) first = fcc->addr();
+                    if (!found || fcc->addr() > last) last = fcc->addr();
+                    found = true;
+                }
+            }
+        }
+        if (!found) continue;
+
+        Range r;
+        r.first = first;
+        r.last = last;
+        r.function = f;
+        _ranges.append(r);
+    }
+
+    std::sort(_ranges.begin(), _ranges.end(), rangeLessThan);
+
+    Addr maxLast = 0;
+    for(int i=0; i<_ranges.count(); i++) {
+        if (_ranges[i].last > maxLast) maxLast = _ranges[i].last;
+        _ranges[i].maxLast = maxLast;
+    }
+}
+
+bool AddressIndex::rangeLessThan(const Range& r1, const Range& r2)
+{
+    return r1.first < r2.first;
+}
+
+// search backwards from the last range starting at or before <addr>,
+// given by <upper> (index of first range starting after <addr>)
+TraceFunction* AddressIndex::lookup(int upper, Addr addr) const
+{
+    for(int i = upper-1; i >= 0; i--) {
+        const Range& r = _ranges[i];
+        if (r.maxLast < addr) break;
+        if (r.last >= addr) return r.function;
+    }
+    return nullptr;
+}
+
+TraceFunction* AddressIndex::function(Addr addr) const
+{
+    // binary search for first range with first > addr
+    int low = 0, high = _ranges.count();
+    while(low < high) {
+        int mid = (low + high) / 2;
+        if (_ranges[mid].first <= addr)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return lookup(low, addr);
+}
+
+void AddressIndex::functions(const Addr* addrs, int count,
+                             TraceFunction** functions) const
+{
+    int upper = 0, rangeCount = _ranges.count();
+    for(int i=0; i<count; i++) {
+        while((upper < rangeCount) && (_ranges[upper].first <= addrs[i]))
+            upper++;
+        functions[i] = lookup(upper, addrs[i]);
+    }
+}
@@ -0,0 +1,82 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Address to function lookup for an ELF object
+ */
+
+#ifndef ADDRESSINDEX_H
+#define ADDRESSINDEX_H
+
+#include <QVector>
+
+#include "addr.h"
+
+class TraceObject;
+class TraceFunction;
+
+/**
+ * Sorted list of the address ranges of all functions in a TraceObject,
+ * for mapping raw addresses to functions in O(log n).
+ *
+ * The range of a function goes from its lowest to its highest address
+ * with cost (including the end of address regions), a call or a jump
+ * in any part. This does not need the
+ * instruction maps of functions to be filled. If ranges overlap (e.g.
+ * because of code of a function placed into holes of another one),
+ * the range with the highest start address wins.
+ *
+ * Created on demand by TraceObject::addressIndex(); as it only depends
+ * on fixed costs, it is valid until functions or parts are added
+ * (or dynamic costs are invalidated).
+ */
+class AddressIndex
+{
+public:
+    explicit AddressIndex(TraceObject*);
+
+    int count() const { return _ranges.count(); }
+
+    // function whose range contains <addr>, or nullptr
+    TraceFunction* function(Addr addr) const;
+
+    /**
+     * Lookup for <count> addresses sorted in ascending order, with the
+     * result for addrs[i] stored into functions[i]. This walks the
+     * ranges in parallel to the addresses instead of searching for
+     * each address.
+     */
+    void functions(const Addr* addrs, int count,
+                   TraceFunction** functions) const;
+
+private:
+    struct Range
+    {
+        Addr first, last;
+        // maximum of <last> over this and all previous ranges
+        Addr maxLast;
+        TraceFunction* function;
+    };
+
+    static bool rangeLessThan(const Range&, const Range&);
+    TraceFunction* lookup(int upper, Addr addr) const;
+
+    QVector<Range> _ranges;
+};
+
+#endif
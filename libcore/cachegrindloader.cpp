@@ -26,6 +26,8 @@
 #include "tracedata.h"
 #include "utils.h"
 #include "fixcost.h"
+#include "loadstats.h"
+#include "modelpruner.h"
 
 
 #define TRACE_LOADER 0
@@ -481,7 +483,9 @@ TraceFunction* CachegrindLoader::compressedFunction(const QString& name,
 
         QString realName = checkUnknown(name.mid(p));
         f = (TraceFunction*) _functionVector.at(index);
-        if (f && (f->name() != realName)) {
+        // with pruning, f may be "(other)" with a different name
+        if (f && (f->name() != realName) &&
+            !(_data->pruner() && _data->pruner()->isOther(f))) {
             error(QStringLiteral("Redefinition of compressed function index %1 (was '%2') to %3")
                   .arg(index).arg(f->name()).arg(realName));
         }
@@ -747,6 +751,8 @@ int CachegrindLoader::loadInternal(TraceData* data,
 #if USE_FIXCOST
     // FixCost Memory Pool
     FixPool* pool = _data->fixPool();
+    // with pruning, cost of pruned functions is summed up there
+    ModelPruner* pruner = _data->pruner();
 #endif
 
     _part = nullptr;
@@ -756,6 +762,9 @@ int CachegrindLoader::loadInternal(TraceData* data,
     FixString line;
     char c;
 
+    // number of cost lines, indexed by lineType
+    int costLines[4] = { 0, 0, 0, 0 };
+
     // current position
     nextLineType  = SelfCost;
     // default if there is no "positions:" line
@@ -1171,15 +1180,17 @@ int CachegrindLoader::loadInternal(TraceData* data,
 #endif
 
         // create cost item
+        costLines[nextLineType]++;
 
         if (nextLineType == SelfCost) {
 
 #if USE_FIXCOST
-            new (pool) FixCost(_part, pool,
-                               currentFunctionSource,
-                               currentPos,
-                               currentPartFunction,
-                               line);
+            if (!pruner || !pruner->addCost(_part, currentFunction, line))
+                new (pool) FixCost(_part, pool,
+                                   currentFunctionSource,
+                                   currentPos,
+                                   currentPartFunction,
+                                   line);
 #else
             if (hasAddrInfo) {
                 TracePartInstr* partInstr;
@@ -1211,22 +1222,32 @@ int CachegrindLoader::loadInternal(TraceData* data,
         else if (nextLineType == CallCost) {
             nextLineType = SelfCost;
 
+#if USE_FIXCOST
+            if (!pruner ||
+                !pruner->addCallCost(_part, currentFunction,
+                                     currentCalledFunction,
+                                     currentCallCount, line)) {
+                TraceCall* calling = currentFunction->calling(currentCalledFunction);
+                TracePartCall* partCalling =
+                        calling->partCall(_part, currentPartFunction,
+                                          currentCalledPartFunction);
+
+                FixCallCost* fcc;
+                fcc = new (pool) FixCallCost(_part, pool,
+                                             currentFunctionSource,
+                                             hasLineInfo ? currentPos.fromLine : 0,
+                                             hasAddrInfo ? currentPos.fromAddr : Addr(0),
+                                             partCalling,
+                                             currentCallCount, line);
+                fcc->setMax(_data->callMax());
+                _data->updateMaxCallCount(fcc->callCount());
+            }
+#else
             TraceCall* calling = currentFunction->calling(currentCalledFunction);
             TracePartCall* partCalling =
                     calling->partCall(_part, currentPartFunction,
                                       currentCalledPartFunction);
 
-#if USE_FIXCOST
-            FixCallCost* fcc;
-            fcc = new (pool) FixCallCost(_part, pool,
-                                         currentFunctionSource,
-                                         hasLineInfo ? currentPos.fromLine : 0,
-                                         hasAddrInfo ? currentPos.fromAddr : Addr(0),
-                                         partCalling,
-                                         currentCallCount, line);
-            fcc->setMax(_data->callMax());
-            _data->updateMaxCallCount(fcc->callCount());
-#else
             if (hasAddrInfo) {
                 TraceInstrCall* instrCall;
                 TracePartInstrCall* partInstrCall;
@@ -1288,19 +1309,21 @@ int CachegrindLoader::loadInternal(TraceData* data,
                                currentFunctionSource;
 
 #if USE_FIXCOST
-            new (pool) FixJump(_part, pool,
-                               /* source */
-                               hasLineInfo ? currentPos.fromLine : 0,
-                               hasAddrInfo ? currentPos.fromAddr : 0,
-                               currentPartFunction,
-                               currentFunctionSource,
-                               /* target */
-                               hasLineInfo ? targetPos.fromLine : 0,
-                               hasAddrInfo ? targetPos.fromAddr : Addr(0),
-                               currentJumpToFunction,
-                               targetSource,
-                               (nextLineType == CondJump),
-                               jumpsExecuted, jumpsFollowed);
+            if (!pruner ||
+                !pruner->skipJump(currentFunction, currentJumpToFunction))
+                new (pool) FixJump(_part, pool,
+                                   /* source */
+                                   hasLineInfo ? currentPos.fromLine : 0,
+                                   hasAddrInfo ? currentPos.fromAddr : 0,
+                                   currentPartFunction,
+                                   currentFunctionSource,
+                                   /* target */
+                                   hasLineInfo ? targetPos.fromLine : 0,
+                                   hasAddrInfo ? targetPos.fromAddr : Addr(0),
+                                   currentJumpToFunction,
+                                   targetSource,
+                                   (nextLineType == CondJump),
+                                   jumpsExecuted, jumpsFollowed);
 #else
             if (hasAddrInfo) {
                 TraceInstr* jumpToInstr;
@@ -1358,9 +1381,20 @@ int CachegrindLoader::loadInternal(TraceData* data,
         }
     }
 
+    if (_stats) {
+        _stats->addLines(_lineNo);
+        _stats->addLines(LoadStatistics::CostLine, costLines[SelfCost]);
+        _stats->addLines(LoadStatistics::CallLine, costLines[CallCost]);
+        _stats->addLines(LoadStatistics::JumpLine, costLines[BoringJump]);
+        _stats->addLines(LoadStatistics::CondJumpLine, costLines[CondJump]);
+    }
+
     loadFinished();
 
     if (mapping) {
+#if USE_FIXCOST
+        if (pruner) pruner->flush(_part);
+#endif
         _part->invalidate();
         _part->totals()->clear();
         _part->totals()->addCost(_part);
@@ -0,0 +1,152 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Cache for derived data shared among views
+ */
+
+#include "computecache.h"
+
+#include <QDebug>
+
+#define DEBUG_COMPUTECACHE 0
+
+
+//---------------------------------------------------
+// ComputeKey
+
+ComputeKey::ComputeKey()
+{
+    _kind = 0;
+    _item = nullptr;
+    _eventType = nullptr;
+    _eventType2 = nullptr;
+}
+
+ComputeKey::ComputeKey(int kind, CostItem* item, EventType* t, EventType* t2,
+                       const TracePartList& parts, const QString& options)
+    : _parts(parts), _options(options)
+{
+    _kind = kind;
+    _item = item;
+    _eventType = t;
+    _eventType2 = t2;
+}
+
+bool ComputeKey::operator==(const ComputeKey& k) const
+{
+    return (_kind == k._kind) &&
+            (_item == k._item) &&
+            (_eventType == k._eventType) &&
+            (_eventType2 == k._eventType2) &&
+            (_parts == k._parts) &&
+            (_options == k._options);
+}
+
+uint qHash(const ComputeKey& k)
+{
+    uint h = qHash(k.item()) ^ (uint) k.kind();
+    h = 31 * h + qHash(k.eventType());
+    h = 31 * h + qHash(k.eventType2());
+    h = 31 * h + (uint) k.parts().count();
+    return h ^ qHash(k.options());
+}
+
+
+//---------------------------------------------------
+// ComputeCache
+
+const int ComputeCache::maxResults = 200;
+
+ComputeCache::ComputeCache(TraceData* d)
+{
+    _data = d;
+    _hits = 0;
+    _misses = 0;
+}
+
+ComputeCache::~ComputeCache()
+{
+    invalidate();
+}
+
+ComputeKey ComputeCache::key(Kind kind, CostItem* item,
+                             EventType* t, EventType* t2,
+                             const QString& options)
+{
+    TracePartList parts;
+    foreach(TracePart* part, _data->parts())
+        if (part->isActive())
+            parts.append(part);
+
+    return ComputeKey(kind, item, t, t2, parts, options);
+}
+
+ComputeResult* ComputeCache::result(const ComputeKey& key)
+{
+    QMutexLocker locker(&_mutex);
+    ComputeResult* r = _results.value(key, nullptr);
+    if (!r) {
+        _misses++;
+        return nullptr;
+    }
+
+    _hits++;
+    r->ref();
+    return r;
+}
+
+void ComputeCache::insert(const ComputeKey& key, ComputeResult* r)
+{
+    if (!r) return;
+
+    QMutexLocker locker(&_mutex);
+    r->ref();
+    ComputeResult* old = _results.value(key, nullptr);
+    if (old) {
+        old->deref();
+        _order.removeOne(key);
+    }
+    _results.insert(key, r);
+    _order.append(key);
+
+    while (_order.count() > maxResults) {
+        ComputeKey oldest = _order.takeFirst();
+        ComputeResult* o = _results.take(oldest);
+        if (o) o->deref();
+    }
+
+    if (DEBUG_COMPUTECACHE)
+        qDebug("ComputeCache: %d results, %d hits, %d misses",
+               _results.count(), _hits, _misses);
+}
+
+int ComputeCache::count()
+{
+    QMutexLocker locker(&_mutex);
+    return _results.count();
+}
+
+void ComputeCache::invalidate()
+{
+    QMutexLocker locker(&_mutex);
+    foreach(ComputeResult* r, _results)
+        r->deref();
+    _results.clear();
+    _order.clear();
+}
@@ -0,0 +1,145 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Cache for derived data shared among views
+ */
+
+#ifndef COMPUTECACHE_H
+#define COMPUTECACHE_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include "tracedata.h"
+
+/**
+ * Base class for a result stored in the ComputeCache.
+ *
+ * Results are reference counted: a newly created result has one
+ * reference, owned by the creator. Everybody keeping a pointer to a
+ * result has to hold a reference, and call deref() when done.
+ * The cache holds its own reference as long as the result is valid.
+ * Reference counting is atomic, so results can be shared among threads.
+ */
+class ComputeResult
+{
+public:
+    ComputeResult() { _refCount = 1; }
+    virtual ~ComputeResult() {}
+
+    void ref() { _refCount.ref(); }
+    void deref() { if (!_refCount.deref()) delete this; }
+
+private:
+    QAtomicInt _refCount;
+};
+
+
+/**
+ * Key of a cached result. Besides the kind of computation and its
+ * parameters (item, event types and options), the parts active at
+ * creation time of the key are part of it.
+ */
+class ComputeKey
+{
+public:
+    ComputeKey();
+    ComputeKey(int kind, CostItem* item, EventType* t, EventType* t2,
+               const TracePartList& parts, const QString& options);
+
+    bool operator==(const ComputeKey&) const;
+
+    int kind() const { return _kind; }
+    CostItem* item() const { return _item; }
+    EventType* eventType() const { return _eventType; }
+    EventType* eventType2() const { return _eventType2; }
+    const TracePartList& parts() const { return _parts; }
+    const QString& options() const { return _options; }
+
+private:
+    int _kind;
+    CostItem* _item;
+    EventType *_eventType, *_eventType2;
+    TracePartList _parts;
+    QString _options;
+};
+
+uint qHash(const ComputeKey&);
+
+
+/**
+ * Per-TraceData cache of derived data which is expensive to calculate,
+ * such as coverage lists or call graph layouts. Multiple views showing
+ * the same item with the same event type (e.g. in split MultiViews)
+ * share the result instead of calculating it again.
+ *
+ * As results depend on the cost of active parts, the cache is cleared
+ * on TraceData::invalidateDynamicCost().
+ * Access is serialized by a mutex: on frozen data, results can be
+ * looked up and inserted from multiple threads.
+ */
+class ComputeCache
+{
+public:
+    // kinds of results stored
+    enum Kind { CallerList = 1, CalleeList, CallerCoverage, CalleeCoverage,
+                CallGraphLayout };
+
+    explicit ComputeCache(TraceData*);
+    ~ComputeCache();
+
+    // key for a computation on currently active parts
+    ComputeKey key(Kind kind, CostItem* item,
+                   EventType* t, EventType* t2 = nullptr,
+                   const QString& options = QString());
+
+    /**
+     * Returns the result stored for <key>, or nullptr.
+     * A reference is added to the result, to be released with deref().
+     */
+    ComputeResult* result(const ComputeKey& key);
+
+    /**
+     * Store <r> for <key>, adding a reference to it.
+     * An old result for <key> is released.
+     */
+    void insert(const ComputeKey& key, ComputeResult* r);
+
+    void invalidate();
+
+    int count();
+    int hits() const { return _hits; }
+    int misses() const { return _misses; }
+
+    // maximal number of results kept
+    static const int maxResults;
+
+private:
+    TraceData* _data;
+    QMutex _mutex;
+    QHash<ComputeKey, ComputeResult*> _results;
+    // insertion order, for dropping oldest results
+    QList<ComputeKey> _order;
+    int _hits, _misses;
+};
+
+#endif
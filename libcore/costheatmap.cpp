@@ -0,0 +1,271 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Cost of source lines or instructions of a function per profile part
+ */
+
+#include "costheatmap.h"
+
+#include <algorithm>
+
+#include <QHash>
+
+#include "tracedata.h"
+#include "fixcost.h"
+#include "parallel.h"
+
+
+// a FixCost item with its position, for sorting into cells
+class HeatmapEntry
+{
+public:
+    int source;
+    uint line;
+    Addr addr;
+    int column;
+    FixCost* fix;
+
+    bool operator<(const HeatmapEntry& e) const
+    {
+        if (source != e.source) return source < e.source;
+        if (line != e.line) return line < e.line;
+        if (addr != e.addr) return addr < e.addr;
+        return column < e.column;
+    }
+
+    bool sameRow(const HeatmapEntry& e) const
+    { return (source == e.source) && (line == e.line) && (addr == e.addr); }
+};
+
+
+//---------------------------------------------------
+// HeatmapCostJob
+
+/* Evaluates cell costs for an event type, row by row */
+class HeatmapCostJob: public ParallelJob
+{
+public:
+    HeatmapCostJob(EventType* t, int realCount,
+                   const int* rowStart, const int* cellFixStart,
+                   FixCost* const* fix, SubCost* cellCost)
+        : _t(t), _realCount(realCount), _rowStart(rowStart),
+          _cellFixStart(cellFixStart), _fix(fix), _cellCost(cellCost),
+          maxCost(workers(), 0)
+    {
+        _maxCost = maxCost.data();
+    }
+
+    void run(int from, int to, int worker) override
+    {
+        QVector<SubCost> costs;
+        QVector<const SubCost*> columns(_realCount);
+
+        for(int row=from; row<to; row++) {
+            int first = _rowStart[row];
+            int n = _rowStart[row+1] - first;
+
+            // one column per real event type, one entry per cell
+            costs.fill(SubCost(0), n * _realCount);
+            SubCost* c = costs.data();
+            SubCost sum[MaxRealIndexValue];
+            for(int cell=0; cell<n; cell++) {
+                for(int i=0; i<_realCount; i++) sum[i] = 0;
+                for(int f=_cellFixStart[first + cell];
+                    f<_cellFixStart[first + cell + 1]; f++)
+                    _fix[f]->addTo(sum);
+                for(int i=0; i<_realCount; i++)
+                    c[i * n + cell] = sum[i];
+            }
+            for(int i=0; i<_realCount; i++)
+                columns[i] = c + i * n;
+            _t->subCosts(columns.constData(), n, _cellCost + first);
+
+            for(int cell=0; cell<n; cell++)
+                if (_cellCost[first + cell].v > _maxCost[worker])
+                    _maxCost[worker] = _cellCost[first + cell].v;
+        }
+    }
+
+private:
+    EventType* _t;
+    int _realCount;
+    const int* _rowStart;
+    const int* _cellFixStart;
+    FixCost* const* _fix;
+    SubCost* _cellCost;
+    uint64* _maxCost;
+
+public:
+    QVector<uint64> maxCost;
+};
+
+
+//---------------------------------------------------
+// CostHeatmap
+
+CostHeatmap::CostHeatmap()
+{
+    _function = nullptr;
+    _mode = Lines;
+    _eventType = nullptr;
+    _maxCost = 0;
+}
+
+void CostHeatmap::clear()
+{
+    _function = nullptr;
+    _eventType = nullptr;
+    _parts.clear();
+    _rows.clear();
+    _rowStart.clear();
+    _cellColumn.clear();
+    _cellFixStart.clear();
+    _fix.clear();
+    _cellCost.clear();
+    _maxCost = 0;
+}
+
+void CostHeatmap::calculate(TraceFunction* f, Mode mode)
+{
+    clear();
+    _function = f;
+    _mode = mode;
+    if (!f || !f->data()) return;
+
+    QHash<TracePart*, int> partIndex;
+    foreach(TracePart* part, f->data()->parts()) {
+        partIndex.insert(part, _parts.count());
+        _parts.append(part);
+    }
+
+    // source files in order of the function (its own file first)
+    QHash<TraceFunctionSource*, int> sourceIndex;
+    foreach(TraceFunctionSource* fs, f->sourceFiles())
+        sourceIndex.insert(fs, sourceIndex.count());
+
+    QVector<HeatmapEntry> entries;
+    foreach(TraceInclusiveCost* ic, f->deps()) {
+        TracePartFunction* pf = (TracePartFunction*) ic;
+        HeatmapEntry e;
+        e.column = partIndex.value(pf->part(), -1);
+        if (e.column < 0) continue;
+
+        for(FixCost* fc = pf->firstFixCost(); fc;
+            fc = fc->nextCostOfPartFunction()) {
+            if (mode == Lines) {
+                e.source = sourceIndex.value(fc->functionSource(),
+                                             sourceIndex.count());
+                e.line = fc->line();
+                e.addr = Addr(0);
+            }
+            else {
+                e.source = 0;
+                e.line = 0;
+                e.addr = fc->addr();
+            }
+            e.fix = fc;
+            entries.append(e);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    // CSR structure: rows, cells of rows, FixCost items of cells
+    _fix.reserve(entries.count());
+    for(int i=0; i<entries.count(); i++) {
+        const HeatmapEntry& e = entries.at(i);
+        bool newRow = (i == 0) || !e.sameRow(entries.at(i-1));
+        if (newRow) {
+            Row r;
+            r.source = (mode == Lines) ? e.fix->functionSource() : nullptr;
+            r.line = e.line;
+            r.addr = e.addr;
+            _rows.append(r);
+            _rowStart.append(_cellColumn.count());
+        }
+        if (newRow || (e.column != entries.at(i-1).column)) {
+            _cellColumn.append(e.column);
+            _cellFixStart.append(_fix.count());
+        }
+        _fix.append(e.fix);
+    }
+    _rowStart.append(_cellColumn.count());
+    _cellFixStart.append(_fix.count());
+
+    if (0) qDebug("CostHeatmap: %d rows, %d cells, %d FixCost items",
+                  _rows.count(), _cellColumn.count(), _fix.count());
+}
+
+void CostHeatmap::setEventType(EventType* t)
+{
+    _eventType = t;
+    _maxCost = 0;
+    _cellCost.fill(SubCost(0), _cellColumn.count());
+    if (!t || !_function || _rows.isEmpty()) return;
+
+    // no lazy parsing from parallel jobs
+    t->parseFormula();
+
+    HeatmapCostJob job(t, _function->data()->eventTypes()->realCount(),
+                       _rowStart.constData(), _cellFixStart.constData(),
+                       _fix.constData(), _cellCost.data());
+    Parallel::run(&job, _rows.count());
+
+    foreach(uint64 m, job.maxCost)
+        if (m > _maxCost.v) _maxCost = m;
+}
+
+QString CostHeatmap::rowLabel(int row) const
+{
+    const Row& r = _rows.at(row);
+    if (_mode == Instructions)
+        return QStringLiteral("0x%1").arg(r.addr.toString());
+
+    QString file = r.source ? r.source->file()->shortName() : QString();
+    if (r.line == 0)
+        return QStringLiteral("%1:??").arg(file);
+    return QStringLiteral("%1:%2").arg(file).arg(r.line);
+}
+
+int CostHeatmap::findRow(TraceFunctionSource* fs, uint line) const
+{
+    for(int row=0; row<_rows.count(); row++)
+        if ((_rows.at(row).source == fs) && (_rows.at(row).line == line))
+            return row;
+    return -1;
+}
+
+int CostHeatmap::findRow(Addr addr) const
+{
+    for(int row=0; row<_rows.count(); row++)
+        if (_rows.at(row).addr == addr)
+            return row;
+    return -1;
+}
+
+SubCost CostHeatmap::cost(int row, int col) const
+{
+    if ((row < 0) || (row >= _rows.count()) || _cellCost.isEmpty())
+        return 0;
+
+    const int* first = _cellColumn.constData() + _rowStart.at(row);
+    const int* last = _cellColumn.constData() + _rowStart.at(row+1);
+    const int* c = std::lower_bound(first, last, col);
+    if ((c == last) || (*c != col)) return 0;
+    return _cellCost.at(c - _cellColumn.constData());
+}
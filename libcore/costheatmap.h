@@ -0,0 +1,111 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Cost of source lines or instructions of a function per profile part
+ */
+
+#ifndef COSTHEATMAP_H
+#define COSTHEATMAP_H
+
+#include <QString>
+#include <QVector>
+
+#include "addr.h"
+#include "subcost.h"
+
+class TraceFunction;
+class TraceFunctionSource;
+class TracePart;
+class EventType;
+class FixCost;
+
+/**
+ * Cost of the source lines or instructions of one function for each
+ * profile part, e.g. for time slices of one run.
+ *
+ * calculate() does one pass over the FixCost lists of the function
+ * in all parts (not only active ones), collecting FixCost pointers
+ * per (row, part) cell. The cell matrix is stored in compressed sparse
+ * row format, so memory only depends on the number of FixCost items.
+ * Cell costs for an event type are evaluated in parallel over rows by
+ * setEventType(), using the summed real costs of a cell, so derived
+ * ratio events are correct.
+ * Costs are only available with FixCost data (USE_FIXCOST).
+ */
+class CostHeatmap
+{
+public:
+    enum Mode { Lines, Instructions };
+
+    CostHeatmap();
+
+    void clear();
+    void calculate(TraceFunction*, Mode);
+    void setEventType(EventType*);
+
+    TraceFunction* function() const { return _function; }
+    Mode mode() const { return _mode; }
+    EventType* eventType() const { return _eventType; }
+
+    int rowCount() const { return _rows.count(); }
+    int partCount() const { return _parts.count(); }
+    TracePart* part(int col) const { return _parts.value(col); }
+
+    // row position: source and line (Lines mode) or address
+    TraceFunctionSource* rowSource(int row) const { return _rows.at(row).source; }
+    uint rowLine(int row) const { return _rows.at(row).line; }
+    Addr rowAddr(int row) const { return _rows.at(row).addr; }
+    QString rowLabel(int row) const;
+    // row index of a line or address, -1 if not found
+    int findRow(TraceFunctionSource*, uint line) const;
+    int findRow(Addr) const;
+
+    // cells of a row with cost, sorted by part column: [first, end[
+    int cellStart(int row) const { return _rowStart.at(row); }
+    int cellEnd(int row) const { return _rowStart.at(row+1); }
+    int cellColumn(int cell) const { return _cellColumn.at(cell); }
+    SubCost cellCost(int cell) const { return _cellCost.at(cell); }
+    // cost of a cell, 0 if it has no cost
+    SubCost cost(int row, int col) const;
+    // highest cell cost, e.g. for color scaling
+    SubCost maxCost() const { return _maxCost; }
+
+private:
+    class Row {
+    public:
+        TraceFunctionSource* source;
+        uint line;
+        Addr addr;
+    };
+
+    TraceFunction* _function;
+    Mode _mode;
+    EventType* _eventType;
+
+    QVector<TracePart*> _parts;
+    QVector<Row> _rows;
+    QVector<int> _rowStart, _cellColumn;
+    // FixCost items of cell i: [_cellFixStart[i], _cellFixStart[i+1][
+    QVector<int> _cellFixStart;
+    QVector<FixCost*> _fix;
+    QVector<SubCost> _cellCost;
+    SubCost _maxCost;
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include <QObject>
 
 #include "tracedata.h"
+#include "costkernels.h"
 
 #define TRACE_DEBUG      0
 #define TRACE_ASSERTIONS 0
@@ -33,6 +34,7 @@ CostItem::CostItem(ProfileContext* c)
     _position = nullptr;
     _dep = nullptr;
     _dirty = true;
+    _frozen = false;
 
     _context = c;
 }
@@ -88,7 +90,7 @@ QString CostItem::toString()
 
 void CostItem::invalidate()
 {
-    if (_dirty) return;
+    if (_dirty || _frozen) return;
     _dirty = true;
 
     if (_dep)
@@ -100,6 +102,12 @@ void CostItem::update()
     _dirty = false;
 }
 
+void CostItem::freeze()
+{
+    if (_dirty) update();
+    _frozen = true;
+}
+
 TracePart* CostItem::part()
 {
     return _position ? _position->part() : nullptr;
@@ -425,14 +433,11 @@ void ProfileCostArray::addCost(ProfileCostArray* item)
     // make sure we have enough space allocated
     reserve(item->_count);
 
-    if (item->_count < _count) {
-        for (i = 0; i<item->_count; ++i)
-            _cost[i] += item->_cost[i];
-    }
+    if (item->_count < _count)
+        addCostVector(_cost, item->_cost, item->_count);
     else {
-        for (i = 0; i<_count; ++i)
-            _cost[i] += item->_cost[i];
-        for (; i<item->_count; ++i)
+        addCostVector(_cost, item->_cost, _count);
+        for (i = _count; i<item->_count; ++i)
             _cost[i] = item->_cost[i];
         _count = item->_count;
     }
@@ -462,14 +467,11 @@ void ProfileCostArray::maxCost(ProfileCostArray* item)
     // make sure we have enough space allocated
     reserve(item->_count);
 
-    if (item->_count < _count) {
-        for (i = 0; i<item->_count; ++i)
-            if (_cost[i] < item->_cost[i]) _cost[i] = item->_cost[i];
-    }
+    if (item->_count < _count)
+        maxCostVector(_cost, item->_cost, item->_count);
     else {
-        for (i = 0; i<_count; ++i)
-            if (_cost[i] < item->_cost[i]) _cost[i] = item->_cost[i];
-        for (; i<item->_count; ++i)
+        maxCostVector(_cost, item->_cost, _count);
+        for (i = _count; i<item->_count; ++i)
             _cost[i] = item->_cost[i];
         _count = item->_count;
     }
@@ -505,6 +507,44 @@ void ProfileCostArray::addCost(int realIndex, SubCost value)
     invalidate();
 }
 
+void ProfileCostArray::addCost(const SubCost* costs, int count)
+{
+    if (!costs || count <= 0) return;
+    if (count > MaxRealIndex) count = MaxRealIndex;
+
+    reserve(count);
+    for(int i=_count; i<count; i++)
+        _cost[i] = 0;
+    if (_count < count) _count = count;
+    addCostVector(_cost, costs, count);
+
+    invalidate();
+}
+
+void ProfileCostArray::addCosts(ProfileCostArray* const* items, int count)
+{
+    int i, maxCount = _count;
+
+    for(i=0; i<count; i++) {
+        ProfileCostArray* item = items[i];
+        // we access the item costs directly
+        if (item->_dirty) item->update();
+        if (item->_count > maxCount) maxCount = item->_count;
+    }
+
+    // extend to the maximal count once, then just add up
+    reserve(maxCount);
+    for(i=_count; i<maxCount; i++)
+        _cost[i] = 0;
+    _count = maxCount;
+
+    for(i=0; i<count; i++)
+        addCostVector(_cost, items[i]->_cost, items[i]->_count);
+
+    Q_ASSERT(_count <= _allocCount);
+    invalidate();
+}
+
 void ProfileCostArray::maxCost(int realIndex, SubCost value)
 {
     if (realIndex<0 || realIndex>=MaxRealIndex) return;
@@ -563,7 +603,7 @@ QString ProfileCostArray::costString(EventTypeSet* set)
 
 void ProfileCostArray::invalidate()
 {
-    if (_dirty) return;
+    if (_dirty || _frozen) return;
     _dirty = true;
     _cachedType = nullptr; // cached value is invalid, too
 
@@ -593,6 +633,8 @@ SubCost ProfileCostArray::subCost(int idx)
 SubCost ProfileCostArray::subCost(EventType* t)
 {
     if (!t) return 0;
+    // no cache update allowed for concurrent readers
+    if (_frozen) return t->subCost(this);
     if (_cachedType != t) {
         _cachedType = t;
         _cachedCost = t->subCost(this);
@@ -602,7 +644,8 @@ SubCost ProfileCostArray::subCost(EventType* t)
 
 QString ProfileCostArray::prettySubCost(EventType* t)
 {
-    return subCost(t).pretty();
+    SubCost c = subCost(t);
+    return t ? t->prettySubCost(c) : c.pretty();
 }
 
 QString ProfileCostArray::prettySubCostPerCall(EventType* t, uint64 calls)
@@ -615,6 +658,7 @@ QString ProfileCostArray::prettySubCostPerCall(EventType* t, uint64 calls)
          */
         calls = 1;
     }
-    return SubCost(subCost(t) / calls).pretty();
+    SubCost c = subCost(t) / calls;
+    return t ? t->prettySubCost(c) : c.pretty();
 }
 
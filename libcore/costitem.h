@@ -96,6 +96,17 @@ public:
 
     CostItem* dependent() { return _dep; }
 
+    /**
+     * Brings cost attributes up to date and switches off any
+     * modification on read access, including caching of the last
+     * queried sub cost. Afterwards, costs of this item can be read
+     * concurrently from multiple threads. Invalidation is ignored
+     * for frozen items. Subclasses freeze items they depend on.
+     * See TraceData::freeze().
+     */
+    virtual void freeze();
+    bool isFrozen() const { return _frozen; }
+
     /**
      * If this item is from a single profile data file, position
      * points to a TracePart, otherwise to a TraceData object.
@@ -121,7 +132,7 @@ protected:
     virtual void update();
 
     ProfileContext* _context;
-    bool _dirty;
+    bool _dirty, _frozen;
 
     CostItem* _position;
     CostItem* _dep;
@@ -171,6 +182,10 @@ public:
     // add the cost of another item
     void addCost(ProfileCostArray* item);
     void addCost(int index, SubCost value);
+    // add <count> costs, given in real index order
+    void addCost(const SubCost* costs, int count);
+    // add the costs of multiple items in one pass
+    void addCosts(ProfileCostArray* const* items, int count);
 
     // maximal cost
     void maxCost(EventTypeMapping*, FixString&);
@@ -0,0 +1,140 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Kernels for adding/maximizing cost vectors
+ */
+
+#include "costkernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COSTKERNELS_X86 1
+#include <immintrin.h>
+#else
+#define COSTKERNELS_X86 0
+#endif
+
+static_assert(sizeof(SubCost) == sizeof(uint64),
+              "cost kernels access SubCost arrays as uint64 arrays");
+
+typedef void (*CostKernel)(uint64*, const uint64*, int);
+
+static void addScalar(uint64* dst, const uint64* src, int n)
+{
+    for(int i=0; i<n; i++)
+        dst[i] += src[i];
+}
+
+static void maxScalar(uint64* dst, const uint64* src, int n)
+{
+    for(int i=0; i<n; i++)
+        if (dst[i] < src[i]) dst[i] = src[i];
+}
+
+#if COSTKERNELS_X86
+
+#ifdef __SSE2__
+// SSE2 has no 64bit compare, so there only is an add kernel
+static void addSSE2(uint64* dst, const uint64* src, int n)
+{
+    int i = 0;
+    for(; i+2 <= n; i += 2) {
+        __m128i d = _mm_loadu_si128((const __m128i*) (dst+i));
+        __m128i s = _mm_loadu_si128((const __m128i*) (src+i));
+        _mm_storeu_si128((__m128i*) (dst+i), _mm_add_epi64(d, s));
+    }
+    for(; i<n; i++)
+        dst[i] += src[i];
+}
+#endif
+
+__attribute__((target("avx2")))
+static void addAVX2(uint64* dst, const uint64* src, int n)
+{
+    int i = 0;
+    for(; i+4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256((const __m256i*) (dst+i));
+        __m256i s = _mm256_loadu_si256((const __m256i*) (src+i));
+        _mm256_storeu_si256((__m256i*) (dst+i), _mm256_add_epi64(d, s));
+    }
+    for(; i<n; i++)
+        dst[i] += src[i];
+}
+
+__attribute__((target("avx2")))
+static void maxAVX2(uint64* dst, const uint64* src, int n)
+{
+    // unsigned compare via signed compare with flipped sign bits
+    const __m256i sign = _mm256_set1_epi64x((long long) 0x8000000000000000ULL);
+    int i = 0;
+    for(; i+4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256((const __m256i*) (dst+i));
+        __m256i s = _mm256_loadu_si256((const __m256i*) (src+i));
+        __m256i gt = _mm256_cmpgt_epi64(_mm256_xor_si256(s, sign),
+                                        _mm256_xor_si256(d, sign));
+        _mm256_storeu_si256((__m256i*) (dst+i), _mm256_blendv_epi8(d, s, gt));
+    }
+    for(; i<n; i++)
+        if (dst[i] < src[i]) dst[i] = src[i];
+}
+
+#endif // COSTKERNELS_X86
+
+struct CostKernels
+{
+    CostKernel add;
+    CostKernel max;
+};
+
+static CostKernels selectKernels()
+{
+    CostKernels k;
+    k.add = addScalar;
+    k.max = maxScalar;
+
+#if COSTKERNELS_X86
+#ifdef __SSE2__
+    k.add = addSSE2;
+#endif
+    if (__builtin_cpu_supports("avx2")) {
+        k.add = addAVX2;
+        k.max = maxAVX2;
+    }
+#endif
+
+    return k;
+}
+
+// selected once, thread-safe
+static const CostKernels& kernels()
+{
+    static const CostKernels k = selectKernels();
+    return k;
+}
+
+void addCostVectorKernel(SubCost* dst, const SubCost* src, int n)
+{
+    if (n <= 0) return;
+    kernels().add((uint64*) dst, (const uint64*) src, n);
+}
+
+void maxCostVectorKernel(SubCost* dst, const SubCost* src, int n)
+{
+    if (n <= 0) return;
+    kernels().max((uint64*) dst, (const uint64*) src, n);
+}
@@ -0,0 +1,67 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Kernels for adding/maximizing cost vectors
+ */
+
+#ifndef COSTKERNELS_H
+#define COSTKERNELS_H
+
+#include "subcost.h"
+
+/**
+ * Element-wise operations on contiguous cost vectors, as used when
+ * aggregating the costs of dependent items. On x86, SSE2 or AVX2
+ * versions are selected at runtime depending on CPU support.
+ *
+ * Cost vectors have one entry per event type, usually only a few.
+ * Vectors shorter than CostKernelMinLength are handled by the inline
+ * loops below: for them, the indirect call into a selected kernel costs
+ * more than vectorization saves (see "cgview --kernel-bench").
+ */
+
+enum { CostKernelMinLength = 8 };
+
+// out-of-line kernels selected at runtime, for any length
+void addCostVectorKernel(SubCost* dst, const SubCost* src, int n);
+void maxCostVectorKernel(SubCost* dst, const SubCost* src, int n);
+
+// dst[i] += src[i] for 0 <= i < n
+inline void addCostVector(SubCost* dst, const SubCost* src, int n)
+{
+    if (n >= CostKernelMinLength) {
+        addCostVectorKernel(dst, src, n);
+        return;
+    }
+    for(int i=0; i<n; i++)
+        dst[i].v += src[i].v;
+}
+
+// dst[i] = max(dst[i], src[i]) for 0 <= i < n
+inline void maxCostVector(SubCost* dst, const SubCost* src, int n)
+{
+    if (n >= CostKernelMinLength) {
+        maxCostVectorKernel(dst, src, n);
+        return;
+    }
+    for(int i=0; i<n; i++)
+        if (dst[i].v < src[i].v) dst[i].v = src[i].v;
+}
+
+#endif
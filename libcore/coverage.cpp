@@ -24,13 +24,19 @@
 
 //#define DEBUG_COVERAGE 1
 
-EventType* Coverage::_costType;
-
 const int Coverage::maxHistogramDepth = maxHistogramDepthValue;
 const int Coverage::Rtti = 1;
 
 Coverage::Coverage()
 {
+    _costType = nullptr;
+    _map = nullptr;
+}
+
+Coverage::~Coverage()
+{
+    // not associated: the function may be gone already
+    if (_map) _function = nullptr;
 }
 
 void Coverage::init()
@@ -78,16 +84,35 @@ int Coverage::selfMedian()
     return medD;
 }
 
+
+//---------------------------------------------------
+// CoverageValues
+
+CoverageValues::CoverageValues(Coverage* c)
+{
+    _function = c->function();
+    _self = c->self();
+    _incl = c->inclusive();
+    _callCount = c->callCount();
+    _minDistance = c->minDistance();
+    _maxDistance = c->maxDistance();
+    _inclMedian = c->inclusiveMedian();
+    _selfMedian = c->selfMedian();
+    for (int i = 0;i<Coverage::maxHistogramDepth;i++) {
+        _selfHisto[i] = c->selfHistogram()[i];
+        _inclHisto[i] = c->inclusiveHistogram()[i];
+    }
+}
+
 TraceFunctionList Coverage::coverage(TraceFunction* f, CoverageMode m,
                                      EventType* ct)
 {
     invalidate(f->data(), Coverage::Rtti);
 
-    _costType = ct;
-
     // function f takes ownership over c!
     Coverage* c = new Coverage();
     c->setFunction(f);
+    c->_costType = ct;
     c->init();
 
     TraceFunctionList l;
@@ -100,6 +125,53 @@ TraceFunctionList Coverage::coverage(TraceFunction* f, CoverageMode m,
     return l;
 }
 
+TraceFunctionList Coverage::coverage(TraceFunction* f, CoverageMode m,
+                                     EventType* ct, CoverageMap* result)
+{
+    Coverage* c = new Coverage();
+    c->_function = f;
+    c->_costType = ct;
+    c->_map = result;
+    c->init();
+    result->insert(f, c);
+
+    TraceFunctionList l;
+
+    if (m == Caller)
+        c->addCallerCoverage(l, 1.0, 0);
+    else
+        c->addCallingCoverage(l, 1.0, 1.0, 0);
+
+    return l;
+}
+
+Coverage* Coverage::coverageOf(TraceFunction* f, TraceFunctionList& l)
+{
+    Coverage* c;
+    if (_map) {
+        c = _map->value(f);
+        if (!c) {
+            c = new Coverage();
+            c->_function = f;
+            c->_map = _map;
+            _map->insert(f, c);
+        }
+    }
+    else {
+        c = (Coverage*) f->association(rtti());
+        if (!c) {
+            c = new Coverage();
+            c->setFunction(f);
+        }
+    }
+    c->_costType = _costType;
+    if (!c->isValid()) {
+        c->init();
+        l.append(f);
+    }
+    return c;
+}
+
 void Coverage::addCallerCoverage(TraceFunctionList& fList,
                                  double pBack, int d)
 {
@@ -147,15 +219,7 @@ void Coverage::addCallerCoverage(TraceFunctionList& fList,
         if (call->subCost(_costType)>0) {
             TraceFunction* caller = call->caller();
 
-            Coverage* c = (Coverage*) caller->association(rtti());
-            if (!c) {
-                c = new Coverage();
-                c->setFunction(caller);
-            }
-            if (!c->isValid()) {
-                c->init();
-                fList.append(caller);
-            }
+            Coverage* c = coverageOf(caller, fList);
 
             if (c->isActive()) continue;
             if (c->inRecursion()) continue;
@@ -258,15 +322,7 @@ void Coverage::addCallingCoverage(TraceFunctionList& fList,
         if (call->subCost(_costType)>0) {
             TraceFunction* calling = call->called();
 
-            Coverage* c = (Coverage*) calling->association(rtti());
-            if (!c) {
-                c = new Coverage();
-                c->setFunction(calling);
-            }
-            if (!c->isValid()) {
-                c->init();
-                fList.append(calling);
-            }
+            Coverage* c = coverageOf(calling, fList);
 
             if (c->isActive()) continue;
             if (c->inRecursion()) continue;
@@ -23,8 +23,15 @@
 #ifndef COVERAGE_H
 #define COVERAGE_H
 
+#include <QHash>
+
 #include "tracedata.h"
 
+class Coverage;
+
+// results of a coverage analysis not using associations
+typedef QHash<TraceFunction*, Coverage*> CoverageMap;
+
 /**
  * Coverage of a function.
  * When analysis is done, every function involved will have a
@@ -46,6 +53,7 @@ public:
     static const int Rtti;
 
     Coverage();
+    ~Coverage() override;
 
     int rtti() override { return Rtti; }
     void init();
@@ -84,9 +92,22 @@ public:
     static TraceFunctionList coverage(TraceFunction* f, CoverageMode m,
                                       EventType* ct);
 
+    /**
+     * Same analysis, but the Coverage objects are put into <result>
+     * (including the one of f) instead of being associated with the
+     * functions. The caller owns them, and has to delete them before
+     * the functions. As the data model is not modified, this can be
+     * run from multiple threads at the same time on frozen data
+     * (see TraceData::freeze()).
+     */
+    static TraceFunctionList coverage(TraceFunction* f, CoverageMode m,
+                                      EventType* ct, CoverageMap* result);
+
 private:
     void addCallerCoverage(TraceFunctionList& l, double, int d);
     void addCallingCoverage(TraceFunctionList& l, double, double, int d);
+    // coverage object of <f> in current analysis, appended to <l> if new
+    Coverage* coverageOf(TraceFunction* f, TraceFunctionList& l);
 
     double _self, _incl, _firstPercentage, _callCount;
     int _minDistance, _maxDistance;
@@ -94,8 +115,41 @@ private:
     double _selfHisto[maxHistogramDepthValue];
     double _inclHisto[maxHistogramDepthValue];
 
-    // temporary set for one coverage analysis
-    static EventType* _costType;
+    // set for one coverage analysis
+    EventType* _costType;
+    // not associated with function if set
+    CoverageMap* _map;
+};
+
+/**
+ * Copy of the results of a coverage analysis for one function.
+ * In contrast to Coverage, this is not an association of the function,
+ * and thus can be kept after the next analysis without ever touching
+ * the function again (e.g. on deletion after the trace data is gone).
+ */
+class CoverageValues
+{
+public:
+    explicit CoverageValues(Coverage*);
+
+    TraceFunction* function() const { return _function; }
+    double self() const { return _self; }
+    double inclusive() const { return _incl; }
+    double callCount() const { return _callCount; }
+    int minDistance() const { return _minDistance; }
+    int maxDistance() const { return _maxDistance; }
+    int inclusiveMedian() const { return _inclMedian; }
+    int selfMedian() const { return _selfMedian; }
+    double* selfHistogram() { return _selfHisto; }
+    double* inclusiveHistogram() { return _inclHisto; }
+
+private:
+    TraceFunction* _function;
+    double _self, _incl, _callCount;
+    int _minDistance, _maxDistance;
+    int _inclMedian, _selfMedian;
+    double _selfHisto[maxHistogramDepthValue];
+    double _inclHisto[maxHistogramDepthValue];
 };
 
 #endif
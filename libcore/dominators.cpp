@@ -0,0 +1,241 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Dominator tree of the call graph
+ */
+
+#include "dominators.h"
+
+#include "tracedata.h"
+
+
+//---------------------------------------------------
+// Dominators
+
+// call with a call count or with cost for any real event type
+static bool isEdge(TraceCall* c, EventTypeSet* set)
+{
+    if (c->callCount() > 0) return true;
+    for(int e=0; e<set->realCount(); e++)
+        if (c->subCost(set->realType(e)) != 0) return true;
+    return false;
+}
+
+Dominators::Dominators(TraceData* data)
+{
+    _data = data;
+    _valid = false;
+    _realCount = 0;
+}
+
+int Dominators::node(TraceFunction* f)
+{
+    if (!f) return -1;
+    if (f->cycle()) f = f->cycle();
+    return _node.value(f, -1);
+}
+
+// common dominator of <a> and <b>, using postorder numbers <po>
+static int intersect(int a, int b, const QVector<int>& idom,
+                     const QVector<int>& po)
+{
+    while(a != b) {
+        while(po.at(a) < po.at(b)) a = idom.at(a);
+        while(po.at(b) < po.at(a)) b = idom.at(b);
+    }
+    return a;
+}
+
+void Dominators::calculate()
+{
+    if (_valid) return;
+    _valid = true;
+
+    EventTypeSet* set = _data->eventTypes();
+    _realCount = set->realCount();
+
+    // nodes: functions, cycle members collapsed into their cycle
+    _function.clear();
+    _node.clear();
+    _function.append(nullptr);
+    TraceFunctionMap::Iterator it;
+    for (it = _data->functionMap().begin();
+         it != _data->functionMap().end(); ++it) {
+        TraceFunction* f = &(*it);
+        if (f->cycle()) f = f->cycle();
+        if (_node.contains(f)) continue;
+        _node.insert(f, _function.count());
+        _function.append(f);
+    }
+    int count = _function.count();
+
+    // edges as successor/predecessor arrays (CSR)
+    QVector<int> edgeFrom, edgeTo;
+    QVector<int> succStart(count+1, 0), predStart(count+1, 0);
+    for (it = _data->functionMap().begin();
+         it != _data->functionMap().end(); ++it) {
+        int from = node(&(*it));
+        foreach(TraceCall* c, (*it).callings(true)) {
+            // calls without call count but with cost (e.g. Massif)
+            // are edges, too
+            if (!isEdge(c, set)) continue;
+            int to = node(c->called(true));
+            if ((to < 0) || (to == from)) continue;
+            edgeFrom.append(from);
+            edgeTo.append(to);
+            succStart[from+1]++;
+            predStart[to+1]++;
+        }
+    }
+    for(int n=0; n<count; n++) {
+        succStart[n+1] += succStart[n];
+        predStart[n+1] += predStart[n];
+    }
+    QVector<int> succ(edgeFrom.count()), pred(edgeFrom.count());
+    {
+        QVector<int> succPos = succStart, predPos = predStart;
+        for(int e=0; e<edgeFrom.count(); e++) {
+            succ[succPos[edgeFrom.at(e)]++] = edgeTo.at(e);
+            pred[predPos[edgeTo.at(e)]++] = edgeFrom.at(e);
+        }
+    }
+
+    // iterative DFS from root giving postorder numbers. Root children
+    // are functions never called, and then (without cycle collapsing)
+    // any function still unreachable
+    QVector<int> po(count, -1);
+    QVector<int> post;
+    QVector<bool> rootChild(count, false);
+    QVector<int> stack, stackPos;
+    post.reserve(count);
+    po[0] = 0; // visited, number set at end
+    for(int pass=0; pass<2; pass++) {
+        for(int r=1; r<count; r++) {
+            if (po.at(r) >= 0) continue;
+            if ((pass == 0) && (predStart.at(r+1) > predStart.at(r))) continue;
+
+            rootChild[r] = true;
+            po[r] = 0;
+            stack.append(r);
+            stackPos.append(succStart.at(r));
+            while(!stack.isEmpty()) {
+                int n = stack.last();
+                int& pos = stackPos.last();
+                if (pos < succStart.at(n+1)) {
+                    int s = succ.at(pos++);
+                    if (po.at(s) >= 0) continue;
+                    po[s] = 0;
+                    stack.append(s);
+                    stackPos.append(succStart.at(s));
+                    continue;
+                }
+                po[n] = post.count();
+                post.append(n);
+                stack.removeLast();
+                stackPos.removeLast();
+            }
+        }
+    }
+    po[0] = post.count();
+    post.append(0);
+
+    // Cooper/Harvey/Kennedy: iterate in reverse postorder until stable
+    _idom.fill(-1, count);
+    _idom[0] = 0;
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(int i=post.count()-2; i>=0; i--) {
+            int b = post.at(i);
+            int newIdom = rootChild.at(b) ? 0 : -1;
+            for(int e=predStart.at(b); e<predStart.at(b+1); e++) {
+                int p = pred.at(e);
+                if (_idom.at(p) < 0) continue;
+                newIdom = (newIdom < 0) ? p : intersect(p, newIdom, _idom, po);
+            }
+            if (_idom.at(b) != newIdom) {
+                _idom[b] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    // dominated cost: self cost summed up the tree in postorder
+    _cost.fill(SubCost(0), count * _realCount);
+    for(int n=1; n<count; n++) {
+        TraceFunction* f = _function.at(n);
+        SubCost* c = _cost.data() + n * _realCount;
+        TraceFunctionList members;
+        if (f->cycle() == f)
+            members = ((TraceFunctionCycle*)f)->members();
+        else
+            members.append(f);
+        foreach(TraceFunction* m, members)
+            for(int e=0; e<_realCount; e++)
+                c[e] += m->subCost(set->realType(e));
+    }
+    for(int i=0; i<post.count()-1; i++) {
+        int n = post.at(i);
+        int d = _idom.at(n);
+        if (d <= 0) continue;
+        SubCost* c = _cost.data() + n * _realCount;
+        SubCost* dc = _cost.data() + d * _realCount;
+        for(int e=0; e<_realCount; e++)
+            dc[e] += c[e];
+    }
+
+    if (0) qDebug("Dominators: %d nodes, %d edges", count, edgeFrom.count());
+}
+
+TraceFunction* Dominators::immediateDominator(TraceFunction* f)
+{
+    calculate();
+
+    int n = node(f);
+    if (n <= 0) return nullptr;
+    int d = _idom.at(n);
+    return (d > 0) ? _function.at(d) : nullptr;
+}
+
+void Dominators::addDominatedCost(TraceFunction* f, ProfileCostArray* c)
+{
+    calculate();
+
+    int n = node(f);
+    if (n <= 0) return;
+    const SubCost* dc = _cost.constData() + n * _realCount;
+    for(int e=0; e<_realCount; e++)
+        c->addCost(e, dc[e]);
+}
+
+SubCost Dominators::dominatedCost(TraceFunction* f, EventType* t)
+{
+    if (!t) return 0;
+    calculate();
+
+    int n = node(f);
+    if (n <= 0) return 0;
+    if (t->isReal())
+        return _cost.at(n * _realCount + t->realIndex());
+
+    // derived event type: evaluate formula
+    ProfileCostArray c;
+    addDominatedCost(f, &c);
+    return c.subCost(t);
+}
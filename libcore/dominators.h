@@ -0,0 +1,86 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Dominator tree of the call graph
+ */
+
+#ifndef DOMINATORS_H
+#define DOMINATORS_H
+
+#include <QHash>
+#include <QVector>
+
+#include "subcost.h"
+
+class TraceData;
+class TraceFunction;
+class EventType;
+class ProfileCostArray;
+
+/**
+ * Immediate dominators of functions in the call graph, and for each
+ * function the "dominated cost": the sum of the self cost of all
+ * functions dominated by it. This is the cost which would disappear
+ * if the function would not be called any more.
+ *
+ * The graph is rooted at a virtual program root calling every
+ * function without callers. If cycle detection is switched on,
+ * each cycle is collapsed into its TraceFunctionCycle; members of a
+ * cycle get the values of their cycle. Calls with a call count or
+ * with cost in active parts are used as edges (Massif profiles have
+ * no call counts).
+ *
+ * Dominators are calculated with the iterative algorithm of Cooper,
+ * Harvey and Kennedy over reverse postorder, the dominated cost in
+ * one postorder pass over the resulting tree. Both are linear in
+ * practice, even for call graphs with hundreds of thousands of nodes.
+ */
+class Dominators
+{
+public:
+    explicit Dominators(TraceData*);
+
+    void invalidate() { _valid = false; }
+    bool isValid() const { return _valid; }
+    void calculate();
+
+    // all accessors below call calculate() if needed
+
+    // nullptr if only dominated by the program root
+    TraceFunction* immediateDominator(TraceFunction*);
+    SubCost dominatedCost(TraceFunction*, EventType*);
+    // add dominated cost of all real event types to <c>
+    void addDominatedCost(TraceFunction*, ProfileCostArray* c);
+
+private:
+    int node(TraceFunction*);
+
+    TraceData* _data;
+    bool _valid;
+    int _realCount;
+
+    // node 0 is the program root
+    QVector<TraceFunction*> _function;
+    QHash<TraceFunction*, int> _node;
+    QVector<int> _idom;
+    // dominated cost of node n at [n * _realCount]
+    QVector<SubCost> _cost;
+};
+
+#endif
@@ -18,16 +18,337 @@
 
 #include "eventtype.h"
 
-#include <QRegExp>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
 
 #include "globalconfig.h"
 
+//---------------------------------------------------
+// FormulaParser
+
+/*
+ * A formula normalized into
+ *   (sum num[i]*cost[i] + numConst) / (sum den[i]*cost[i] + denConst)
+ * Without division by event costs, den is zero and denConst is 1.
+ */
+struct FormulaTerm
+{
+    double num[MaxRealIndexValue], numConst;
+    double den[MaxRealIndexValue], denConst;
+    bool ratio;
+    // normalized formula, using event names as given
+    QString text;
+    bool isSum;
+
+    void setConstant(double c)
+    {
+        for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
+            num[i] = den[i] = 0.0;
+        numConst = c;
+        denConst = 1.0;
+        ratio = false;
+        setText(c);
+    }
+
+    void setText(double c)
+    {
+        text = QString::number(c, 'g', 15);
+        isSum = false;
+    }
+
+    // text with parentheses if needed as operand of '*' or '/'
+    QString operand() const
+    { return isSum ? QStringLiteral("(%1)").arg(text) : text; }
+
+    bool isConstant() const
+    {
+        if (ratio) return false;
+        for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
+            if (num[i] != 0.0) return false;
+        return true;
+    }
+
+    bool isZero() const { return isConstant() && (numConst == 0.0); }
+
+    void scale(double f)
+    {
+        for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
+            num[i] *= f;
+        numConst *= f;
+    }
+
+    bool sameDivisor(const FormulaTerm& t) const
+    {
+        if (denConst != t.denConst) return false;
+        for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
+            if (den[i] != t.den[i]) return false;
+        return true;
+    }
+};
+
+/*
+ * Recursive descent parser for event formulas:
+ *
+ *   expr   := term { ('+'|'-') term }
+ *   term   := factor { ['*'|'/'] factor }   (no operator: multiply)
+ *   factor := ('+'|'-') factor | '(' expr ')' | number | name
+ *
+ * Names not defined in the event type set evaluate to 0, as before.
+ * Only one division by a non-constant expression is supported,
+ * and ratios with different divisors can not be added.
+ */
+class FormulaParser
+{
+public:
+    FormulaParser(EventTypeSet* set, const QString& formula)
+    {
+        _set = set;
+        _formula = formula;
+        _pos = 0;
+        _ok = true;
+        found = matching = 0;
+    }
+
+    bool parse(FormulaTerm& t)
+    {
+        skipSpace();
+        if (_pos == _formula.length()) {
+            t.setConstant(0.0);
+            return true;
+        }
+        expr(t);
+        skipSpace();
+        if (_pos < _formula.length()) _ok = false;
+        return _ok;
+    }
+
+    int found;    // how many types are referenced in formula
+    int matching; // how many types actually are defined in profile data
+
+private:
+    void skipSpace()
+    {
+        while((_pos < _formula.length()) && _formula[_pos].isSpace())
+            _pos++;
+    }
+
+    QChar peek()
+    {
+        skipSpace();
+        return (_pos < _formula.length()) ? _formula[_pos] : QChar();
+    }
+
+    void expr(FormulaTerm& t)
+    {
+        term(t);
+        while(_ok) {
+            QChar c = peek();
+            if ((c != '+') && (c != '-')) break;
+            _pos++;
+            FormulaTerm t2;
+            term(t2);
+            add(t, t2, (c == '-'));
+        }
+    }
+
+    void term(FormulaTerm& t)
+    {
+        factor(t);
+        while(_ok) {
+            QChar c = peek();
+            bool divide = (c == '/');
+            if ((c == '*') || divide)
+                _pos++;
+            else if (!c.isLetterOrNumber() && (c != '_') &&
+                     (c != '.') && (c != '('))
+                break;
+            FormulaTerm t2;
+            factor(t2);
+            if (divide)
+                div(t, t2);
+            else
+                mul(t, t2);
+        }
+    }
+
+    void factor(FormulaTerm& t)
+    {
+        t.setConstant(0.0);
+        if (!_ok) return;
+
+        QChar c = peek();
+        if ((c == '+') || (c == '-')) {
+            _pos++;
+            factor(t);
+            if (c == '-') negate(t);
+            return;
+        }
+        if (c == '(') {
+            _pos++;
+            expr(t);
+            if (peek() != ')') { _ok = false; return; }
+            _pos++;
+            return;
+        }
+
+        int start = _pos;
+        if (c.isDigit() || (c == '.')) {
+            while((_pos < _formula.length()) &&
+                  (_formula[_pos].isDigit() || (_formula[_pos] == '.')))
+                _pos++;
+            t.numConst = _formula.mid(start, _pos - start).toDouble(&_ok);
+            t.setText(t.numConst);
+            return;
+        }
+        while((_pos < _formula.length()) &&
+              (_formula[_pos].isLetterOrNumber() || (_formula[_pos] == '_')))
+            _pos++;
+        if (_pos == start) { _ok = false; return; }
+        t.numConst = 0.0;
+        found++;
+
+        QString costName = _formula.mid(start, _pos - start);
+        EventType* eventType = _set->type(costName);
+        if (!eventType) {
+            //qDebug("In formula cost '%s' unknown.", qPrintable(costName));
+            return;
+        }
+        matching++;
+        t.text = costName;
+
+        if (eventType->isReal()) {
+            t.num[eventType->realIndex()] = 1.0;
+            return;
+        }
+        if (!eventType->parseFormula()) return;
+        for (int i=0; i<ProfileCostArray::MaxRealIndex;i++) {
+            t.num[i] = eventType->_coefficient[i];
+            t.den[i] = eventType->_divisor[i];
+        }
+        t.numConst = eventType->_constant;
+        t.denConst = eventType->_divisorConstant;
+        t.ratio = eventType->_isRatio;
+    }
+
+    void negate(FormulaTerm& t)
+    {
+        t.scale(-1.0);
+        if (t.isConstant()) {
+            t.setText(t.numConst);
+            return;
+        }
+        t.text = QStringLiteral("- %1").arg(t.operand());
+        t.isSum = true;
+    }
+
+    void add(FormulaTerm& t, FormulaTerm& t2, bool subtract)
+    {
+        if (t2.isZero()) return;
+        if (t.isZero()) {
+            t = t2;
+            if (subtract) negate(t);
+            return;
+        }
+        QString text = subtract ? t2.operand() : t2.text;
+        if (subtract) t2.scale(-1.0);
+        if ((t.ratio != t2.ratio) || (t.ratio && !t.sameDivisor(t2))) {
+            qDebug("FormulaParser: Sum of ratios with different divisors "
+                   "not supported in '%s'", qPrintable(_formula));
+            _ok = false;
+            return;
+        }
+        for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
+            t.num[i] += t2.num[i];
+        t.numConst += t2.numConst;
+
+        if (t.isConstant() && t2.isConstant()) {
+            t.setText(t.numConst);
+            return;
+        }
+        t.text += QStringLiteral(" %1 %2").arg(subtract ? '-' : '+').arg(text);
+        t.isSum = true;
+    }
+
+    void mul(FormulaTerm& t, const FormulaTerm& t2)
+    {
+        if (t2.isConstant()) {
+            t.scale(t2.numConst);
+            scaleText(t, t2.numConst);
+            return;
+        }
+        if (t.isConstant()) {
+            double f = t.numConst;
+            t = t2;
+            t.scale(f);
+            scaleText(t, f);
+            return;
+        }
+        qDebug("FormulaParser: Product of event costs not supported in '%s'",
+               qPrintable(_formula));
+        _ok = false;
+    }
+
+    void div(FormulaTerm& t, const FormulaTerm& t2)
+    {
+        if (t2.isConstant()) {
+            if (t2.numConst == 0.0) {
+                // also happens if all events of the divisor are unknown
+                _ok = false;
+                return;
+            }
+            t.scale(1.0 / t2.numConst);
+            if (t.isConstant())
+                t.setText(t.numConst);
+            else {
+                t.text = QStringLiteral("%1 / %2").arg(t.operand(), t2.text);
+                t.isSum = false;
+            }
+            return;
+        }
+        if (t.ratio || t2.ratio) {
+            qDebug("FormulaParser: Nested division not supported in '%s'",
+                   qPrintable(_formula));
+            _ok = false;
+            return;
+        }
+        for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
+            t.den[i] = t2.num[i];
+        t.denConst = t2.numConst;
+        t.ratio = true;
+        t.text = QStringLiteral("%1 / %2").arg(t.operand(), t2.operand());
+        t.isSum = false;
+    }
+
+    // text of <t> after scaling by <f>: constant factor first, 1 omitted
+    void scaleText(FormulaTerm& t, double f)
+    {
+        if (t.isConstant()) {
+            t.setText(t.numConst);
+            return;
+        }
+        if (f == 1.0) return;
+        t.text = QStringLiteral("%1 %2").arg(QString::number(f, 'g', 15),
+                                             t.operand());
+        t.isSum = false;
+    }
+
+    EventTypeSet* _set;
+    QString _formula;
+    int _pos;
+    bool _ok;
+};
+
+
 //---------------------------------------------------
 // EventType
 
 QList<EventType*>* EventType::_knownTypes = nullptr;
 
+// loaders may register types while loading in parallel
+static QMutex knownTypesMutex;
+
 EventType::EventType(const QString& name, const QString& longName,
                      const QString& formula)
 {
@@ -39,9 +360,15 @@ EventType::EventType(const QString& name, const QString& longName,
     _realIndex = ProfileCostArray::InvalidIndex;
     _parsed = false;
     _inParsing = false;
+    _isRatio = false;
+    _isIntegral = true;
+    _constant = 0.0;
+    _divisorConstant = 1.0;
 
-    for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
-        _coefficient[i] = 0;
+    for (int i=0; i<ProfileCostArray::MaxRealIndex;i++) {
+        _coefficient[i] = 0.0;
+        _divisor[i] = 0.0;
+    }
 }
 
 void EventType::setFormula(const QString& formula)
@@ -88,73 +415,41 @@ bool EventType::parseFormula()
 
     _inParsing = true;
 
-    for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
-        _coefficient[i] = 0;
+    for (int i=0; i<ProfileCostArray::MaxRealIndex;i++) {
+        _coefficient[i] = 0.0;
+        _divisor[i] = 0.0;
+    }
+    _constant = 0.0;
+    _divisorConstant = 1.0;
+    _isRatio = false;
+    _isIntegral = true;
     _parsedFormula = QString();
 
-    QRegExp rx( QStringLiteral("((?:\\+|\\-)?)\\s*(\\d*)\\s*\\*?\\s*(\\w+)") );
-
-    int factor, pos, found, matching;
-    QString costName;
-    EventType* eventType;
-
-    found = 0;    // how many types are referenced in formula
-    matching = 0; // how many types actually are defined in profile data
-    pos = 0;
-    while (1) {
-        pos = rx.indexIn(_formula, pos);
-        if (pos<0) break;
-        pos += rx.matchedLength();
-        if (rx.cap(0).isEmpty()) break;
-        found++;
-
-        //qDebug("parseFormula: matched '%s','%s','%s'",
-        //       qPrintable(rx.cap(1)), qPrintable(rx.cap(2)), qPrintable(rx.cap(3)));
-
-        costName = rx.cap(3);
-        eventType = _set->type(costName);
-        if (!eventType) {
-            //qDebug("Cost type '%s': In formula cost '%s' unknown.",
-            //     qPrintable(_name), qPrintable(costName));
-            continue;
-        }
-
-        factor = (rx.cap(2).isEmpty()) ? 1 : rx.cap(2).toInt();
-        if (rx.cap(1) == QLatin1String("-")) factor = -factor;
-        if (factor == 0) continue;
-
-        matching++;
-
-        if (!_parsedFormula.isEmpty()) {
-            _parsedFormula += QStringLiteral(" %1 ").arg((factor>0) ? '+':'-');
-        }
-        else if (factor<0)
-            _parsedFormula += QLatin1String("- ");
-        if ((factor!=-1) && (factor!=1))
-            _parsedFormula += QString::number( (factor>0)?factor:-factor ) + ' ';
-        _parsedFormula += costName;
-
-        if (eventType->isReal())
-            _coefficient[eventType->realIndex()] += factor;
-        else {
-            eventType->parseFormula();
-            for (int i=0; i<ProfileCostArray::MaxRealIndex;i++)
-                _coefficient[i] += factor * eventType->_coefficient[i];
-        }
-    }
+    FormulaParser parser(_set, _formula);
+    FormulaTerm* t = new FormulaTerm;
+    bool ok = parser.parse(*t);
 
     _inParsing = false;
-    if (found == 0) {
-        // empty formula
-        _parsedFormula = QStringLiteral("0");
-        _parsed = true;
-        return true;
+    if (!ok || ((parser.found > 0) && (parser.matching == 0))) {
+        delete t;
+        return false;
     }
-    if (matching>0) {
-        _parsed = true;
-        return true;
+
+    for (int i=0; i<ProfileCostArray::MaxRealIndex;i++) {
+        _coefficient[i] = t->num[i];
+        _divisor[i] = t->den[i];
+        if (_coefficient[i] != (double)(qint64)_coefficient[i])
+            _isIntegral = false;
     }
-    return false;
+    _constant = t->numConst;
+    _divisorConstant = t->denConst;
+    _isRatio = t->ratio;
+    if (_isRatio || (_constant != 0.0)) _isIntegral = false;
+    _parsedFormula = t->isZero() ? QStringLiteral("0") : t->text;
+    delete t;
+
+    _parsed = true;
+    return true;
 }
 
 
@@ -166,24 +461,27 @@ QString EventType::parsedFormula()
     return _parsedFormula;
 }
 
-QString EventType::parsedRealFormula()
+// linear combination of real events as string, e.g. "2 * Ir + 1 * Dr"
+static QString linearFormula(EventTypeSet* set, const double* coefficient,
+                             double constant, int* terms)
 {
     QString res;
 
-    if (!parseFormula()) return res;
-
-    for (int i=0; i<ProfileCostArray::MaxRealIndex;i++) {
-        int c = _coefficient[i];
-        if (c == 0) continue;
+    *terms = 0;
+    for (int i=0; i<=ProfileCostArray::MaxRealIndex;i++) {
+        double c = (i<ProfileCostArray::MaxRealIndex) ? coefficient[i] : constant;
+        if (c == 0.0) continue;
+        (*terms)++;
 
         if (!res.isEmpty()) {
             res += ' ';
             if (c>0) res += QLatin1String("+ ");
         }
         if (c<0) { res += QLatin1String("- "); c = -c; }
-        res += QString::number(c);
+        res += QString::number(c, 'g', 15);
+        if (i == ProfileCostArray::MaxRealIndex) break;
 
-        EventType* t = _set->type(i);
+        EventType* t = set->type(i);
         if (!t) continue;
 
         if (!t->name().isEmpty())
@@ -193,6 +491,23 @@ QString EventType::parsedRealFormula()
     return res;
 }
 
+QString EventType::parsedRealFormula()
+{
+    QString res;
+
+    if (!parseFormula()) return res;
+
+    int terms;
+    res = linearFormula(_set, _coefficient, _constant, &terms);
+    if (!_isRatio) return res;
+
+    if (terms > 1) res = QStringLiteral("(%1)").arg(res);
+    QString div = linearFormula(_set, _divisor, _divisorConstant, &terms);
+    if (terms > 1) div = QStringLiteral("(%1)").arg(div);
+
+    return QStringLiteral("%1 / %2").arg(res, div);
+}
+
 SubCost EventType::subCost(ProfileCostArray* c)
 {
     if (_realIndex != ProfileCostArray::InvalidIndex)
@@ -201,16 +516,107 @@ SubCost EventType::subCost(ProfileCostArray* c)
     if (!_parsed) {
         if (!parseFormula()) return 0;
     }
+
+    if (!_isIntegral) {
+        double v = value(c);
+        if (_isRatio) v *= RatioScale;
+        return (v > 0.0) ? SubCost(v) : SubCost(0);
+    }
+
     SubCost res = 0;
 
     int rc = _set->realCount();
     for (int i = 0;i<rc;i++)
         if (_coefficient[i] != 0)
-            res += _coefficient[i] * c->subCost(i);
+            res += (uint64)(qint64)_coefficient[i] * c->subCost(i);
 
     return res;
 }
 
+double EventType::value(ProfileCostArray* c)
+{
+    if (_realIndex != ProfileCostArray::InvalidIndex)
+        return (double) c->subCost(_realIndex);
+
+    if (!_parsed) {
+        if (!parseFormula()) return 0.0;
+    }
+
+    // ratio of sums: c holds summed costs of real events
+    double num = _constant, div = _divisorConstant;
+    int rc = _set->realCount();
+    for (int i = 0;i<rc;i++) {
+        if ((_coefficient[i] == 0.0) && (_divisor[i] == 0.0)) continue;
+        double v = (double) c->subCost(i);
+        num += _coefficient[i] * v;
+        div += _divisor[i] * v;
+    }
+
+    if (!_isRatio) return num;
+    return (div == 0.0) ? 0.0 : num / div;
+}
+
+QString EventType::prettySubCost(SubCost s)
+{
+    if (!_isReal && !_parsed) parseFormula();
+    if (!_isRatio) return s.pretty();
+
+    return QString::number((double) s.v / RatioScale, 'g', 4);
+}
+
+void EventType::subCosts(const SubCost* const* columns, int count,
+                         SubCost* result)
+{
+    if (_realIndex != ProfileCostArray::InvalidIndex) {
+        const SubCost* c = columns[_realIndex];
+        for (int j = 0;j<count;j++)
+            result[j] = c[j];
+        return;
+    }
+
+    for (int j = 0;j<count;j++)
+        result[j] = 0;
+    if (!_parsed) {
+        if (!parseFormula()) return;
+    }
+
+    // column by column, skipping events not used in the formula
+    int rc = _set->realCount();
+    if (_isIntegral) {
+        for (int i = 0;i<rc;i++) {
+            if (_coefficient[i] == 0) continue;
+            const SubCost* c = columns[i];
+            uint64 f = (uint64)(qint64) _coefficient[i];
+            for (int j = 0;j<count;j++)
+                result[j].v += f * c[j].v;
+        }
+        return;
+    }
+
+    // same for float formulas, numerator and divisor separately
+    QVector<double> num(count, _constant);
+    QVector<double> div(_isRatio ? count : 0, _divisorConstant);
+    double* n = num.data();
+    double* d = div.data();
+    for (int i = 0;i<rc;i++) {
+        const SubCost* c = columns[i];
+        double f = _coefficient[i];
+        if (f != 0.0)
+            for (int j = 0;j<count;j++)
+                n[j] += f * (double) c[j].v;
+        f = _divisor[i];
+        if (_isRatio && (f != 0.0))
+            for (int j = 0;j<count;j++)
+                d[j] += f * (double) c[j].v;
+    }
+
+    for (int j = 0;j<count;j++) {
+        double v = n[j];
+        if (_isRatio) v = (d[j] == 0.0) ? 0.0 : v / d[j] * RatioScale;
+        if (v > 0.0) result[j] = v;
+    }
+}
+
 int EventType::histCost(ProfileCostArray* c, double total, double* hist)
 {
     if (total == 0.0) return 0;
@@ -219,10 +625,21 @@ int EventType::histCost(ProfileCostArray* c, double total, double* hist)
         if (!parseFormula()) return 0;
     }
 
+    // for ratios, show the contributions to the numerator
+    if (_isRatio) {
+        double div = _divisorConstant;
+        for (int i = 0;i<_set->realCount();i++)
+            if (_divisor[i] != 0.0)
+                div += _divisor[i] * (double) c->subCost(i);
+        if (div == 0.0) return 0;
+        // <total> is a scaled SubCost
+        total *= div / RatioScale;
+    }
+
     int rc = _set->realCount();
     for (int i = 0;i<rc;i++) {
         if (_coefficient[i] != 0)
-            hist[i] = _coefficient[i] * c->subCost(i) / total;
+            hist[i] = _coefficient[i] * (double) c->subCost(i) / total;
         else
             hist[i] = 0.0;
     }
@@ -233,6 +650,7 @@ int EventType::histCost(ProfileCostArray* c, double total, double* hist)
 
 bool EventType::hasKnownRealType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return false;
 
     foreach (EventType* t, *_knownTypes)
@@ -244,6 +662,7 @@ bool EventType::hasKnownRealType(const QString& n)
 
 bool EventType::hasKnownDerivedType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return false;
 
     foreach (EventType* t, *_knownTypes)
@@ -255,6 +674,7 @@ bool EventType::hasKnownDerivedType(const QString& n)
 
 EventType* EventType::cloneKnownRealType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return nullptr;
 
     foreach (EventType* t, *_knownTypes)
@@ -269,6 +689,7 @@ EventType* EventType::cloneKnownRealType(const QString& n)
 
 EventType* EventType::cloneKnownDerivedType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return nullptr;
 
     foreach (EventType* t, *_knownTypes)
@@ -285,6 +706,7 @@ void EventType::add(EventType* t, bool overwriteExisting)
 {
     if (!t) return;
 
+    QMutexLocker locker(&knownTypesMutex);
     t->setEventTypeSet(nullptr);
 
     if (!_knownTypes)
@@ -311,6 +733,7 @@ void EventType::add(EventType* t, bool overwriteExisting)
 
 int EventType::knownTypeCount()
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return 0;
 
     return _knownTypes->count();
@@ -318,6 +741,7 @@ int EventType::knownTypeCount()
 
 bool EventType::remove(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return false;
 
     foreach (EventType* t, *_knownTypes)
@@ -332,6 +756,7 @@ bool EventType::remove(const QString& n)
 
 EventType* EventType::knownType(int i)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return nullptr;
     if (i<0 || i>=(int)_knownTypes->count()) return nullptr;
 
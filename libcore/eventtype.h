@@ -38,11 +38,20 @@ class EventTypeSet;
  * To allow for parsing, you must specify a EventTypeSet
  * with according cost types (e.g. "l1rm" and "l2rm" for above formula).
  *
+ * Formulas may use float constants, parentheses and one division
+ * by a linear combination of events, e.g. "1000 * D1mr / (Dr + Dw)".
+ * Such ratio events are evaluated on the summed costs of an item
+ * (ratio of sums). As SubCost, ratios are fixed point values scaled
+ * by RatioScale, so that lists sort by the fractional value; use
+ * prettySubCost() to show them.
+ *
  * The cost type with empty name is the "const" cost type.
  */
 class EventType
 {
 public:
+    // SubCost of ratio events is value() multiplied by this factor
+    enum { RatioScale = 1000000 };
 
     /**
      * @param name is a short (non-localized) identifier for the cost type,
@@ -68,6 +77,8 @@ public:
     EventTypeSet* set() { return _set; }
     int realIndex() { return _realIndex; }
     bool isReal() { return _isReal; }
+    // derived event with a division by event costs
+    bool isRatio() { return _isRatio; }
 
     /*
      * returns true if all cost type names can be resolved in formula
@@ -77,6 +88,17 @@ public:
     QString parsedRealFormula();
 
     SubCost subCost(ProfileCostArray*);
+    // unrounded value, needed for ratios and float formulas
+    double value(ProfileCostArray*);
+    // a SubCost of this type as string, with fraction for ratios
+    QString prettySubCost(SubCost);
+
+    /*
+     * Batch evaluation for <count> items: <columns> is indexed by
+     * real index, each column holding the cost of all items for that
+     * event. Writes the cost of this type for each item into <result>.
+     */
+    void subCosts(const SubCost* const* columns, int count, SubCost* result);
 
     /*
      * For virtual costs, returns a histogram for use with
@@ -97,12 +119,16 @@ public:
     static EventType* knownType(int);
 
 private:
+    friend class FormulaParser;
 
     QString _name, _longName, _formula, _parsedFormula;
     EventTypeSet* _set;
     bool _parsed, _inParsing, _isReal;
-    // index MaxRealIndex is for constant addition
-    int _coefficient[MaxRealIndexValue];
+    // value = (sum c[i]*cost[i] + constant) / (sum d[i]*cost[i] + divConstant)
+    double _coefficient[MaxRealIndexValue], _constant;
+    double _divisor[MaxRealIndexValue], _divisorConstant;
+    // ratio: divisor depends on costs; integral: exact uint64 evaluation
+    bool _isRatio, _isIntegral;
     int _realIndex;
 
     static QList<EventType*>* _knownTypes;
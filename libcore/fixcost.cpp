@@ -19,6 +19,7 @@
 #include "fixcost.h"
 #include "utils.h"
 #include "addr.h"
+#include "costkernels.h"
 
 // FixCost
 
@@ -50,6 +51,22 @@ FixCost::FixCost(TracePart* part, FixPool* pool,
                                   partFunction->setFirstFixCost(this) : nullptr;
 }
 
+FixCost::FixCost(TracePart* part,
+                 TraceFunctionSource* functionSource,
+                 PositionSpec& pos,
+                 TracePartFunction* partFunction,
+                 int count, SubCost* cost)
+{
+    _part = part;
+    _functionSource = functionSource;
+    _pos = pos;
+    _count = count;
+    _cost = cost;
+
+    _nextCostOfPartFunction = partFunction ?
+                                  partFunction->setFirstFixCost(this) : nullptr;
+}
+
 void* FixCost::operator new(size_t size, FixPool* pool)
 {
     return pool->allocate(size);
@@ -61,6 +78,11 @@ void FixCost::addTo(ProfileCostArray* c)
 
     int i, realIndex;
 
+    if (sm->isIdentity()) {
+        c->addCost(_cost, _count);
+        return;
+    }
+
     c->reserve(sm->maxRealIndex(_count)+1);
     for(i=0; i<_count; i++) {
         realIndex = sm->realIndex(i);
@@ -68,6 +90,24 @@ void FixCost::addTo(ProfileCostArray* c)
     }
 }
 
+void FixCost::addTo(SubCost* c) const
+{
+    EventTypeMapping* sm = _part->eventTypeMapping();
+
+    int i, realIndex;
+
+    if (sm->isIdentity()) {
+        addCostVector(c, _cost, _count);
+        return;
+    }
+
+    for(i=0; i<_count; i++) {
+        realIndex = sm->realIndex(i);
+        if (realIndex == ProfileCostArray::InvalidIndex) continue;
+        c[realIndex] += _cost[i];
+    }
+}
+
 
 
 // FixCallCost
@@ -106,6 +146,22 @@ FixCallCost::FixCallCost(TracePart* part, FixPool* pool,
     _nextCostOfPartCall = partCall ? partCall->setFirstFixCallCost(this) : nullptr;
 }
 
+FixCallCost::FixCallCost(TracePart* part,
+                         TraceFunctionSource* functionSource,
+                         unsigned int line, Addr addr,
+                         TracePartCall* partCall,
+                         int count, SubCost* cost)
+{
+    _part = part;
+    _functionSource = functionSource;
+    _line = line;
+    _addr = addr;
+    _count = count;
+    _cost = cost;
+
+    _nextCostOfPartCall = partCall ? partCall->setFirstFixCallCost(this) : nullptr;
+}
+
 void* FixCallCost::operator new(size_t size, FixPool* pool)
 {
     return pool->allocate(size);
@@ -117,9 +173,13 @@ void FixCallCost::addTo(TraceCallCost* c)
 
     int i, realIndex;
 
-    for(i=0; i<_count; i++) {
-        realIndex = sm->realIndex(i);
-        c->addCost(realIndex, _cost[i]);
+    if (sm->isIdentity())
+        c->addCost(_cost, _count);
+    else {
+        for(i=0; i<_count; i++) {
+            realIndex = sm->realIndex(i);
+            c->addCost(realIndex, _cost[i]);
+        }
     }
     c->addCallCount(_cost[_count]);
 
@@ -59,10 +59,18 @@ public:
             PositionSpec&,
             TracePartFunction*,
             FixString&);
+    // uses <count> counters at <cost> without copying (e.g. mapped file)
+    FixCost(TracePart*,
+            TraceFunctionSource*,
+            PositionSpec&,
+            TracePartFunction*,
+            int count, SubCost* cost);
 
     void *operator new(size_t size, FixPool*);
 
     void addTo(ProfileCostArray*);
+    // add to plain array indexed by real event index (no invalidation)
+    void addTo(SubCost*) const;
 
     TracePart* part() const { return _part; }
     bool isLineRegion() const { return _pos.isLineRegion(); }
@@ -74,6 +82,9 @@ public:
     Addr addr() const { return _pos.fromAddr; }
     Addr toAddr() const { return _pos.toAddr; }
     TraceFunctionSource* functionSource() const { return _functionSource; }
+    // raw counters, indexed by event type mapping of part
+    int costCount() const { return _count; }
+    const SubCost* costs() const { return _cost; }
 
     FixCost* nextCostOfPartFunction() const
     { return _nextCostOfPartFunction; }
@@ -103,6 +114,13 @@ public:
                 Addr addr,
                 TracePartCall*,
                 SubCost, FixString&);
+    // uses <count>+1 counters at <cost> (last is call count) without copying
+    FixCallCost(TracePart*,
+                TraceFunctionSource*,
+                unsigned int line,
+                Addr addr,
+                TracePartCall*,
+                int count, SubCost* cost);
 
     void *operator new(size_t size, FixPool*);
 
@@ -114,6 +132,9 @@ public:
     Addr addr() const { return _addr; }
     SubCost callCount() const { return _cost[_count]; }
     TraceFunctionSource* functionSource() const	{ return _functionSource; }
+    // raw counters, indexed by event type mapping of part
+    int costCount() const { return _count; }
+    const SubCost* costs() const { return _cost; }
     FixCallCost* nextCostOfPartCall() const
     { return _nextCostOfPartCall; }
 
@@ -0,0 +1,364 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Statistics of function costs over many profiles
+ */
+
+#include "fleetstats.h"
+
+#include <QAtomicInt>
+#include <QMap>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "tracedata.h"
+#include "partcostmatrix.h"
+#include "globalconfig.h"
+#include "logger.h"
+#include "parallel.h"
+
+
+//---------------------------------------------------
+// Parallel jobs for FleetStatistics
+
+/* Total self cost of each part */
+class PartTotalJob: public ParallelReduceJob<QVector<uint64> >
+{
+public:
+    PartTotalJob(PartCostMatrix* m, EventType* t, int partCount)
+        : ParallelReduceJob<QVector<uint64> >(QVector<uint64>(partCount, 0)),
+          _m(m), _t(t)
+    {}
+
+    void reduce(int from, int to, QVector<uint64>& acc) override
+    {
+        QVector<int> parts;
+        QVector<SubCost> costs;
+        uint64* pt = acc.data();
+
+        for(int row=from; row<to; row++) {
+            int n = _m->selfCosts(row, _t, parts, costs);
+            for(int e=0; e<n; e++)
+                pt[parts.at(e)] += costs.at(e).v;
+        }
+    }
+
+    void combine(QVector<uint64>& acc, const QVector<uint64>& partial) override
+    {
+        for(int p=0; p<acc.count(); p++)
+            acc[p] += partial.at(p);
+    }
+
+private:
+    PartCostMatrix* _m;
+    EventType* _t;
+};
+
+/* Adds normalized costs of each part to the sketches of a function.
+ * Matrix rows are grouped by fleet function, as different functions
+ * may map to the same one: each group is handled by one worker. */
+class FleetPartJob: public ParallelJob
+{
+public:
+    FleetPartJob(PartCostMatrix* m, EventType* t, const uint64* partTotal,
+                 const int* groupStart, const int* groupRow,
+                 const int* groupEntry, FleetFunction* functions)
+        : _m(m), _t(t), _partTotal(partTotal),
+          _groupStart(groupStart), _groupRow(groupRow),
+          _groupEntry(groupEntry), _functions(functions)
+    {}
+
+    void run(int from, int to, int) override
+    {
+        QVector<int> parts;
+        QVector<SubCost> costs;
+
+        for(int g=from; g<to; g++) {
+            // part => (exclusive, inclusive)
+            QMap<int, QPair<uint64, uint64> > sum;
+            for(int i=_groupStart[g]; i<_groupStart[g+1]; i++) {
+                int n = _m->selfCosts(_groupRow[i], _t, parts, costs);
+                for(int e=0; e<n; e++)
+                    sum[parts.at(e)].first += costs.at(e).v;
+                n = _m->inclusiveCosts(_groupRow[i], _t, parts, costs);
+                for(int e=0; e<n; e++)
+                    sum[parts.at(e)].second += costs.at(e).v;
+            }
+
+            FleetFunction& f = _functions[_groupEntry[g]];
+            QMap<int, QPair<uint64, uint64> >::const_iterator it;
+            for(it = sum.constBegin(); it != sum.constEnd(); ++it) {
+                double total = (double) _partTotal[it.key()];
+                if (total <= 0.0) continue;
+                f.exclusive.add(it.value().first / total);
+                f.inclusive.add(it.value().second / total);
+            }
+        }
+    }
+
+private:
+    PartCostMatrix* _m;
+    EventType* _t;
+    const uint64* _partTotal;
+    const int *_groupStart, *_groupRow, *_groupEntry;
+    FleetFunction* _functions;
+};
+
+/* Only report errors: loading many files otherwise floods the output */
+class FleetLogger: public Logger
+{
+public:
+    void loadStart(const QString& filename) override
+    { _filename = filename; }
+    void loadProgress(int) override {}
+    void loadWarning(int, const QString&) override {}
+    void loadFinished(const QString& msg) override
+    {
+        if (!msg.isEmpty())
+            Logger::loadFinished(msg);
+    }
+};
+
+/* Loads one profile, adds it as host and throws it away */
+class FleetLoadTask: public QRunnable
+{
+public:
+    FleetLoadTask(FleetStatistics* fleet, const QString& file,
+                  const QString& eventType, QAtomicInt* loaded)
+    {
+        _fleet = fleet;
+        _file = file;
+        _eventType = eventType;
+        _loaded = loaded;
+    }
+
+    void run() override
+    {
+        FleetLogger logger;
+        TraceData data(&logger);
+        if (data.load(_file) == 0) return;
+
+        EventType* t;
+        if (_eventType.isEmpty())
+            t = data.eventTypes()->type(0);
+        else
+            t = data.eventTypes()->type(_eventType);
+        if (!t) return;
+
+        _fleet->addProfile(&data, t);
+        _loaded->fetchAndAddOrdered(1);
+    }
+
+private:
+    FleetStatistics* _fleet;
+    QString _file, _eventType;
+    QAtomicInt* _loaded;
+};
+
+
+//---------------------------------------------------
+// FleetStatistics
+
+FleetStatistics::FleetStatistics()
+{
+    _hostCount = 0;
+}
+
+QString FleetStatistics::key(TraceFunction* f)
+{
+    return f->name() + '\t' +
+            (f->object() ? f->object()->shortName() : QString());
+}
+
+int FleetStatistics::entry(const QString& key, TraceFunction* f)
+{
+    int i = _index.value(key, -1);
+    if (i >= 0) return i;
+
+    i = _functions.count();
+    _functions.append(FleetFunction());
+    _functions[i].name = f->name();
+    if (f->object())
+        _functions[i].object = f->object()->shortName();
+    _index.insert(key, i);
+    return i;
+}
+
+int FleetStatistics::find(TraceFunction* f) const
+{
+    if (!f) return -1;
+
+    int i = _functionIndex.value(f, -1);
+    if (i >= 0) return i;
+    return _index.value(key(f), -1);
+}
+
+void FleetStatistics::addProfile(TraceData* data, EventType* t)
+{
+    if (!data || !t) return;
+
+    double total = data->subCost(t);
+    if (total <= 0.0) return;
+
+    // aggregate costs of functions with same key before locking
+    QHash<QString, int> local;
+    QVector<TraceFunction*> functions;
+    QVector<double> exclusive, inclusive;
+    TraceFunctionMap::Iterator it;
+    for ( it = data->functionMap().begin();
+          it != data->functionMap().end(); ++it ) {
+        TraceFunction* f = &(*it);
+        SubCost incl = f->inclusive()->subCost(t);
+        if (incl == 0) continue;
+
+        QString k = key(f);
+        int i = local.value(k, -1);
+        if (i < 0) {
+            i = functions.count();
+            local.insert(k, i);
+            functions.append(f);
+            exclusive.append(0.0);
+            inclusive.append(0.0);
+        }
+        exclusive[i] += f->subCost(t) / total;
+        inclusive[i] += incl / total;
+    }
+
+    QMutexLocker locker(&_mutex);
+    QHash<QString, int>::const_iterator lit;
+    for(lit = local.constBegin(); lit != local.constEnd(); ++lit) {
+        int i = lit.value();
+        FleetFunction& f = _functions[entry(lit.key(), functions.at(i))];
+        f.exclusive.add(exclusive.at(i));
+        f.inclusive.add(inclusive.at(i));
+    }
+    _hostCount++;
+}
+
+void FleetStatistics::addParts(TraceData* data, EventType* t)
+{
+    if (!data || !t) return;
+
+    // no lazy formula parsing in parallel jobs
+    t->parseFormula();
+    // only needed while adding the parts
+    PartCostMatrix matrix(data);
+    PartCostMatrix* m = &matrix;
+    m->update();
+    int partCount = data->parts().count();
+    int rows = m->functionCount();
+    if ((partCount == 0) || (rows == 0)) return;
+
+    PartTotalJob totalJob(m, t, partCount);
+    Parallel::run(&totalJob, rows);
+    QVector<uint64> partTotal = totalJob.result();
+
+    // group rows by fleet function
+    QVector<int> rowEntry(rows);
+    QMap<int, int> groupOf;
+    QVector<int> groupSize;
+    for(int row=0; row<rows; row++) {
+        TraceFunction* f = m->function(row);
+        int e = entry(key(f), f);
+        _functionIndex.insert(f, e);
+        rowEntry[row] = e;
+        if (!groupOf.contains(e)) {
+            groupOf.insert(e, groupSize.count());
+            groupSize.append(0);
+        }
+        groupSize[groupOf.value(e)]++;
+    }
+    int groups = groupSize.count();
+    QVector<int> groupStart(groups + 1), groupRow(rows), groupEntry(groups);
+    groupStart[0] = 0;
+    for(int g=0; g<groups; g++)
+        groupStart[g+1] = groupStart.at(g) + groupSize.at(g);
+    QVector<int> fill = groupStart;
+    for(int row=0; row<rows; row++) {
+        int g = groupOf.value(rowEntry.at(row));
+        groupEntry[g] = rowEntry.at(row);
+        groupRow[fill[g]++] = row;
+    }
+
+    FleetPartJob job(m, t, partTotal.constData(),
+                     groupStart.constData(), groupRow.constData(),
+                     groupEntry.constData(), _functions.data());
+    Parallel::run(&job, groups);
+
+    foreach(uint64 total, partTotal)
+        if (total > 0) _hostCount++;
+}
+
+int FleetStatistics::load(const QStringList& files, const QString& eventType,
+                          int maxConcurrent)
+{
+    // create lazily initialized globals before loading in parallel
+    GlobalConfig::config();
+    ProfileContext::context(ProfileContext::Function);
+    ProfileContext::typeName(ProfileContext::Function);
+    ProfileContext::i18nTypeName(ProfileContext::Function);
+
+    // own pool to bound the number of profiles in memory
+    QThreadPool pool;
+    if (maxConcurrent <= 0) maxConcurrent = Parallel::workerCount();
+    pool.setMaxThreadCount(maxConcurrent);
+
+    QAtomicInt loaded(0);
+    foreach(const QString& file, files) {
+        FleetLoadTask* task = new FleetLoadTask(this, file, eventType, &loaded);
+        task->setAutoDelete(true);
+        pool.start(task);
+    }
+    pool.waitForDone();
+
+    return loaded.load();
+}
+
+double FleetStatistics::quantile(const QuantileSketch& s, double q) const
+{
+    // hosts not in the sketch had cost 0, i.e. lowest values
+    double zeros = _hostCount - s.count();
+    if (zeros <= 0.0) return s.quantile(q);
+
+    double rank = q * _hostCount;
+    if (rank <= zeros) return 0.0;
+    return s.quantile((rank - zeros) / s.count());
+}
+
+double FleetStatistics::exclusive(int i, double q) const
+{
+    if ((i < 0) || (i >= _functions.count())) return 0.0;
+    return quantile(_functions.at(i).exclusive, q);
+}
+
+double FleetStatistics::inclusive(int i, double q) const
+{
+    if ((i < 0) || (i >= _functions.count())) return 0.0;
+    return quantile(_functions.at(i).inclusive, q);
+}
+
+int FleetStatistics::centroidCount() const
+{
+    int count = 0;
+    foreach(const FleetFunction& f, _functions)
+        count += f.exclusive.size() + f.inclusive.size();
+    return count;
+}
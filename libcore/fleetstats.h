@@ -0,0 +1,110 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Statistics of function costs over many profiles
+ */
+
+#ifndef FLEETSTATS_H
+#define FLEETSTATS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "quantilesketch.h"
+
+class TraceData;
+class TraceFunction;
+class EventType;
+
+/**
+ * Cost distribution of one function over all hosts.
+ * Costs are normalized to the total cost of a host.
+ */
+class FleetFunction
+{
+public:
+    QString name, object;
+    QuantileSketch exclusive, inclusive;
+};
+
+/**
+ * Aggregates function costs of many profiles ("hosts"), e.g. from
+ * the same program running on a fleet of machines, into percentiles.
+ *
+ * For every function, one QuantileSketch each for exclusive and
+ * inclusive cost as fraction of the host total is kept. Functions
+ * are identified by name and object, as for ProfileWarehouse.
+ * Memory thus is proportional to the number of different functions
+ * times sketch size, independent of the number of hosts. Hosts
+ * without cost for a function count as cost 0 in percentiles.
+ *
+ * Hosts can be complete profiles, loaded in parallel by load(),
+ * or the parts of one loaded profile (addParts()).
+ */
+class FleetStatistics
+{
+public:
+    FleetStatistics();
+
+    /* Costs of <data> for event type <t> as one host.
+     * Can be called from multiple threads at the same time,
+     * each with its own data. */
+    void addProfile(TraceData* data, EventType* t);
+    /* Each part of <data> as one host, with costs from
+     * a temporary PartCostMatrix. */
+    void addParts(TraceData* data, EventType* t);
+    /* Load each file as one host, using event type <eventType>
+     * (the first one of each file if empty). At most <maxConcurrent>
+     * profiles are in memory at the same time, defaults to number of
+     * workers. Returns number of profiles loaded. */
+    int load(const QStringList& files, const QString& eventType,
+             int maxConcurrent = 0);
+
+    int hostCount() const { return _hostCount; }
+    int functionCount() const { return _functions.count(); }
+    const FleetFunction& function(int i) const { return _functions.at(i); }
+    // index of function with same name and object, -1 if not found
+    int find(TraceFunction*) const;
+
+    // quantile <q> of normalized cost over all hosts
+    double exclusive(int i, double q) const;
+    double inclusive(int i, double q) const;
+
+    // number of centroids in all sketches
+    int centroidCount() const;
+
+    static QString key(TraceFunction*);
+
+private:
+    // index of function, appended if new
+    int entry(const QString& key, TraceFunction*);
+    double quantile(const QuantileSketch&, double q) const;
+
+    QVector<FleetFunction> _functions;
+    QHash<QString, int> _index;
+    // shortcut for functions given to addParts()
+    QHash<TraceFunction*, int> _functionIndex;
+    int _hostCount;
+    QMutex _mutex;
+};
+
+#endif
@@ -26,6 +26,7 @@
 
 #include "config.h"
 #include "tracedata.h"
+#include "parallel.h"
 
 
 // GlobalConfig defaults
@@ -34,12 +35,14 @@
 #define DEFAULT_SHOWCYCLES       true
 #define DEFAULT_HIDETEMPLATES    false
 #define DEFAULT_CYCLECUT         0.0
+#define DEFAULT_PRUNETHRESHOLD   0.0
 #define DEFAULT_PERCENTPRECISION 2
 #define DEFAULT_MAXSYMBOLLENGTH  30
 #define DEFAULT_MAXSYMBOLCOUNT   10
 #define DEFAULT_MAXLISTCOUNT     100
 #define DEFAULT_CONTEXT          3
 #define DEFAULT_NOCOSTINSIDE     20
+#define DEFAULT_THREADCOUNT      0
 
 
 //
@@ -66,6 +69,9 @@ QStringList GlobalConfig::knownTypes()
 
     l << QStringLiteral("Smp")  << QStringLiteral("Sys")  << QStringLiteral("User") << QStringLiteral("CEst");
 
+    // ratios: misses per 1000 instructions
+    l << QStringLiteral("L1mPKI") << QStringLiteral("LLmPKI");
+
     return l;
 }
 
@@ -78,6 +84,8 @@ QString GlobalConfig::knownFormula(const QString& name)
     if (name == QLatin1String("Bm"))  return QStringLiteral("Bim + Bcm");
     if (name == QLatin1String("CEst"))
         return QStringLiteral("Ir + 10 Bm + 10 L1m + 20 Ge + 100 L2m + 100 LLm");
+    if (name == QLatin1String("L1mPKI")) return QStringLiteral("1000 * L1m / Ir");
+    if (name == QLatin1String("LLmPKI")) return QStringLiteral("1000 * LLm / Ir");
 
     return QString();
 }
@@ -109,6 +117,8 @@ QString GlobalConfig::knownLongName(const QString& name)
     if (name == QLatin1String("Sys")) return QObject::tr("System Time");
     if (name == QLatin1String("User")) return QObject::tr("User Time");
     if (name == QLatin1String("CEst")) return QObject::tr("Cycle Estimation");
+    if (name == QLatin1String("L1mPKI")) return QObject::tr("L1 Misses per 1000 Instr.");
+    if (name == QLatin1String("LLmPKI")) return QObject::tr("LL Misses per 1000 Instr.");
 
     return QString();
 }
@@ -125,6 +135,7 @@ GlobalConfig::GlobalConfig()
     _showExpanded     = DEFAULT_SHOWEXPANDED;
     _showCycles       = DEFAULT_SHOWCYCLES;
     _cycleCut         = DEFAULT_CYCLECUT;
+    _pruneThreshold   = DEFAULT_PRUNETHRESHOLD;
     _percentPrecision = DEFAULT_PERCENTPRECISION;
     _hideTemplates    = DEFAULT_HIDETEMPLATES;
 
@@ -136,6 +147,9 @@ GlobalConfig::GlobalConfig()
     // annotation behaviour
     _context          = DEFAULT_CONTEXT;
     _noCostInside     = DEFAULT_NOCOSTINSIDE;
+
+    // 0: number of CPU cores
+    _threadCount      = DEFAULT_THREADCOUNT;
 }
 
 GlobalConfig::~GlobalConfig()
@@ -179,6 +193,8 @@ void GlobalConfig::saveOptions()
                             DEFAULT_SHOWCYCLES);
     generalConfig->setValue(QStringLiteral("CycleCut"), _cycleCut,
                             DEFAULT_CYCLECUT);
+    generalConfig->setValue(QStringLiteral("PruneThreshold"), _pruneThreshold,
+                            DEFAULT_PRUNETHRESHOLD);
     generalConfig->setValue(QStringLiteral("PercentPrecision"), _percentPrecision,
                             DEFAULT_PERCENTPRECISION);
     generalConfig->setValue(QStringLiteral("MaxSymbolLength"), _maxSymbolLength,
@@ -193,6 +209,8 @@ void GlobalConfig::saveOptions()
                             DEFAULT_NOCOSTINSIDE);
     generalConfig->setValue(QStringLiteral("HideTemplates"), _hideTemplates,
                             DEFAULT_HIDETEMPLATES);
+    generalConfig->setValue(QStringLiteral("ThreadCount"), _threadCount,
+                            DEFAULT_THREADCOUNT);
     delete generalConfig;
 
     // store known event types
@@ -250,6 +268,8 @@ void GlobalConfig::readOptions()
                                              DEFAULT_SHOWCYCLES).toBool();
     _cycleCut         = generalConfig->value(QStringLiteral("CycleCut"),
                                              DEFAULT_CYCLECUT).toDouble();
+    _pruneThreshold   = generalConfig->value(QStringLiteral("PruneThreshold"),
+                                             DEFAULT_PRUNETHRESHOLD).toDouble();
     _percentPrecision = generalConfig->value(QStringLiteral("PercentPrecision"),
                                              DEFAULT_PERCENTPRECISION).toInt();
     _maxSymbolLength  = generalConfig->value(QStringLiteral("MaxSymbolLength"),
@@ -264,6 +284,9 @@ void GlobalConfig::readOptions()
                                              DEFAULT_NOCOSTINSIDE).toInt();
     _hideTemplates    = generalConfig->value(QStringLiteral("HideTemplates"),
                                              DEFAULT_HIDETEMPLATES).toBool();
+    _threadCount      = generalConfig->value(QStringLiteral("ThreadCount"),
+                                             DEFAULT_THREADCOUNT).toInt();
+    Parallel::setWorkerCount(_threadCount);
     delete generalConfig;
 
     // event types
@@ -388,6 +411,27 @@ double GlobalConfig::cycleCut()
     return config()->_cycleCut;
 }
 
+double GlobalConfig::pruneThreshold()
+{
+    return config()->_pruneThreshold;
+}
+
+void GlobalConfig::setPruneThreshold(double t)
+{
+    config()->_pruneThreshold = t;
+}
+
+int GlobalConfig::threadCount()
+{
+    return config()->_threadCount;
+}
+
+void GlobalConfig::setThreadCount(int c)
+{
+    config()->_threadCount = c;
+    Parallel::setWorkerCount(c);
+}
+
 int GlobalConfig::percentPrecision()
 {
     return config()->_percentPrecision;
@@ -89,6 +89,12 @@ public:
     static void setHideTemplates(bool);
     // upper limit for cutting of a call in cycle detection
     static double cycleCut();
+    // functions below this inclusive cost percentage get pruned on load
+    static double pruneThreshold();
+    static void setPruneThreshold(double);
+    // worker threads for parallel passes, 0 for number of CPU cores
+    static int threadCount();
+    static void setThreadCount(int);
 
     void addDefaultTypes();
 
@@ -101,10 +107,11 @@ protected:
     QHash<QString, QStringList> _objectSourceDirs;
 
     bool _showPercentage, _showExpanded, _showCycles, _hideTemplates;
-    double _cycleCut;
+    double _cycleCut, _pruneThreshold;
     int _percentPrecision;
     int _maxSymbolLength, _maxSymbolCount, _maxListCount;
     int _context, _noCostInside;
+    int _threadCount;
 
     static GlobalConfig* _config;
 };
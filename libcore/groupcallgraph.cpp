@@ -0,0 +1,333 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Call graph aggregated to object, file or class level
+ */
+
+#include "groupcallgraph.h"
+
+#include <QVector>
+
+#include <algorithm>
+
+#include "tracedata.h"
+#include "fixcost.h"
+#include "parallel.h"
+
+typedef QPair<TraceCostItem*, TraceCostItem*> GroupCallKey;
+// real event type counters, followed by call count and number of calls
+typedef QHash<GroupCallKey, QVector<SubCost> > GroupCallCostMap;
+
+
+//---------------------------------------------------
+// GroupCallEdge
+
+GroupCallEdge::GroupCallEdge(TraceCostItem* caller, TraceCostItem* called)
+{
+    _caller = caller;
+    _called = called;
+    _callCount = 0;
+    _calls = 0;
+    _inCycle = false;
+}
+
+
+// order by group names, independent from hash order and pointer values
+class GroupCallEdgeLess
+{
+public:
+    bool operator()(const GroupCallEdge* e1, const GroupCallEdge* e2) const
+    {
+        if (e1->caller() != e2->caller())
+            return e1->caller()->name() < e2->caller()->name();
+        return e1->called()->name() < e2->called()->name();
+    }
+};
+
+class GroupNameLess
+{
+public:
+    bool operator()(const TraceCostItem* g1, const TraceCostItem* g2) const
+    { return g1->name() < g2->name(); }
+};
+
+
+//---------------------------------------------------
+// GroupCallJob
+
+class GroupCallJob: public ParallelJob
+{
+public:
+    GroupCallJob(const GroupCallGraph* graph,
+                 const QVector<TraceFunction*>& functions, int realCount)
+        : _graph(graph), _functions(functions), _realCount(realCount)
+    {
+        for(int w=0; w<workers(); w++)
+            maps.append(new GroupCallCostMap);
+    }
+
+    ~GroupCallJob() override { qDeleteAll(maps); }
+
+    void run(int from, int to, int worker) override
+    {
+        GroupCallCostMap* map = maps.at(worker);
+
+        for(int i=from; i<to; i++) {
+            TraceFunction* f = _functions.at(i);
+            TraceCostItem* caller = _graph->group(f);
+
+            foreach(TraceInclusiveCost* ic, f->deps()) {
+                TracePartFunction* pf = (TracePartFunction*) ic;
+                if (!pf->part()->isActive()) continue;
+                EventTypeMapping* m = pf->part()->eventTypeMapping();
+
+                foreach(TracePartCall* pc, pf->partCallings()) {
+                    TraceCostItem* called = _graph->group(pc->call()->called());
+                    // calls inside of a group are not part of the graph
+                    if (called == caller) continue;
+
+                    FixCallCost* fcc = pc->firstFixCallCost();
+                    if (!fcc) continue;
+
+                    QVector<SubCost>& v = (*map)[GroupCallKey(caller, called)];
+                    if (v.isEmpty()) v.fill(SubCost(0), _realCount + 2);
+                    SubCost* c = v.data();
+                    for(; fcc; fcc = fcc->nextCostOfPartCall()) {
+                        const SubCost* cc = fcc->costs();
+                        for(int k=0; k<fcc->costCount(); k++)
+                            c[m->realIndex(k)] += cc[k];
+                        c[_realCount] += fcc->callCount();
+                    }
+                    c[_realCount + 1] += 1;
+                }
+            }
+        }
+    }
+
+private:
+    const GroupCallGraph* _graph;
+    const QVector<TraceFunction*>& _functions;
+    int _realCount;
+
+public:
+    // one map per worker, merged after the job
+    QVector<GroupCallCostMap*> maps;
+};
+
+
+//---------------------------------------------------
+// GroupCallGraph
+
+GroupCallGraph::GroupCallGraph(TraceData* data, ProfileContext::Type groupType)
+{
+    _data = data;
+    _groupType = groupType;
+    _valid = false;
+    _cycleCount = 0;
+}
+
+GroupCallGraph::~GroupCallGraph()
+{
+    clear();
+}
+
+void GroupCallGraph::clear()
+{
+    qDeleteAll(_edges);
+    _edges.clear();
+    _edgeMap.clear();
+    _callees.clear();
+    _cycle.clear();
+    _cycleCount = 0;
+}
+
+TraceCostItem* GroupCallGraph::group(TraceFunction* f) const
+{
+    switch(_groupType) {
+    case ProfileContext::Object: return f->object();
+    case ProfileContext::File:   return f->file();
+    case ProfileContext::Class:  return f->cls();
+    default: break;
+    }
+    return nullptr;
+}
+
+void GroupCallGraph::update()
+{
+    if (_valid) return;
+
+    clear();
+    collect();
+    detectCycles();
+    // edges do not change until invalidated: switch off caching
+    // on read, so they can be read concurrently on frozen data
+    foreach(GroupCallEdge* e, _edges)
+        e->_cost.freeze();
+    _valid = true;
+}
+
+void GroupCallGraph::collect()
+{
+    int realCount = _data->eventTypes()->realCount();
+
+    QVector<TraceFunction*> functions;
+    TraceFunctionMap::Iterator it;
+    for (it = _data->functionMap().begin();
+         it != _data->functionMap().end(); ++it)
+        functions.append(&(*it));
+
+    GroupCallJob job(this, functions, realCount);
+    Parallel::run(&job, functions.count());
+
+    foreach(GroupCallCostMap* map, job.maps) {
+        GroupCallCostMap::const_iterator mit;
+        for(mit = map->constBegin(); mit != map->constEnd(); ++mit) {
+            GroupCallEdge* e = _edgeMap.value(mit.key());
+            if (!e) {
+                e = new GroupCallEdge(mit.key().first, mit.key().second);
+                _edgeMap.insert(mit.key(), e);
+                _edges.append(e);
+            }
+            const QVector<SubCost>& v = mit.value();
+            for(int k=0; k<realCount; k++)
+                e->_cost.addCost(k, v.at(k));
+            e->_callCount += v.at(realCount);
+            e->_calls += (int) (uint64) v.at(realCount + 1);
+        }
+    }
+
+    // cycle detection visits groups in edge order: make it deterministic
+    std::sort(_edges.begin(), _edges.end(), GroupCallEdgeLess());
+    foreach(GroupCallEdge* e, _edges)
+        _callees[e->_caller].append(e);
+
+    if (0) qDebug("GroupCallGraph: %d edges for %s", _edges.count(),
+                  qPrintable(ProfileContext::typeName(_groupType)));
+}
+
+// strongly connected components (Tarjan)
+void GroupCallGraph::cycleDFS(TraceCostItem* g,
+                              QHash<TraceCostItem*, int>& index,
+                              QHash<TraceCostItem*, int>& low,
+                              QList<TraceCostItem*>& stack,
+                              QSet<TraceCostItem*>& onStack, int& count)
+{
+    index.insert(g, count);
+    low.insert(g, count);
+    count++;
+    stack.append(g);
+    onStack.insert(g);
+
+    foreach(GroupCallEdge* e, _callees.value(g)) {
+        TraceCostItem* to = e->_called;
+        if (!index.contains(to)) {
+            cycleDFS(to, index, low, stack, onStack, count);
+            low[g] = qMin(low.value(g), low.value(to));
+        }
+        else if (onStack.contains(to))
+            low[g] = qMin(low.value(g), index.value(to));
+    }
+
+    if (low.value(g) != index.value(g)) return;
+
+    // g is root of a component: a cycle if it has more than one member
+    if (stack.last() == g) {
+        stack.removeLast();
+        onStack.remove(g);
+        return;
+    }
+    _cycleCount++;
+    TraceCostItem* member;
+    do {
+        member = stack.takeLast();
+        onStack.remove(member);
+        _cycle.insert(member, _cycleCount);
+    } while(member != g);
+}
+
+void GroupCallGraph::detectCycles()
+{
+    QHash<TraceCostItem*, int> index, low;
+    QList<TraceCostItem*> stack;
+    QSet<TraceCostItem*> onStack;
+    int count = 0;
+
+    foreach(GroupCallEdge* e, _edges)
+        if (!index.contains(e->_caller))
+            cycleDFS(e->_caller, index, low, stack, onStack, count);
+
+    foreach(GroupCallEdge* e, _edges) {
+        int c = _cycle.value(e->_caller);
+        e->_inCycle = (c > 0) && (c == _cycle.value(e->_called));
+    }
+}
+
+const GroupCallEdgeList& GroupCallGraph::edges()
+{
+    update();
+    return _edges;
+}
+
+GroupCallEdgeList GroupCallGraph::callers(TraceCostItem* group)
+{
+    update();
+
+    GroupCallEdgeList l;
+    foreach(GroupCallEdge* e, _edges)
+        if (e->_called == group)
+            l.append(e);
+    return l;
+}
+
+GroupCallEdgeList GroupCallGraph::callees(TraceCostItem* group)
+{
+    update();
+    return _callees.value(group);
+}
+
+GroupCallEdge* GroupCallGraph::edge(TraceCostItem* caller, TraceCostItem* called)
+{
+    update();
+    return _edgeMap.value(GroupCallKey(caller, called));
+}
+
+int GroupCallGraph::cycle(TraceCostItem* group)
+{
+    update();
+    return _cycle.value(group);
+}
+
+int GroupCallGraph::cycleCount()
+{
+    update();
+    return _cycleCount;
+}
+
+QList<TraceCostItem*> GroupCallGraph::cycleMembers(int cycle)
+{
+    update();
+
+    QList<TraceCostItem*> l;
+    QHash<TraceCostItem*, int>::const_iterator it;
+    for(it = _cycle.constBegin(); it != _cycle.constEnd(); ++it)
+        if (it.value() == cycle)
+            l.append(it.key());
+    std::sort(l.begin(), l.end(), GroupNameLess());
+    return l;
+}
@@ -0,0 +1,129 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Call graph aggregated to object, file or class level
+ */
+
+#ifndef GROUPCALLGRAPH_H
+#define GROUPCALLGRAPH_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+
+#include "costitem.h"
+#include "context.h"
+#include "subcost.h"
+
+class TraceData;
+class TraceCostItem;
+class TraceFunction;
+class EventType;
+
+/**
+ * An edge of the group call graph: the sum of all calls from
+ * functions of group <caller> to functions of group <called>.
+ */
+class GroupCallEdge
+{
+public:
+    GroupCallEdge(TraceCostItem* caller, TraceCostItem* called);
+
+    TraceCostItem* caller() const { return _caller; }
+    TraceCostItem* called() const { return _called; }
+    // summed inclusive cost of the calls, indexed by real event type
+    ProfileCostArray* cost() { return &_cost; }
+    SubCost subCost(EventType* t) { return _cost.subCost(t); }
+    SubCost callCount() const { return _callCount; }
+    // number of function level calls collapsed into this edge
+    int calls() const { return _calls; }
+    // edge between groups of the same cycle?
+    bool inCycle() const { return _inCycle; }
+
+private:
+    friend class GroupCallGraph;
+
+    TraceCostItem *_caller, *_called;
+    ProfileCostArray _cost;
+    SubCost _callCount;
+    int _calls;
+    bool _inCycle;
+};
+
+typedef QList<GroupCallEdge*> GroupCallEdgeList;
+
+/**
+ * Call graph with ELF objects, source files or classes as nodes,
+ * collapsing the calls between functions of different groups.
+ *
+ * Only active parts are taken into account. The graph is calculated
+ * on demand by update() and stays valid until invalidate() is called,
+ * which TraceData does whenever the set of active parts changes.
+ * Aggregation is done in parallel directly from the FixCallCost lists.
+ * Strongly connected components of the graph are the group cycles.
+ * Edges are sorted by caller and called group name, so edge order and
+ * cycle numbers do not depend on hash order.
+ */
+class GroupCallGraph
+{
+public:
+    GroupCallGraph(TraceData*, ProfileContext::Type groupType);
+    ~GroupCallGraph();
+
+    ProfileContext::Type groupType() const { return _groupType; }
+    // group of a function according to group type
+    TraceCostItem* group(TraceFunction*) const;
+
+    void invalidate() { _valid = false; }
+    bool isValid() const { return _valid; }
+    void update();
+
+    // all accessors below call update() if needed
+    const GroupCallEdgeList& edges();
+    GroupCallEdgeList callers(TraceCostItem* group);
+    GroupCallEdgeList callees(TraceCostItem* group);
+    GroupCallEdge* edge(TraceCostItem* caller, TraceCostItem* called);
+
+    // cycle number of a group (starting at 1), 0 if not in a cycle
+    int cycle(TraceCostItem* group);
+    int cycleCount();
+    QList<TraceCostItem*> cycleMembers(int cycle);
+
+private:
+    void clear();
+    void collect();
+    void detectCycles();
+    void cycleDFS(TraceCostItem* g, QHash<TraceCostItem*, int>& index,
+                  QHash<TraceCostItem*, int>& low,
+                  QList<TraceCostItem*>& stack, QSet<TraceCostItem*>& onStack,
+                  int& count);
+
+    TraceData* _data;
+    ProfileContext::Type _groupType;
+    bool _valid;
+
+    GroupCallEdgeList _edges;
+    QHash<QPair<TraceCostItem*, TraceCostItem*>, GroupCallEdge*> _edgeMap;
+    QHash<TraceCostItem*, GroupCallEdgeList> _callees;
+    QHash<TraceCostItem*, int> _cycle;
+    int _cycleCount;
+};
+
+#endif
@@ -0,0 +1,236 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Self cost aggregates of objects, files and classes
+ */
+
+#include "groupcosts.h"
+
+#include "tracedata.h"
+#include "fixcost.h"
+#include "parallel.h"
+
+
+//---------------------------------------------------
+// GroupCostColumns
+
+GroupCostColumns::GroupCostColumns()
+{
+    _realCount = 0;
+}
+
+const SubCost* GroupCostColumns::column(int realIndex) const
+{
+    return _cost.constData() + realIndex * _groups.count();
+}
+
+QVector<SubCost> GroupCostColumns::costs(EventType* t) const
+{
+    QVector<SubCost> res(_groups.count());
+    if (!t || _groups.isEmpty()) return res;
+
+    QVector<const SubCost*> columns(_realCount);
+    for(int i=0; i<_realCount; i++)
+        columns[i] = column(i);
+    t->subCosts(columns.constData(), _groups.count(), res.data());
+
+    return res;
+}
+
+
+//---------------------------------------------------
+// GroupCostJob
+
+class GroupCostJob: public ParallelJob
+{
+public:
+    // <groups> has object, file and class index for each function
+    GroupCostJob(const QVector<TraceFunction*>& functions,
+                 const QVector<int>& groups, const int* groupCount,
+                 int realCount, const QVector<SubCost*>& costs)
+        : _functions(functions), _groups(groups), _groupCount(groupCount),
+          _realCount(realCount), _costs(costs)
+    {}
+
+    void run(int from, int to, int worker) override
+    {
+        SubCost* const* c = _costs.constData() + 3 * worker;
+        QVector<SubCost> self(_realCount);
+
+        for(int i=from; i<to; i++) {
+            TraceFunction* f = _functions.at(i);
+            self.fill(SubCost(0));
+            bool hasCost = false;
+
+            foreach(TraceInclusiveCost* ic, f->deps()) {
+                TracePartFunction* pf = (TracePartFunction*) ic;
+                if (!pf->part()->isActive()) continue;
+                EventTypeMapping* m = pf->part()->eventTypeMapping();
+
+                for(FixCost* fc = pf->firstFixCost(); fc;
+                    fc = fc->nextCostOfPartFunction()) {
+                    const SubCost* cc = fc->costs();
+                    for(int k=0; k<fc->costCount(); k++)
+                        self[m->realIndex(k)] += cc[k];
+                    hasCost = true;
+                }
+            }
+            if (!hasCost) continue;
+
+            // add to column layout of each group type
+            for(int t=0; t<3; t++) {
+                int g = _groups.at(3*i + t);
+                if (g<0) continue;
+                for(int k=0; k<_realCount; k++)
+                    c[t][k * _groupCount[t] + g] += self.at(k);
+            }
+        }
+    }
+
+private:
+    const QVector<TraceFunction*>& _functions;
+    const QVector<int>& _groups;
+    const int* _groupCount;
+    int _realCount;
+    const QVector<SubCost*>& _costs;
+};
+
+
+//---------------------------------------------------
+// GroupCosts
+
+GroupCosts::GroupCosts(TraceData* data)
+{
+    _data = data;
+    _valid = false;
+}
+
+void GroupCosts::update()
+{
+    if (_valid) return;
+
+    collect();
+    _valid = true;
+}
+
+const GroupCostColumns& GroupCosts::columns(ProfileContext::Type t)
+{
+    update();
+
+    switch(t) {
+    case ProfileContext::File:  return _file;
+    case ProfileContext::Class: return _class;
+    default: break;
+    }
+    return _object;
+}
+
+SubCost GroupCosts::subCost(TraceCostItem* group, EventType* t)
+{
+    if (!group || !t) return 0;
+
+    const GroupCostColumns& cols = columns(group->type());
+    int g = cols.index(group);
+    if (g<0) return 0;
+
+    QVector<const SubCost*> columns(cols._realCount);
+    for(int i=0; i<cols._realCount; i++)
+        columns[i] = cols.column(i) + g;
+    SubCost res;
+    t->subCosts(columns.constData(), 1, &res);
+    return res;
+}
+
+void GroupCosts::collect()
+{
+    int realCount = _data->eventTypes()->realCount();
+    GroupCostColumns* cols[3] = { &_object, &_file, &_class };
+
+    for(int t=0; t<3; t++) {
+        cols[t]->_groups.clear();
+        cols[t]->_index.clear();
+        cols[t]->_cost.clear();
+        cols[t]->_realCount = realCount;
+    }
+
+    TraceObjectMap::Iterator oit;
+    for ( oit = _data->objectMap().begin();
+          oit != _data->objectMap().end(); ++oit ) {
+        _object._index.insert(&(*oit), _object._groups.count());
+        _object._groups.append(&(*oit));
+    }
+    TraceFileMap::Iterator fit;
+    for ( fit = _data->fileMap().begin();
+          fit != _data->fileMap().end(); ++fit ) {
+        _file._index.insert(&(*fit), _file._groups.count());
+        _file._groups.append(&(*fit));
+    }
+    TraceClassMap::Iterator cit;
+    for ( cit = _data->classMap().begin();
+          cit != _data->classMap().end(); ++cit ) {
+        _class._index.insert(&(*cit), _class._groups.count());
+        _class._groups.append(&(*cit));
+    }
+
+    QVector<TraceFunction*> functions;
+    QVector<int> groups;
+    TraceFunctionMap::Iterator it;
+    for ( it = _data->functionMap().begin();
+          it != _data->functionMap().end(); ++it ) {
+        TraceFunction* f = &(*it);
+        functions.append(f);
+        groups.append(_object.index(f->object()));
+        groups.append(_file.index(f->file()));
+        groups.append(_class.index(f->cls()));
+    }
+
+    int groupCount[3];
+    for(int t=0; t<3; t++)
+        groupCount[t] = cols[t]->count();
+
+    QVector<SubCost*> costs;
+    GroupCostJob job(functions, groups, groupCount, realCount, costs);
+
+    // per worker: one column set for each group type
+    int workers = job.workers();
+    for(int w=0; w<workers; w++)
+        for(int t=0; t<3; t++) {
+            int size = realCount * groupCount[t];
+            SubCost* c = new SubCost[size];
+            for(int j=0; j<size; j++) c[j] = 0;
+            costs.append(c);
+        }
+
+    Parallel::run(&job, functions.count());
+
+    for(int t=0; t<3; t++) {
+        int size = realCount * groupCount[t];
+        cols[t]->_cost.fill(SubCost(0), size);
+        SubCost* res = cols[t]->_cost.data();
+        for(int w=0; w<workers; w++) {
+            SubCost* c = costs.at(3*w + t);
+            for(int j=0; j<size; j++)
+                res[j] += c[j];
+            delete[] c;
+        }
+    }
+
+    if (0) qDebug("GroupCosts: %d objects, %d files, %d classes",
+                  _object.count(), _file.count(), _class.count());
+}
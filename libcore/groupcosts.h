@@ -0,0 +1,98 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Self cost aggregates of objects, files and classes
+ */
+
+#ifndef GROUPCOSTS_H
+#define GROUPCOSTS_H
+
+#include <QHash>
+#include <QVector>
+
+#include "context.h"
+#include "subcost.h"
+
+class TraceData;
+class TraceCostItem;
+class TraceFunction;
+class EventType;
+
+/**
+ * Cost of all groups of one type (ELF object, source file or class),
+ * stored as one column per real event type.
+ */
+class GroupCostColumns
+{
+public:
+    GroupCostColumns();
+
+    int count() const { return _groups.count(); }
+    TraceCostItem* group(int i) const { return _groups.at(i); }
+    // -1 if group has no functions
+    int index(TraceCostItem* g) const { return _index.value(g, -1); }
+
+    // cost of all groups for a real event type
+    const SubCost* column(int realIndex) const;
+    // cost of all groups for any event type, indexed as group(i)
+    QVector<SubCost> costs(EventType*) const;
+
+private:
+    friend class GroupCosts;
+
+    QVector<TraceCostItem*> _groups;
+    QHash<TraceCostItem*, int> _index;
+    // _realCount columns of count() entries each
+    QVector<SubCost> _cost;
+    int _realCount;
+};
+
+/**
+ * Self cost of ELF objects, source files and classes, i.e. the
+ * summed self cost of their functions.
+ *
+ * This gives the same values as TraceCostItem::subCost(), but all
+ * groups are calculated in one parallel pass over the functions,
+ * directly from the FixCost lists of active parts. Derived event types
+ * are evaluated for all groups of a type at once.
+ * Calculation is done on demand and stays valid until invalidate() is
+ * called, which TraceData does whenever the set of active parts changes.
+ */
+class GroupCosts
+{
+public:
+    explicit GroupCosts(TraceData*);
+
+    void invalidate() { _valid = false; }
+    bool isValid() const { return _valid; }
+    void update();
+
+    // calls update() if needed. Type is Object, File or Class
+    const GroupCostColumns& columns(ProfileContext::Type);
+    SubCost subCost(TraceCostItem* group, EventType*);
+
+private:
+    void collect();
+
+    TraceData* _data;
+    bool _valid;
+    GroupCostColumns _object, _file, _class;
+};
+
+#endif
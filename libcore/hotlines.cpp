@@ -0,0 +1,312 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Program-wide ranking of source lines
+ */
+
+#include "hotlines.h"
+
+#include <algorithm>
+
+#include "fixcost.h"
+#include "parallel.h"
+
+
+//---------------------------------------------------
+// HotLineMap
+
+HotLineMap::HotLineMap()
+{
+    _realCount = 0;
+}
+
+void HotLineMap::clear(int realCount)
+{
+    _realCount = realCount;
+    _index.clear();
+    _lines.clear();
+    _costs.clear();
+}
+
+// the returned pointer is only valid until the next call
+SubCost* HotLineMap::cost(TraceFile* file, uint lineno, int* index)
+{
+    int i;
+    QHash<HotLineKey, int>::const_iterator it;
+    it = _index.constFind(HotLineKey(file, lineno));
+    if (it != _index.constEnd())
+        i = it.value();
+    else {
+        HotLine l;
+        l.file = file;
+        l.lineno = lineno;
+        l.offset = _costs.count();
+
+        i = _lines.count();
+        _lines.append(l);
+        // new counters are zero-initialized by SubCost constructor
+        _costs.resize(_costs.count() + _realCount);
+        _index.insert(HotLineKey(file, lineno), i);
+    }
+
+    if (index) *index = i;
+    return _costs.data() + _lines[i].offset;
+}
+
+void HotLineMap::addFunctionCost(int index, TraceFunction* f, SubCost c)
+{
+    HotLine& l = _lines[index];
+
+    l.functionCount++;
+    if (!l.function || (c > l.functionCost)) {
+        l.function = f;
+        l.functionCost = c;
+    }
+}
+
+void HotLineMap::merge(const HotLineMap& other)
+{
+    Q_ASSERT(other._realCount == _realCount);
+
+    int index;
+    for(int j=0; j<other.count(); j++) {
+        const HotLine& ol = other.line(j);
+        SubCost* c = cost(ol.file, ol.lineno, &index);
+        const SubCost* oc = other.costs(j);
+        for(int e=0; e<_realCount; e++)
+            c[e] += oc[e];
+
+        // a function only is seen by one worker: just add counts
+        HotLine& l = _lines[index];
+        l.functionCount += ol.functionCount;
+        if (!ol.function) continue;
+        if (!l.function ||
+            (ol.functionCost > l.functionCost) ||
+            (((uint64)ol.functionCost == (uint64)l.functionCost) &&
+             (ol.function->name() < l.function->name()))) {
+            l.function = ol.function;
+            l.functionCost = ol.functionCost;
+        }
+    }
+}
+
+
+//---------------------------------------------------
+// HotLinesJob
+
+/*
+ * Collects cost of lines from FixCost lists of a range of functions.
+ * Per function, cost first goes into a local map to find out the
+ * function contributing most to a line.
+ */
+class HotLinesJob: public ParallelJob
+{
+public:
+    HotLinesJob(const QVector<TraceFunction*>& functions,
+                const QVector<HotLineMap*>& maps)
+        : _functions(functions), _maps(maps)
+    {}
+
+    void run(int from, int to, int worker) override
+    {
+        HotLineMap* map = _maps.at(worker);
+        int realCount = map->realCount();
+        HotLineMap local;
+        int index;
+
+        for(int i=from; i<to; i++) {
+            TraceFunction* f = _functions.at(i);
+            local.clear(realCount);
+
+            foreach(TraceInclusiveCost* ic, f->deps()) {
+                TracePartFunction* pf = (TracePartFunction*) ic;
+                FixCost* fc = pf->firstFixCost();
+                for(; fc; fc = fc->nextCostOfPartFunction()) {
+                    if (!fc->part()->isActive()) continue;
+                    if (fc->line() == 0) continue;
+                    TraceFunctionSource* fs = fc->functionSource();
+                    if (!fs || !fs->file()) continue;
+
+                    fc->addTo(local.cost(fs->file(), fc->line()));
+                }
+            }
+
+            for(int j=0; j<local.count(); j++) {
+                const HotLine& l = local.line(j);
+                SubCost* c = map->cost(l.file, l.lineno, &index);
+                const SubCost* lc = local.costs(j);
+                for(int e=0; e<realCount; e++)
+                    c[e] += lc[e];
+                map->addFunctionCost(index, f,
+                                     (realCount>0) ? lc[0] : SubCost(0));
+            }
+        }
+    }
+
+private:
+    const QVector<TraceFunction*>& _functions;
+    const QVector<HotLineMap*>& _maps;
+};
+
+
+//---------------------------------------------------
+// HotLines
+
+HotLines::HotLines()
+{
+    _data = nullptr;
+}
+
+void HotLines::clear()
+{
+    _data = nullptr;
+    _map.clear(0);
+}
+
+void HotLines::calculate(TraceData* data)
+{
+    clear();
+    if (!data) return;
+    _data = data;
+
+    int realCount = data->eventTypes()->realCount();
+    _map.clear(realCount);
+
+    QVector<TraceFunction*> functions;
+    functions.reserve(data->functionMap().count());
+    TraceFunctionMap::Iterator it;
+    for (it = data->functionMap().begin();
+         it != data->functionMap().end(); ++it)
+        functions.append(&(*it));
+
+    QVector<HotLineMap*> maps;
+    HotLinesJob job(functions, maps);
+
+    // worker 0 collects into final map directly
+    maps.append(&_map);
+    for(int w=1; w<job.workers(); w++) {
+        HotLineMap* m = new HotLineMap;
+        m->clear(realCount);
+        maps.append(m);
+    }
+
+    Parallel::run(&job, functions.count());
+
+    for(int w=1; w<maps.count(); w++) {
+        _map.merge(*maps[w]);
+        delete maps[w];
+    }
+}
+
+SubCost HotLines::subCost(int i, EventType* ct) const
+{
+    if (!ct || i<0 || i>=count()) return 0;
+
+    const SubCost* c = _map.costs(i);
+    int ri = ct->realIndex();
+    if (ri != ProfileCostArray::InvalidIndex)
+        return (ri < _map.realCount()) ? c[ri] : SubCost(0);
+
+    // derived event type: evaluate formula on a temporary cost array
+    ProfileCostArray a;
+    addCost(i, &a);
+    return ct->subCost(&a);
+}
+
+void HotLines::addCost(int i, ProfileCostArray* c) const
+{
+    if (i<0 || i>=count()) return;
+
+    const SubCost* lc = _map.costs(i);
+    for(int e=0; e<_map.realCount(); e++)
+        c->addCost(e, lc[e]);
+}
+
+struct HotLineRank
+{
+    SubCost cost;
+    const HotLine* line;
+    int index;
+};
+
+static bool hotLineRankGreater(const HotLineRank& r1, const HotLineRank& r2)
+{
+    if ((uint64)r1.cost != (uint64)r2.cost) return r1.cost > r2.cost;
+
+    // make order independent from merge order of worker results
+    if (r1.line->file != r2.line->file)
+        return r1.line->file->name() < r2.line->file->name();
+    return r1.line->lineno < r2.line->lineno;
+}
+
+QVector<int> HotLines::top(EventType* ct, int n, int* total) const
+{
+    QVector<HotLineRank> ranks;
+    ranks.reserve(count());
+    for(int i=0; i<count(); i++) {
+        HotLineRank r;
+        r.cost = subCost(i, ct);
+        if (r.cost == 0) continue;
+        r.line = &_map.line(i);
+        r.index = i;
+        ranks.append(r);
+    }
+    if (total) *total = ranks.count();
+
+    if (n > ranks.count()) n = ranks.count();
+    if (n < 0) n = 0;
+    std::partial_sort(ranks.begin(), ranks.begin() + n, ranks.end(),
+                      hotLineRankGreater);
+
+    QVector<int> res;
+    res.reserve(n);
+    for(int i=0; i<n; i++)
+        res.append(ranks[i].index);
+    return res;
+}
+
+EventType* HotLines::accessType(EventType* missType)
+{
+    // pairs of (miss event, access event) as produced by cachegrind
+    static const char* const missAccess[] = {
+        "I1mr", "Ir", "ILmr", "Ir", "I2mr", "Ir",
+        "D1mr", "Dr", "DLmr", "Dr", "D2mr", "Dr",
+        "D1mw", "Dw", "DLmw", "Dw", "D2mw", "Dw",
+        "Bcm", "Bc", "Bim", "Bi",
+        nullptr };
+
+    if (!missType || !missType->set()) return nullptr;
+
+    for(int i=0; missAccess[i]; i+=2)
+        if (missType->name() == QLatin1String(missAccess[i]))
+            return missType->set()->type(QLatin1String(missAccess[i+1]));
+
+    return nullptr;
+}
+
+double HotLines::missRatio(int i, EventType* missType) const
+{
+    EventType* at = accessType(missType);
+    if (!at) return -1.0;
+
+    SubCost access = subCost(i, at);
+    if (access == 0) return -1.0;
+
+    return (double)(uint64)subCost(i, missType) / (double)(uint64)access;
+}
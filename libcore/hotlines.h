@@ -0,0 +1,135 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Program-wide ranking of source lines
+ */
+
+#ifndef HOTLINES_H
+#define HOTLINES_H
+
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+#include "tracedata.h"
+
+/**
+ * Cost of one source line, summed up over all functions
+ * (including code inlined from this line) and all active parts.
+ */
+class HotLine
+{
+public:
+    HotLine()
+    { file = nullptr; lineno = 0; function = nullptr;
+      functionCount = 0; offset = 0; }
+
+    TraceFile* file;
+    uint lineno;
+    // function contributing most cost (first real event type)
+    TraceFunction* function;
+    SubCost functionCost;
+    int functionCount;
+    // start of event counters in cost array of HotLineMap
+    int offset;
+};
+
+typedef QPair<TraceFile*, uint> HotLineKey;
+
+/**
+ * Hash map from (file, line) to HotLine, with the event counters of
+ * all lines in one flat array. Maps built by different threads can be
+ * merged into one.
+ */
+class HotLineMap
+{
+public:
+    HotLineMap();
+
+    void clear(int realCount);
+    int count() const { return _lines.count(); }
+    int realCount() const { return _realCount; }
+
+    // returns counter array of line, created with zero cost if new
+    SubCost* cost(TraceFile*, uint lineno, int* index = nullptr);
+    void addFunctionCost(int index, TraceFunction*, SubCost);
+    void merge(const HotLineMap&);
+
+    const HotLine& line(int i) const { return _lines[i]; }
+    SubCost* costs(int i) { return _costs.data() + _lines[i].offset; }
+    const SubCost* costs(int i) const
+    { return _costs.constData() + _lines[i].offset; }
+
+private:
+    int _realCount;
+    QHash<HotLineKey, int> _index;
+    QVector<HotLine> _lines;
+    QVector<SubCost> _costs;
+};
+
+
+/**
+ * Ranking of source lines of a profile by cost.
+ *
+ * calculate() runs in parallel over the FixCost line information of
+ * all functions, with each worker thread collecting into its own
+ * HotLineMap. Afterwards, these are merged.
+ * Costs are only available with FixCost data (USE_FIXCOST).
+ */
+class HotLines
+{
+public:
+    HotLines();
+
+    void clear();
+    void calculate(TraceData*);
+
+    TraceData* data() const { return _data; }
+    int count() const { return _map.count(); }
+    const HotLine& line(int i) const { return _map.line(i); }
+    SubCost subCost(int i, EventType*) const;
+    // add cost of line <i> to <c>, e.g. for use with derived event types
+    void addCost(int i, ProfileCostArray* c) const;
+
+    /**
+     * Indexes of up to <n> lines with highest cost for <ct>,
+     * sorted by decreasing cost. Lines without cost are skipped.
+     * If <total> is given, it is set to the number of lines with cost.
+     */
+    QVector<int> top(EventType* ct, int n, int* total = nullptr) const;
+
+    /**
+     * For cache/branch miss event types as produced by cachegrind,
+     * returns the event type counting the related accesses,
+     * e.g. "Dr" for "D1mr". Returns 0 if not known or not available.
+     */
+    static EventType* accessType(EventType* missType);
+
+    /**
+     * Miss ratio at line <i>, i.e. ratio of <missType> cost to cost of
+     * the related access event. Returns -1 if not known.
+     */
+    double missRatio(int i, EventType* missType) const;
+
+private:
+    TraceData* _data;
+    HotLineMap _map;
+};
+
+#endif
@@ -0,0 +1,368 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Program-wide index of cost from inlined code
+ */
+
+#include "inlinedindex.h"
+
+#include <algorithm>
+
+#include <QHash>
+
+#include "fixcost.h"
+#include "hotlines.h"
+#include "parallel.h"
+
+
+//---------------------------------------------------
+// InlinedRange
+
+QString InlinedRange::name() const
+{
+    if (!file) return QString();
+    if (firstLineno == lastLineno)
+        return QStringLiteral("%1:%2").arg(file->shortName()).arg(firstLineno);
+    return QStringLiteral("%1:%2-%3").arg(file->shortName())
+            .arg(firstLineno).arg(lastLineno);
+}
+
+
+//---------------------------------------------------
+// InlinedIndexJob
+
+/*
+ * Line range of one function in one file: either inlined code with
+ * cost, or the lines of the function's own (non-inlined) code.
+ */
+struct InlinedFragment
+{
+    TraceFile* file;
+    uint first, last;
+    TraceFunction* function;
+    // start of counters in cost array, -1 for own code
+    int offset;
+};
+
+// results of one worker
+class InlinedFragments
+{
+public:
+    QVector<InlinedFragment> fragments;
+    QVector<SubCost> costs;
+};
+
+// orders lines of a HotLineMap by file and line number
+class LineOrder
+{
+public:
+    explicit LineOrder(const HotLineMap& m): _m(m) {}
+
+    bool operator()(int i1, int i2) const
+    {
+        const HotLine& l1 = _m.line(i1);
+        const HotLine& l2 = _m.line(i2);
+        if (l1.file != l2.file) return l1.file < l2.file;
+        return l1.lineno < l2.lineno;
+    }
+
+private:
+    const HotLineMap& _m;
+};
+
+/*
+ * Collects cost of lines from FixCost lists of a range of functions,
+ * split into fragments of inlined code.
+ */
+class InlinedIndexJob: public ParallelJob
+{
+public:
+    InlinedIndexJob(const QVector<TraceFunction*>& functions,
+                    const QVector<InlinedFragments*>& results, int realCount)
+        : _functions(functions), _results(results), _realCount(realCount)
+    {}
+
+    void run(int from, int to, int worker) override
+    {
+        InlinedFragments* res = _results.at(worker);
+        HotLineMap local;
+
+        for(int i=from; i<to; i++) {
+            TraceFunction* f = _functions.at(i);
+            // without own file, inlined code can not be detected
+            if (!f->file()) continue;
+            local.clear(_realCount);
+            uint ownFirst = 0, ownLast = 0;
+
+            foreach(TraceInclusiveCost* ic, f->deps()) {
+                TracePartFunction* pf = (TracePartFunction*) ic;
+                FixCost* fc = pf->firstFixCost();
+                for(; fc; fc = fc->nextCostOfPartFunction()) {
+                    if (!fc->part()->isActive()) continue;
+                    if (fc->line() == 0) continue;
+                    TraceFunctionSource* fs = fc->functionSource();
+                    if (!fs || !fs->file()) continue;
+
+                    if (fs->file() == f->file()) {
+                        if ((ownFirst == 0) || (fc->line() < ownFirst))
+                            ownFirst = fc->line();
+                        if (fc->line() > ownLast)
+                            ownLast = fc->line();
+                        continue;
+                    }
+                    fc->addTo(local.cost(fs->file(), fc->line()));
+                }
+            }
+
+            if (ownFirst > 0) {
+                InlinedFragment own = { f->file(), ownFirst, ownLast, f, -1 };
+                res->fragments.append(own);
+            }
+            if (local.count() == 0) continue;
+
+            // split lines of each inlined file at gaps
+            QVector<int> lines(local.count());
+            for(int j=0; j<local.count(); j++)
+                lines[j] = j;
+            std::sort(lines.begin(), lines.end(), LineOrder(local));
+
+            InlinedFragment frag = { nullptr, 0, 0, f, 0 };
+            SubCost* c = nullptr;
+            foreach(int j, lines) {
+                const HotLine& l = local.line(j);
+                if ((l.file != frag.file) ||
+                    (l.lineno > frag.last + MaxGap)) {
+                    if (frag.file) res->fragments.append(frag);
+                    frag.file = l.file;
+                    frag.first = l.lineno;
+                    frag.offset = res->costs.count();
+                    res->costs.resize(res->costs.count() + _realCount);
+                    c = res->costs.data() + frag.offset;
+                }
+                frag.last = l.lineno;
+                const SubCost* lc = local.costs(j);
+                for(int e=0; e<_realCount; e++)
+                    c[e] += lc[e];
+            }
+            res->fragments.append(frag);
+        }
+    }
+
+private:
+    enum { MaxGap = InlinedIndex::MaxGap };
+
+    const QVector<TraceFunction*>& _functions;
+    const QVector<InlinedFragments*>& _results;
+    int _realCount;
+};
+
+
+//---------------------------------------------------
+// InlinedIndex
+
+// inlined fragment with its counters
+struct FragmentRef
+{
+    const InlinedFragment* fragment;
+    const SubCost* costs;
+};
+
+// make order independent from distribution of functions to workers
+static bool fragmentLess(const FragmentRef& r1, const FragmentRef& r2)
+{
+    const InlinedFragment* f1 = r1.fragment;
+    const InlinedFragment* f2 = r2.fragment;
+    if (f1->file != f2->file)
+        return f1->file->name() < f2->file->name();
+    if (f1->first != f2->first)
+        return f1->first < f2->first;
+    return f1->function->name() < f2->function->name();
+}
+
+InlinedIndex::InlinedIndex()
+{
+    _data = nullptr;
+    _realCount = 0;
+}
+
+void InlinedIndex::clear()
+{
+    _data = nullptr;
+    _realCount = 0;
+    _ranges.clear();
+    _costs.clear();
+}
+
+void InlinedIndex::calculate(TraceData* data)
+{
+    clear();
+    if (!data) return;
+    _data = data;
+    _realCount = data->eventTypes()->realCount();
+
+    QVector<TraceFunction*> functions;
+    functions.reserve(data->functionMap().count());
+    TraceFunctionMap::Iterator it;
+    for (it = data->functionMap().begin();
+         it != data->functionMap().end(); ++it)
+        functions.append(&(*it));
+
+    QVector<InlinedFragments*> results;
+    InlinedIndexJob job(functions, results, _realCount);
+    for(int w=0; w<job.workers(); w++)
+        results.append(new InlinedFragments);
+
+    Parallel::run(&job, functions.count());
+
+    // inlined fragments sorted by position, and own code per file
+    QVector<FragmentRef> refs;
+    QHash<TraceFile*, QVector<const InlinedFragment*> > own;
+    foreach(InlinedFragments* res, results) {
+        for(int k=0; k<res->fragments.count(); k++) {
+            const InlinedFragment& frag = res->fragments.at(k);
+            if (frag.offset < 0) {
+                own[frag.file].append(&frag);
+                continue;
+            }
+            FragmentRef r = { &frag, res->costs.constData() + frag.offset };
+            refs.append(r);
+        }
+    }
+    std::sort(refs.begin(), refs.end(), fragmentLess);
+
+    // merge overlapping fragments into ranges
+    int i = 0;
+    while(i < refs.count()) {
+        InlinedRange r;
+        r.file = refs.at(i).fragment->file;
+        r.firstLineno = r.lastLineno = refs.at(i).fragment->first;
+        r.offset = _costs.count();
+        _costs.resize(_costs.count() + _realCount);
+        SubCost* c = _costs.data() + r.offset;
+
+        QHash<TraceFunction*, SubCost> functionCost;
+        for(; i < refs.count(); i++) {
+            const InlinedFragment* frag = refs.at(i).fragment;
+            if ((frag->file != r.file) || (frag->first > r.lastLineno)) break;
+
+            if (frag->last > r.lastLineno) r.lastLineno = frag->last;
+            const SubCost* fc = refs.at(i).costs;
+            for(int e=0; e<_realCount; e++)
+                c[e] += fc[e];
+            functionCost[frag->function] +=
+                    (_realCount > 0) ? fc[0] : SubCost(0);
+        }
+
+        r.functionCount = functionCost.count();
+        QHash<TraceFunction*, SubCost>::const_iterator fit;
+        for(fit = functionCost.constBegin(); fit != functionCost.constEnd(); ++fit) {
+            if (!r.function ||
+                (fit.value() > r.functionCost) ||
+                (((uint64)fit.value() == (uint64)r.functionCost) &&
+                 (fit.key()->name() < r.function->name()))) {
+                r.function = fit.key();
+                r.functionCost = fit.value();
+            }
+        }
+
+        // smallest non-inlined function covering the range
+        uint span = 0;
+        foreach(const InlinedFragment* o, own.value(r.file)) {
+            if ((o->first > r.firstLineno) || (o->last < r.lastLineno))
+                continue;
+            if (r.inlinedFunction && (o->last - o->first >= span))
+                continue;
+            r.inlinedFunction = o->function;
+            span = o->last - o->first;
+        }
+
+        _ranges.append(r);
+    }
+
+    qDeleteAll(results);
+
+    if (0) qDebug("InlinedIndex: %d ranges from %d fragments",
+                  _ranges.count(), refs.count());
+}
+
+SubCost InlinedIndex::subCost(int i, EventType* ct) const
+{
+    if (!ct || i<0 || i>=count()) return 0;
+
+    const SubCost* c = _costs.constData() + _ranges[i].offset;
+    int ri = ct->realIndex();
+    if (ri != ProfileCostArray::InvalidIndex)
+        return (ri < _realCount) ? c[ri] : SubCost(0);
+
+    // derived event type: evaluate formula on a temporary cost array
+    ProfileCostArray a;
+    addCost(i, &a);
+    return ct->subCost(&a);
+}
+
+void InlinedIndex::addCost(int i, ProfileCostArray* c) const
+{
+    if (i<0 || i>=count()) return;
+
+    const SubCost* rc = _costs.constData() + _ranges[i].offset;
+    for(int e=0; e<_realCount; e++)
+        c->addCost(e, rc[e]);
+}
+
+struct InlinedRank
+{
+    SubCost cost;
+    const InlinedRange* range;
+    int index;
+};
+
+static bool inlinedRankGreater(const InlinedRank& r1, const InlinedRank& r2)
+{
+    if ((uint64)r1.cost != (uint64)r2.cost) return r1.cost > r2.cost;
+
+    if (r1.range->file != r2.range->file)
+        return r1.range->file->name() < r2.range->file->name();
+    return r1.range->firstLineno < r2.range->firstLineno;
+}
+
+QVector<int> InlinedIndex::top(EventType* ct, int n, int* total) const
+{
+    QVector<InlinedRank> ranks;
+    ranks.reserve(count());
+    for(int i=0; i<count(); i++) {
+        InlinedRank r;
+        r.cost = subCost(i, ct);
+        if (r.cost == 0) continue;
+        r.range = &_ranges[i];
+        r.index = i;
+        ranks.append(r);
+    }
+    if (total) *total = ranks.count();
+
+    if (n > ranks.count()) n = ranks.count();
+    if (n < 0) n = 0;
+    std::partial_sort(ranks.begin(), ranks.begin() + n, ranks.end(),
+                      inlinedRankGreater);
+
+    QVector<int> res;
+    res.reserve(n);
+    for(int i=0; i<n; i++)
+        res.append(ranks[i].index);
+    return res;
+}
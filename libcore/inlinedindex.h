@@ -0,0 +1,100 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Program-wide index of cost from inlined code
+ */
+
+#ifndef INLINEDINDEX_H
+#define INLINEDINDEX_H
+
+#include <QVector>
+
+#include "tracedata.h"
+
+/**
+ * A range of source lines inlined into functions, e.g. from a
+ * template or inline function in a header file. Cost is summed up
+ * over all functions containing code from this range.
+ */
+class InlinedRange
+{
+public:
+    InlinedRange()
+    { file = nullptr; firstLineno = lastLineno = 0;
+      inlinedFunction = nullptr; function = nullptr;
+      functionCount = 0; offset = 0; }
+
+    TraceFile* file;
+    uint firstLineno, lastLineno;
+    // function with non-inlined code covering the range, if any
+    TraceFunction* inlinedFunction;
+    // containing function with most cost (first real event type)
+    TraceFunction* function;
+    SubCost functionCost;
+    int functionCount;
+    // start of event counters in cost array of InlinedIndex
+    int offset;
+
+    QString name() const;
+};
+
+/**
+ * Index of code inlined from other source files ("fi="/"fe=" in
+ * callgrind format), keyed by (file, line range).
+ *
+ * calculate() runs in parallel over the FixCost line information of
+ * all functions. Per function, lines from a file other than the
+ * one of the function are grouped into ranges, with at most <MaxGap>
+ * lines without cost in between. Ranges of all functions overlapping
+ * each other are merged afterwards. This way, one range typically
+ * covers an inline function, as callgrind has no information about
+ * the boundaries of inlined functions.
+ * Costs are only available with FixCost data (USE_FIXCOST).
+ */
+class InlinedIndex
+{
+public:
+    enum { MaxGap = 5 };
+
+    InlinedIndex();
+
+    void clear();
+    void calculate(TraceData*);
+
+    TraceData* data() const { return _data; }
+    int count() const { return _ranges.count(); }
+    const InlinedRange& range(int i) const { return _ranges[i]; }
+    SubCost subCost(int i, EventType*) const;
+    void addCost(int i, ProfileCostArray* c) const;
+
+    /**
+     * Indexes of up to <n> ranges with highest cost for <ct>,
+     * sorted by decreasing cost. Ranges without cost are skipped.
+     * If <total> is given, it is set to the number of ranges with cost.
+     */
+    QVector<int> top(EventType* ct, int n, int* total = nullptr) const;
+
+private:
+    TraceData* _data;
+    int _realCount;
+    QVector<InlinedRange> _ranges;
+    QVector<SubCost> _costs;
+};
+
+#endif
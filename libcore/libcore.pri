@@ -4,34 +4,71 @@ DEPENDPATH += $$PWD
 NHEADERS += \
     $$PWD/context.h \
     $$PWD/costitem.h \
+    $$PWD/costkernels.h \
     $$PWD/subcost.h \
     $$PWD/eventtype.h \
     $$PWD/addr.h \
+    $$PWD/addressindex.h \
     $$PWD/config.h \
     $$PWD/globalconfig.h \
     $$PWD/tracedata.h \
     $$PWD/utils.h \
     $$PWD/logger.h \
     $$PWD/loader.h \
+    $$PWD/loadstats.h \
+    $$PWD/memorycheck.h \
     $$PWD/fixcost.h \
     $$PWD/pool.h \
+    $$PWD/computecache.h \
+    $$PWD/costheatmap.h \
     $$PWD/coverage.h \
-    $$PWD/stackbrowser.h
+    $$PWD/dominators.h \
+    $$PWD/fleetstats.h \
+    $$PWD/groupcallgraph.h \
+    $$PWD/groupcosts.h \
+    $$PWD/hotlines.h \
+    $$PWD/inlinedindex.h \
+    $$PWD/modelpruner.h \
+    $$PWD/parallel.h \
+    $$PWD/partcostmatrix.h \
+    $$PWD/phasedetection.h \
+    $$PWD/quantilesketch.h \
+    $$PWD/stackbrowser.h \
+    $$PWD/warehouse.h
 
 SOURCES += \
     $$PWD/context.cpp \
     $$PWD/costitem.cpp \
+    $$PWD/costkernels.cpp \
     $$PWD/subcost.cpp \
     $$PWD/eventtype.cpp \
     $$PWD/addr.cpp \
+    $$PWD/addressindex.cpp \
     $$PWD/cachegrindloader.cpp \
     $$PWD/config.cpp \
+    $$PWD/computecache.cpp \
+    $$PWD/costheatmap.cpp \
     $$PWD/coverage.cpp \
+    $$PWD/dominators.cpp \
     $$PWD/fixcost.cpp \
+    $$PWD/fleetstats.cpp \
     $$PWD/globalconfig.cpp \
+    $$PWD/groupcallgraph.cpp \
+    $$PWD/groupcosts.cpp \
+    $$PWD/hotlines.cpp \
+    $$PWD/inlinedindex.cpp \
     $$PWD/loader.cpp \
+    $$PWD/loadstats.cpp \
+    $$PWD/memorycheck.cpp \
     $$PWD/logger.cpp \
+    $$PWD/massifloader.cpp \
+    $$PWD/modelpruner.cpp \
+    $$PWD/parallel.cpp \
+    $$PWD/partcostmatrix.cpp \
+    $$PWD/phasedetection.cpp \
     $$PWD/pool.cpp \
+    $$PWD/quantilesketch.cpp \
     $$PWD/stackbrowser.cpp \
     $$PWD/tracedata.cpp \
-    $$PWD/utils.cpp
+    $$PWD/utils.cpp \
+    $$PWD/warehouse.cpp
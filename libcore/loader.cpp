@@ -23,6 +23,7 @@
 #include "loader.h"
 
 #include "logger.h"
+#include "loadstats.h"
 
 /// Loader
 
@@ -34,6 +35,7 @@ Loader::Loader(const QString& name, const QString& desc)
     _description = desc;
 
     _logger = nullptr;
+    _stats = nullptr;
 }
 
 Loader::~Loader()
@@ -58,6 +60,27 @@ Loader* Loader::matchingLoader(QIODevice* file)
     return nullptr;
 }
 
+// factories of available loaders
+Loader* createCachegrindLoader();
+Loader* createMassifLoader();
+
+Loader* Loader::createMatchingLoader(QIODevice* file)
+{
+    typedef Loader* (*Factory)();
+    static const Factory factories[] = {
+        createCachegrindLoader, createMassifLoader
+    };
+
+    for (Factory create : factories) {
+        Loader* l = create();
+        if (l->canLoad(file))
+            return l;
+        delete l;
+    }
+
+    return nullptr;
+}
+
 Loader* Loader::loader(const QString& name)
 {
     foreach (Loader* l, _loaderList)
@@ -67,12 +90,10 @@ Loader* Loader::loader(const QString& name)
     return nullptr;
 }
 
-// factories of available loaders
-Loader* createCachegrindLoader();
-
 void Loader::initLoaders()
 {
     _loaderList.append(createCachegrindLoader());
+    _loaderList.append(createMassifLoader());
     //_loaderList.append(GProfLoader::createLoader());
 }
 
@@ -89,6 +110,11 @@ void Loader::setLogger(Logger* l)
     _logger = l;
 }
 
+void Loader::setStatistics(LoadStatistics* s)
+{
+    _stats = s;
+}
+
 void Loader::loadStart(const QString& filename)
 {
     if (_logger)
@@ -103,18 +129,25 @@ void Loader::loadProgress(int progress)
 
 void Loader::loadError(int line, const QString& msg)
 {
+    if (_stats && !_stats->addDiagnostic(line, msg, true)) return;
     if (_logger)
         _logger->loadError(line, msg);
 }
 
 void Loader::loadWarning(int line, const QString& msg)
 {
+    if (_stats && !_stats->addDiagnostic(line, msg, false)) return;
     if (_logger)
         _logger->loadWarning(line, msg);
 }
 
 void Loader::loadFinished(const QString& msg)
 {
+    if (_stats && _logger) {
+        // tell about messages not shown
+        foreach(const QString& s, _stats->takeSuppressed())
+            _logger->loadWarning(0, s);
+    }
     if (_logger)
         _logger->loadFinished(msg);
 }
@@ -30,6 +30,7 @@ class QIODevice;
 class TraceData;
 class Loader;
 class Logger;
+class LoadStatistics;
 
 /**
  * To implement a new loader, inherit from the Loader class and
@@ -39,6 +40,8 @@ class Logger;
  * of this base class a _loaderList.append(new MyLoader()).
  *
  * matchingLoader() returns the first loader able to load a file.
+ * createMatchingLoader() returns a new instance of it, owned by the
+ * caller: use this if multiple files may be loaded in parallel.
  *
  * To show progress and warnings while loading,
  *   loadStatus(), loadError() and loadWarning() should be called.
@@ -46,6 +49,10 @@ class Logger;
  * user, but do not show real failure, as even errors can be
  * recoverable. For inability to load a file, return 0 in
  * load().
+ *
+ * With statistics set, errors and warnings are aggregated there,
+ * and only the first ones of each kind are passed to the logger.
+ * Loaders should add the number of lines read to the statistics.
  */
 
 class Loader
@@ -63,6 +70,7 @@ public:
     virtual int load(TraceData*, QIODevice* file, const QString& filename);
 
     static Loader* matchingLoader(QIODevice* file);
+    static Loader* createMatchingLoader(QIODevice* file);
     static Loader* loader(const QString& name);
     static void initLoaders();
     static void deleteLoaders();
@@ -72,6 +80,8 @@ public:
 
     // consumer for notifications
     void setLogger(Logger*);
+    // collects diagnostics and throughput while loading
+    void setStatistics(LoadStatistics*);
 
 protected:
     // notifications for the user
@@ -83,6 +93,7 @@ protected:
 
 protected:
     Logger* _logger;
+    LoadStatistics* _stats;
 
 private:
     QString _name, _description;
@@ -0,0 +1,234 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Diagnostics and throughput statistics for loading profile data
+ */
+
+#include "loadstats.h"
+
+#include <QObject>
+
+
+//---------------------------------------------------
+// LoadDiagnostic
+
+LoadDiagnostic::LoadDiagnostic(const QString& kind, bool isError)
+{
+    _kind = kind;
+    _isError = isError;
+    _count = 0;
+    _reported = 0;
+}
+
+// replace quoted strings by '...' and numbers by '#'
+QString LoadDiagnostic::kind(const QString& msg)
+{
+    QString res;
+    res.reserve(msg.length());
+
+    int len = msg.length();
+    for(int i=0; i<len; i++) {
+        QChar c = msg.at(i);
+        if (c == '\'') {
+            int end = msg.indexOf('\'', i+1);
+            if (end < 0) end = len-1;
+            res += QLatin1String("'...'");
+            i = end;
+            continue;
+        }
+        if (c.isDigit()) {
+            while(i+1<len && msg.at(i+1).isDigit()) i++;
+            res += '#';
+            continue;
+        }
+        res += c;
+    }
+    return res;
+}
+
+
+//---------------------------------------------------
+// LoadStatistics
+
+LoadStatistics::LoadStatistics()
+{
+    _bytes = 0;
+    _lines = 0;
+    for(int i=0; i<LineTypeCount; i++)
+        _typeLines[i] = 0;
+    _currentPhase = -1;
+}
+
+LoadStatistics::~LoadStatistics()
+{
+    qDeleteAll(_diagnostics);
+}
+
+void LoadStatistics::addFile(const QString& filename, qint64 bytes)
+{
+    _files.append(filename);
+    _bytes += bytes;
+}
+
+QString LoadStatistics::lineTypeName(LineType t)
+{
+    switch(t) {
+    case CostLine:     return QObject::tr("cost");
+    case CallLine:     return QObject::tr("call");
+    case JumpLine:     return QObject::tr("jump");
+    case CondJumpLine: return QObject::tr("conditional jump");
+    default: break;
+    }
+    return QString();
+}
+
+bool LoadStatistics::addDiagnostic(int line, const QString& msg, bool isError)
+{
+    QString k = LoadDiagnostic::kind(msg);
+    LoadDiagnostic* d = _kindMap.value(k);
+    if (!d) {
+        d = new LoadDiagnostic(k, isError);
+        _kindMap.insert(k, d);
+        _diagnostics.append(d);
+    }
+
+    d->_count++;
+    if (d->_examples.count() >= MaxExamples) return false;
+
+    LoadDiagnostic::Example e;
+    e.file = _files.isEmpty() ? QString() : _files.last();
+    e.line = line;
+    e.msg = msg;
+    d->_examples.append(e);
+    d->_reported++;
+
+    return true;
+}
+
+int LoadStatistics::errorCount() const
+{
+    int count = 0;
+    foreach(LoadDiagnostic* d, _diagnostics)
+        if (d->isError()) count += d->count();
+    return count;
+}
+
+int LoadStatistics::warningCount() const
+{
+    int count = 0;
+    foreach(LoadDiagnostic* d, _diagnostics)
+        if (!d->isError()) count += d->count();
+    return count;
+}
+
+QStringList LoadStatistics::takeSuppressed()
+{
+    QStringList res;
+    foreach(LoadDiagnostic* d, _diagnostics) {
+        if (d->_count == d->_reported) continue;
+        res << QObject::tr("%1 more of '%2'")
+               .arg(d->_count - d->_reported).arg(d->kind());
+        d->_reported = d->_count;
+    }
+    return res;
+}
+
+void LoadStatistics::endPhase()
+{
+    if (_currentPhase < 0) return;
+    _phases[_currentPhase].second += _phaseTimer.elapsed();
+    _currentPhase = -1;
+}
+
+void LoadStatistics::startPhase(const QString& name)
+{
+    endPhase();
+
+    for(int i=0; i<_phases.count(); i++)
+        if (_phases.at(i).first == name) {
+            _currentPhase = i;
+            break;
+        }
+    if (_currentPhase < 0) {
+        _currentPhase = _phases.count();
+        _phases.append(qMakePair(name, qint64(0)));
+    }
+    _phaseTimer.start();
+}
+
+void LoadStatistics::finish()
+{
+    endPhase();
+}
+
+qint64 LoadStatistics::totalTime() const
+{
+    qint64 t = 0;
+    for(int i=0; i<_phases.count(); i++)
+        t += _phases.at(i).second;
+    return t;
+}
+
+double LoadStatistics::bytesPerSecond() const
+{
+    qint64 t = totalTime();
+    return (t > 0) ? 1000.0 * _bytes / t : 0.0;
+}
+
+double LoadStatistics::linesPerSecond() const
+{
+    qint64 t = totalTime();
+    return (t > 0) ? 1000.0 * _lines / t : 0.0;
+}
+
+QStringList LoadStatistics::summary() const
+{
+    QStringList res;
+
+    res << QObject::tr("%n file(s), %1 bytes, %2 lines", "", _files.count())
+           .arg(_bytes).arg(_lines);
+    for(int i=0; i<LineTypeCount; i++) {
+        if (_typeLines[i] == 0) continue;
+        res << QObject::tr("  %1 lines: %2")
+               .arg(lineTypeName((LineType)i)).arg(_typeLines[i]);
+    }
+
+    res << QObject::tr("Time: %1 ms (%2 MB/s, %3 lines/s)")
+           .arg(totalTime())
+           .arg(bytesPerSecond() / 1000000.0, 0, 'f', 1)
+           .arg(linesPerSecond(), 0, 'f', 0);
+    for(int i=0; i<_phases.count(); i++)
+        res << QObject::tr("  %1: %2 ms")
+               .arg(_phases.at(i).first).arg(_phases.at(i).second);
+
+    if (!_diagnostics.isEmpty())
+        res << QObject::tr("%1 errors, %2 warnings")
+               .arg(errorCount()).arg(warningCount());
+    foreach(LoadDiagnostic* d, _diagnostics) {
+        res << QStringLiteral("  %1x %2: %3")
+               .arg(d->count())
+               .arg(d->isError() ? QObject::tr("Error") : QObject::tr("Warning"))
+               .arg(d->kind());
+        foreach(const LoadDiagnostic::Example& e, d->examples())
+            res << QStringLiteral("    %1:%2: %3")
+                   .arg(e.file).arg(e.line).arg(e.msg);
+    }
+
+    return res;
+}
@@ -0,0 +1,140 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Diagnostics and throughput statistics for loading profile data
+ */
+
+#ifndef LOADSTATS_H
+#define LOADSTATS_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+/**
+ * All problems of one kind found while loading, with the first
+ * occurrences as examples. The kind of a message is the message
+ * with quoted strings and numbers stripped (see kind()).
+ */
+class LoadDiagnostic
+{
+public:
+    struct Example {
+        QString file;
+        int line;
+        QString msg;
+    };
+
+    LoadDiagnostic(const QString& kind, bool isError);
+
+    QString kind() const { return _kind; }
+    bool isError() const { return _isError; }
+    int count() const { return _count; }
+    const QList<Example>& examples() const { return _examples; }
+
+    static QString kind(const QString& msg);
+
+private:
+    friend class LoadStatistics;
+
+    QString _kind;
+    bool _isError;
+    int _count, _reported;
+    QList<Example> _examples;
+};
+
+/**
+ * Statistics for one call of TraceData::load(), possibly
+ * covering multiple files.
+ *
+ * Loaders pass each error and warning through addDiagnostic(), which
+ * aggregates them per kind. Only the first MaxExamples messages
+ * of each kind should be forwarded to the Logger, to not flood the
+ * user (and slow down loading) with a broken file. takeSuppressed()
+ * gives a summary of the remaining ones.
+ *
+ * Time is measured per named phase: a phase lasts from startPhase()
+ * until the next phase is started or finish() is called. Time of
+ * phases with the same name is summed up.
+ */
+class LoadStatistics
+{
+public:
+    // type of lines with cost data
+    enum LineType { CostLine = 0, CallLine, JumpLine, CondJumpLine,
+                    LineTypeCount };
+    enum { MaxExamples = 5 };
+
+    LoadStatistics();
+    ~LoadStatistics();
+
+    // start reading a file of given size
+    void addFile(const QString& filename, qint64 bytes);
+    void addLines(int lines) { _lines += lines; }
+    void addLines(LineType t, int lines) { _typeLines[t] += lines; }
+
+    QStringList files() const { return _files; }
+    qint64 bytes() const { return _bytes; }
+    int lines() const { return _lines; }
+    int lines(LineType t) const { return _typeLines[t]; }
+    static QString lineTypeName(LineType);
+
+    // returns true if message should be passed on to the logger
+    bool addDiagnostic(int line, const QString& msg, bool isError);
+    const QList<LoadDiagnostic*>& diagnostics() const { return _diagnostics; }
+    int errorCount() const;
+    int warningCount() const;
+    // summary for messages not passed on since last call
+    QStringList takeSuppressed();
+
+    void startPhase(const QString& name);
+    void finish();
+    int phaseCount() const { return _phases.count(); }
+    QString phaseName(int i) const { return _phases.at(i).first; }
+    // in milliseconds
+    qint64 phaseTime(int i) const { return _phases.at(i).second; }
+    qint64 totalTime() const;
+
+    // throughput over total time
+    double bytesPerSecond() const;
+    double linesPerSecond() const;
+
+    // human readable, one entry per line
+    QStringList summary() const;
+
+private:
+    void endPhase();
+
+    QStringList _files;
+    qint64 _bytes;
+    int _lines;
+    int _typeLines[LineTypeCount];
+
+    QList<LoadDiagnostic*> _diagnostics;
+    QHash<QString, LoadDiagnostic*> _kindMap;
+
+    QList<QPair<QString, qint64> > _phases;
+    int _currentPhase;
+    QElapsedTimer _phaseTimer;
+};
+
+#endif
@@ -0,0 +1,510 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Loader for Massif heap profiles
+ */
+
+#include "loader.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QVector>
+
+#include "addr.h"
+#include "tracedata.h"
+#include "utils.h"
+#include "fixcost.h"
+#include "loadstats.h"
+
+#define TRACE_LOADER 0
+
+// functions for heap cost not covered by allocation trees
+#define HEAP_FUNCTION_NAME  "(heap allocation functions)"
+#define STACK_FUNCTION_NAME "(stacks)"
+#define BELOW_FUNCTION_NAME "(below threshold)"
+
+/*
+ * Massif output ("massif.out.<pid>") is a sequence of snapshots, each
+ * with total heap/extra heap/stack bytes at a given time, and optionally
+ * with a heap tree. In a heap tree, the root are the allocation functions,
+ * and the children of a node are the code positions calling it, with the
+ * heap bytes allocated via this call chain.
+ *
+ * Each snapshot becomes one TracePart. The children of the tree root
+ * (the direct callers of allocation functions) get the heap bytes as
+ * self cost, deeper nodes become calls to their parent node. Thus, the
+ * inclusive cost of a function are the heap bytes allocated via it.
+ * Massif does not provide call counts, so these are zero.
+ *
+ * Snapshots repeat the same allocation sites over and over again: the
+ * site description of a tree line is parsed only once and interned.
+ */
+
+// an interned allocation site of a heap tree
+struct MassifSite
+{
+    TraceFunction* function;
+    TraceFunctionSource* source;
+    uint line;
+    Addr addr;
+
+    // part function for part with number <partStamp>
+    TracePartFunction* partFunction;
+    int partStamp;
+};
+
+class MassifLoader: public Loader
+{
+public:
+    MassifLoader();
+
+    bool canLoad(QIODevice* file) override;
+    int  load(TraceData*, QIODevice* file, const QString& filename) override;
+
+private:
+    void error(const QString&);
+    MassifSite* site(FixString& desc);
+    MassifSite* syntheticSite(const char* name);
+    TracePartFunction* partFunction(MassifSite*);
+    void startSnapshot(int number);
+    void finishSnapshot();
+    bool parseTreeLine(FixString& line);
+    void addCost(MassifSite*, SubCost heap, SubCost extra, SubCost stacks);
+
+    QString _filename, _partDescription;
+    int _lineNo;
+    // heap tree nodes converted to cost and call cost
+    int _costLines, _callLines;
+    TraceData* _data;
+    FixPool* _pool;
+    TracePart* _part;
+    int _partStamp;
+    int partsAdded;
+
+    // current snapshot
+    int _snapshot;
+    QString _time, _timeUnit, _description;
+    SubCost _heap, _heapExtra, _stacks, _treeHeap;
+    bool _inTree;
+    QVector<MassifSite*> _stack;
+
+    QHash<QByteArray, MassifSite*> _sites;
+    MassifSite* _heapSite;
+    MassifSite* _stackSite;
+};
+
+
+MassifLoader::MassifLoader()
+    : Loader(QStringLiteral("Massif"),
+             QObject::tr( "Import filter for Massif heap profile files") )
+{
+    _data = nullptr;
+    _pool = nullptr;
+    _part = nullptr;
+    _heapSite = nullptr;
+    _stackSite = nullptr;
+}
+
+bool MassifLoader::canLoad(QIODevice* file)
+{
+    if (!file) return false;
+
+    Q_ASSERT(file->isOpen());
+
+    /*
+     * We recognize this as massif format if it starts with "desc:"
+     * and the first 2047 bytes contain "\ntime_unit:"
+     */
+    char buf[2048];
+    int read = file->peek(buf,2047);
+    if (read < 0)
+        return false;
+    buf[read] = 0;
+
+    QByteArray s = QByteArray::fromRawData(buf, read+1);
+    if (s.indexOf("desc:") != 0) return false;
+
+    return s.indexOf("\ntime_unit:") > 0;
+}
+
+void MassifLoader::error(const QString& msg)
+{
+    loadError(_lineNo, msg);
+}
+
+MassifSite* MassifLoader::syntheticSite(const char* name)
+{
+    MassifSite* s = new MassifSite;
+    s->function = _data->function(QString::fromLatin1(name),
+                                  _data->file(QString()),
+                                  _data->object(QString()));
+    s->source = s->function->sourceFile(nullptr, true);
+    s->line = 0;
+    s->partFunction = nullptr;
+    s->partStamp = -1;
+    return s;
+}
+
+/* Site descriptions are
+ *  "0x4005E6: main (prog.c:20)", "0x4C2A2E1: malloc (in /lib/vgpreload.so)"
+ *  or "in 3 places, all below massif's threshold (1.00%)"
+ */
+MassifSite* MassifLoader::site(FixString& desc)
+{
+    QByteArray key = QByteArray::fromRawData(desc.ascii(), desc.len());
+    MassifSite* s = _sites.value(key);
+    if (s) return s;
+
+    QString d = desc;
+    QString name, fileName, objectName;
+    uint line = 0;
+    Addr addr;
+
+    if (d.startsWith(QLatin1String("0x"))) {
+        int p = d.indexOf(QLatin1String(": "));
+        if (p < 0) p = d.length();
+        addr = Addr(d.mid(2, p-2).toULongLong(nullptr, 16));
+        QString rest = d.mid(p+2);
+
+        int lp = rest.lastIndexOf(QLatin1String(" ("));
+        if ((lp >= 0) && rest.endsWith(QLatin1Char(')'))) {
+            name = rest.left(lp);
+            QString loc = rest.mid(lp+2, rest.length() - lp - 3);
+            if (loc.startsWith(QLatin1String("in ")))
+                objectName = loc.mid(3);
+            else {
+                int cp = loc.lastIndexOf(QLatin1Char(':'));
+                if (cp >= 0) {
+                    fileName = loc.left(cp);
+                    line = loc.midRef(cp+1).toUInt();
+                }
+                else
+                    fileName = loc;
+            }
+        }
+        else
+            name = rest;
+    }
+    else
+        name = QStringLiteral(BELOW_FUNCTION_NAME);
+
+    if (name == QLatin1String("???")) name = QString();
+
+    s = new MassifSite;
+    s->function = _data->function(name,
+                                  _data->file(fileName),
+                                  _data->object(objectName));
+    s->source = s->function->sourceFile(_data->file(fileName), true);
+    s->line = line;
+    s->addr = addr;
+    s->partFunction = nullptr;
+    s->partStamp = -1;
+
+    // deep copy of key: line data is not valid after loading
+    _sites.insert(QByteArray(desc.ascii(), desc.len()), s);
+    return s;
+}
+
+TracePartFunction* MassifLoader::partFunction(MassifSite* s)
+{
+    if (s->partStamp != _partStamp) {
+        TraceFunction* f = s->function;
+        s->partFunction = f->partFunction(_part,
+                                          f->file()->partFile(_part),
+                                          f->object()->partObject(_part));
+        s->partStamp = _partStamp;
+    }
+    return s->partFunction;
+}
+
+void MassifLoader::addCost(MassifSite* s,
+                           SubCost heap, SubCost extra, SubCost stacks)
+{
+    SubCost* c = (SubCost*) _pool->allocate(3 * sizeof(SubCost));
+    c[0] = heap;
+    c[1] = extra;
+    c[2] = stacks;
+
+    PositionSpec pos(s->line, s->line, s->addr, s->addr);
+    new (_pool) FixCost(_part, s->source, pos, partFunction(s), 3, c);
+    _costLines++;
+}
+
+void MassifLoader::startSnapshot(int number)
+{
+    finishSnapshot();
+
+    _snapshot = number;
+    _time = QString();
+    _description = QString();
+    _heap = 0;
+    _heapExtra = 0;
+    _stacks = 0;
+    _treeHeap = 0;
+    _inTree = false;
+    _stack.clear();
+
+    _partStamp++;
+    _part = new TracePart(_data);
+    _part->setName(_filename);
+    _part->setPartNumber(number + 1);
+    _part->setEventMapping(_data->eventTypes()->createMapping(
+                               QStringLiteral("Heap HeapExtra Stacks")));
+}
+
+void MassifLoader::finishSnapshot()
+{
+    if (!_part) return;
+
+    // cost not covered by a heap tree
+    SubCost heap = 0;
+    if ((uint64)_heap > (uint64)_treeHeap) heap = _heap - _treeHeap;
+    if (((uint64)heap > 0) || ((uint64)_heapExtra > 0))
+        addCost(_heapSite, heap, _heapExtra, 0);
+    if ((uint64)_stacks > 0)
+        addCost(_stackSite, 0, 0, _stacks);
+
+    _part->setDescription(_partDescription);
+    _part->setTimeframe(QStringLiteral("%1 %2").arg(_time).arg(_timeUnit));
+    _part->setTrigger(QObject::tr("Snapshot %1%2").arg(_snapshot)
+                      .arg(_description));
+
+    _part->invalidate();
+    _part->totals()->clear();
+    _part->totals()->addCost(_part);
+    _data->addPart(_part);
+    partsAdded++;
+
+    _part = nullptr;
+}
+
+// "n<children>: <bytes> <site>", indented by tree depth
+bool MassifLoader::parseTreeLine(FixString& line)
+{
+    int depth = 0;
+    char c;
+    while(line.first(c) && (c == ' ')) {
+        line.stripFirst(c);
+        depth++;
+    }
+
+    uint children;
+    uint64 bytes;
+    if (!line.stripPrefix("n") || !line.stripUInt(children, false) ||
+        !line.stripPrefix(":") || !line.stripUInt64(bytes))
+        return false;
+    line.stripSurroundingSpaces();
+
+    if (depth > _stack.count()) return false;
+    _stack.resize(depth);
+
+    // tree root: allocation functions
+    if (depth == 0) {
+        _stack.append(nullptr);
+        return true;
+    }
+
+    MassifSite* s = site(line);
+    _stack.append(s);
+
+    if (depth == 1) {
+        addCost(s, bytes, 0, 0);
+        _treeHeap += bytes;
+        return true;
+    }
+
+    MassifSite* called = _stack.at(depth-1);
+    TraceCall* call = s->function->calling(called->function);
+    TracePartCall* partCall = call->partCall(_part,
+                                             partFunction(s),
+                                             partFunction(called));
+
+    SubCost* cc = (SubCost*) _pool->allocate(4 * sizeof(SubCost));
+    cc[0] = bytes;
+    cc[1] = 0;
+    cc[2] = 0;
+    cc[3] = 0; // call count
+    FixCallCost* fcc;
+    fcc = new (_pool) FixCallCost(_part, s->source, s->line, s->addr,
+                                  partCall, 3, cc);
+    fcc->setMax(_data->callMax());
+    _callLines++;
+
+    return true;
+}
+
+int MassifLoader::load(TraceData* d, QIODevice* device, const QString& filename)
+{
+    if (!d || !device) return 0;
+
+    _data = d;
+    _filename = filename;
+    _lineNo = 0;
+    _costLines = 0;
+    _callLines = 0;
+    _pool = d->fixPool();
+    _part = nullptr;
+    _partStamp = 0;
+    _timeUnit = QString();
+    _partDescription = QString();
+    partsAdded = 0;
+
+    loadStart(_filename);
+
+    FixFile file(device, _filename);
+    if (!file.exists()) {
+        loadFinished(QStringLiteral("File does not exist"));
+        return 0;
+    }
+
+    if (!EventType::hasKnownRealType(QStringLiteral("Heap")))
+        EventType::add(new EventType(QStringLiteral("Heap"),
+                                     QObject::tr("Heap Bytes")));
+    if (!EventType::hasKnownRealType(QStringLiteral("HeapExtra")))
+        EventType::add(new EventType(QStringLiteral("HeapExtra"),
+                                     QObject::tr("Extra Heap Bytes")));
+    if (!EventType::hasKnownRealType(QStringLiteral("Stacks")))
+        EventType::add(new EventType(QStringLiteral("Stacks"),
+                                     QObject::tr("Stack Bytes")));
+
+    _heapSite = syntheticSite(HEAP_FUNCTION_NAME);
+    _stackSite = syntheticSite(STACK_FUNCTION_NAME);
+
+    int statusProgress = 0;
+    FixString line;
+    char c;
+    uint64 v;
+
+    while (file.nextLine(line)) {
+        _lineNo++;
+
+#if TRACE_LOADER
+        qDebug() << "[MassifLoader] " << _filename << ":" << _lineNo
+                 << " - '" << QString(line) << "'";
+#endif
+
+        if (!line.first(c)) continue;
+
+        if (_inTree) {
+            if ((c == ' ') || (c == 'n')) {
+                if (!parseTreeLine(line))
+                    error(QStringLiteral("Invalid heap tree line '%1'").arg(line));
+                continue;
+            }
+            _inTree = false;
+        }
+
+        if (c == '#') {
+            int progress = (int)(100.0 * file.current() / file.len());
+            if (progress != statusProgress) {
+                statusProgress = progress;
+                loadProgress(statusProgress);
+            }
+            continue;
+        }
+
+        if (line.stripPrefix("snapshot=")) {
+            uint n;
+            if (!line.stripUInt(n)) {
+                error(QStringLiteral("Invalid snapshot number"));
+                n = partsAdded;
+            }
+            startSnapshot(n);
+            continue;
+        }
+        if (line.stripPrefix("desc:")) {
+            line.stripSurroundingSpaces();
+            _partDescription = line;
+            continue;
+        }
+        if (line.stripPrefix("cmd:")) {
+            line.stripSurroundingSpaces();
+            QString command = line;
+            if (!_data->command().isEmpty() && _data->command() != command)
+                error(QStringLiteral("Redefined command, was '%1'").arg(_data->command()));
+            _data->setCommand(command);
+            continue;
+        }
+        if (line.stripPrefix("time_unit:")) {
+            line.stripSurroundingSpaces();
+            _timeUnit = line;
+            continue;
+        }
+
+        if (!_part) {
+            error(QStringLiteral("Data outside of snapshot ('%1')").arg(line));
+            continue;
+        }
+
+        if (line.stripPrefix("time=")) {
+            line.stripSurroundingSpaces();
+            _time = line;
+        }
+        else if (line.stripPrefix("mem_heap_B=")) {
+            if (line.stripUInt64(v)) _heap = v;
+        }
+        else if (line.stripPrefix("mem_heap_extra_B=")) {
+            if (line.stripUInt64(v)) _heapExtra = v;
+        }
+        else if (line.stripPrefix("mem_stacks_B=")) {
+            if (line.stripUInt64(v)) _stacks = v;
+        }
+        else if (line.stripPrefix("heap_tree=")) {
+            line.stripSurroundingSpaces();
+            QString type = line;
+            if (type == QLatin1String("peak"))
+                _description = QObject::tr(" (peak)");
+            else if (type == QLatin1String("detailed"))
+                _description = QObject::tr(" (detailed)");
+            _inTree = (type != QLatin1String("empty"));
+        }
+        else
+            error(QStringLiteral("Unknown line '%1'").arg(line));
+    }
+    finishSnapshot();
+
+    if (partsAdded == 0)
+        error(QStringLiteral("No snapshots found. Skipping file"));
+
+    if (_stats) {
+        _stats->addLines(_lineNo);
+        _stats->addLines(LoadStatistics::CostLine, _costLines);
+        _stats->addLines(LoadStatistics::CallLine, _callLines);
+    }
+
+    loadFinished();
+
+    qDeleteAll(_sites);
+    _sites.clear();
+    delete _heapSite;
+    delete _stackSite;
+    _heapSite = nullptr;
+    _stackSite = nullptr;
+
+    device->close();
+
+    return partsAdded;
+}
+
+
+Loader* createMassifLoader()
+{
+    return new MassifLoader();
+}
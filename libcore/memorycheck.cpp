@@ -0,0 +1,360 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Memory usage check for loading generated profiles
+ */
+
+#include "memorycheck.h"
+
+#include <algorithm>
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "coverage.h"
+#include "loadstats.h"
+#include "logger.h"
+#include "pool.h"
+#include "tracedata.h"
+
+// measured with generated profiles, with some headroom
+const double MemoryCheck::MaxBytesPerInputByte = 48.0;
+const double MemoryCheck::MaxBytesPerCostLine = 160.0;
+
+
+//---------------------------------------------------
+// MemoryUsage
+
+MemoryUsage::MemoryUsage()
+{
+    functions = 0;
+    inputBytes = 0;
+    costLines = 0;
+    baseRss = peakRss = 0;
+    fixPoolSize = fixPoolCapacity = dynPoolSize = 0;
+    loadTime = 0;
+}
+
+double MemoryUsage::bytesPerInputByte() const
+{
+    if ((inputBytes == 0) || (peakRss == 0)) return 0.0;
+    return (double)(peakRss - baseRss) / inputBytes;
+}
+
+double MemoryUsage::bytesPerCostLine() const
+{
+    if (costLines == 0) return 0.0;
+    return (double)(fixPoolSize + dynPoolSize) / costLines;
+}
+
+
+//---------------------------------------------------
+// Profile generation
+
+/* Deterministic random numbers, independent from qrand() state */
+class ProfileRandom
+{
+public:
+    ProfileRandom() { _state = 12345; }
+
+    // in [0, n[
+    int next(int n)
+    {
+        _state = _state * 1103515245 + 12345;
+        return (int)((_state >> 16) % (quint32)n);
+    }
+
+private:
+    quint32 _state;
+};
+
+/* Writes "<key>=(<id>)", followed by the name on first use */
+static void writeName(QTextStream& s, const char* key, const char* prefix,
+                      int id, QVector<bool>& named)
+{
+    s << key << "=(" << id+1 << ")";
+    if (!named[id]) {
+        s << ' ' << prefix << id;
+        named[id] = true;
+    }
+    s << '\n';
+}
+
+static QString instrAddr(int function, int offset)
+{
+    return QStringLiteral("0x") +
+        QString::number(0x400000 + function * 0x400 + offset * 4, 16);
+}
+
+void MemoryCheck::generateProfile(QIODevice* dev, int functions)
+{
+    QTextStream s(dev);
+    ProfileRandom random;
+
+    int files = (functions + FunctionsPerFile - 1) / FunctionsPerFile;
+    int objects = (functions + FunctionsPerObject - 1) / FunctionsPerObject;
+    QVector<bool> fnNamed(functions, false);
+    QVector<bool> flNamed(files, false);
+    QVector<bool> obNamed(objects, false);
+
+    s << "version: 1\n"
+      << "creator: kcachegrind memory check\n"
+      << "positions: instr line\n"
+      << "events: Ir Dr Dw\n\n";
+
+    // calls are made every <callDistance> cost lines
+    int callDistance = CostLinesPerFunction / (CallsPerFunction + 1);
+
+    for(int f=0; f<functions; f++) {
+        int file = f / FunctionsPerFile;
+        int object = f / FunctionsPerObject;
+        int firstLine = (f % FunctionsPerFile) * 100 + 1;
+
+        writeName(s, "ob", "libmemcheck", object, obNamed);
+        writeName(s, "fl", "file", file, flNamed);
+        writeName(s, "fn", "function", f, fnNamed);
+
+        for(int i=0; i<CostLinesPerFunction; i++) {
+            int ir = 1 + random.next(1000);
+            s << instrAddr(f, i) << ' ' << firstLine + i/2 << ' '
+              << ir << ' ' << random.next(ir) << ' '
+              << random.next(ir/2 + 1) << '\n';
+
+            // only calls to functions with higher index: no cycles
+            if ((i % callDistance) != callDistance-1) continue;
+            if (f+1 >= functions) continue;
+            int g = f + 1 + random.next(functions - f - 1);
+            int gFile = g / FunctionsPerFile;
+            int gObject = g / FunctionsPerObject;
+
+            if (gObject != object)
+                writeName(s, "cob", "libmemcheck", gObject, obNamed);
+            if (gFile != file)
+                writeName(s, "cfi", "file", gFile, flNamed);
+            writeName(s, "cfn", "function", g, fnNamed);
+            s << "calls=" << 1 + random.next(100) << ' '
+              << instrAddr(g, 0) << ' '
+              << (g % FunctionsPerFile) * 100 + 1 << '\n';
+            s << instrAddr(f, i) << ' ' << firstLine + i/2 << ' '
+              << 1000 + random.next(100000) << " 0 0\n";
+        }
+        s << '\n';
+    }
+    s.flush();
+}
+
+
+//---------------------------------------------------
+// Process memory
+
+#ifdef Q_OS_LINUX
+/* Value of a field in /proc/self/status, in bytes */
+static qint64 procStatus(const char* field)
+{
+    QFile f(QStringLiteral("/proc/self/status"));
+    if (!f.open(QIODevice::ReadOnly)) return 0;
+
+    QByteArray prefix(field);
+    prefix += ':';
+    while(!f.atEnd()) {
+        QByteArray line = f.readLine();
+        if (!line.startsWith(prefix)) continue;
+        // in kB
+        QByteArray value = line.mid(prefix.size()).trimmed();
+        int space = value.indexOf(' ');
+        if (space > 0) value.truncate(space);
+        return value.toLongLong() * 1024;
+    }
+    return 0;
+}
+#endif
+
+qint64 MemoryCheck::residentSize()
+{
+#ifdef Q_OS_LINUX
+    return procStatus("VmRSS");
+#else
+    return 0;
+#endif
+}
+
+qint64 MemoryCheck::peakResidentSize()
+{
+#ifdef Q_OS_LINUX
+    return procStatus("VmHWM");
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss;
+#else
+    return (qint64) usage.ru_maxrss * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+bool MemoryCheck::resetPeak()
+{
+#ifdef Q_OS_LINUX
+    // resets VmHWM to current RSS (since Linux 4.0)
+    QFile f(QStringLiteral("/proc/self/clear_refs"));
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    return f.write("5") == 1;
+#else
+    return false;
+#endif
+}
+
+
+//---------------------------------------------------
+// MemoryCheck
+
+MemoryCheck::MemoryCheck()
+{
+    _steps = 4;
+    _functions = 1000;
+    _topFunctions = 20;
+}
+
+class InclusiveGreater
+{
+public:
+    explicit InclusiveGreater(EventType* t) { _type = t; }
+
+    bool operator()(TraceFunction* f1, TraceFunction* f2) const
+    {
+        return f1->inclusive()->subCost(_type) >
+            f2->inclusive()->subCost(_type);
+    }
+
+private:
+    EventType* _type;
+};
+
+/* Logger only reporting errors: loading is done many times */
+class MemoryCheckLogger: public Logger
+{
+public:
+    void loadStart(const QString& filename) override
+    { _filename = filename; }
+    void loadProgress(int) override {}
+    void loadWarning(int, const QString&) override {}
+    void loadFinished(const QString& msg) override
+    {
+        if (!msg.isEmpty())
+            Logger::loadFinished(msg);
+    }
+};
+
+MemoryUsage MemoryCheck::measure(int functions)
+{
+    MemoryUsage u;
+    u.functions = functions;
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    generateProfile(&buffer, functions);
+    buffer.close();
+    u.inputBytes = buffer.size();
+
+    // the generated profile itself is part of the base
+    resetPeak();
+    u.baseRss = residentSize();
+    if (u.baseRss == 0) u.baseRss = peakResidentSize();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    MemoryCheckLogger logger;
+    TraceData* d = new TraceData(&logger);
+    if (d->load(&buffer, QStringLiteral("memcheck.out")) == 0) {
+        delete d;
+        return u;
+    }
+
+    // materialize like the views do for the hottest functions
+    EventType* t = d->eventTypes()->realType(0);
+    QVector<TraceFunction*> list;
+    TraceFunctionMap::Iterator it;
+    for(it = d->functionMap().begin(); it != d->functionMap().end(); ++it)
+        list.append(&(*it));
+    std::sort(list.begin(), list.end(), InclusiveGreater(t));
+    if (list.count() > _topFunctions) list.resize(_topFunctions);
+
+    foreach(TraceFunction* f, list) {
+        f->instrMap();
+        foreach(TraceFunctionSource* src, f->sourceFiles())
+            src->lineMap();
+        Coverage::coverage(f, Coverage::Caller, t);
+        Coverage::coverage(f, Coverage::Called, t);
+    }
+    u.loadTime = timer.elapsed();
+
+    u.peakRss = peakResidentSize();
+    u.fixPoolSize = d->fixPool()->size();
+    u.fixPoolCapacity = d->fixPool()->capacity();
+    u.dynPoolSize = d->dynPool()->used();
+    LoadStatistics* stats = d->loadStatistics();
+    for(int i=0; i<LoadStatistics::LineTypeCount; i++)
+        u.costLines += stats->lines((LoadStatistics::LineType) i);
+
+    delete d;
+    return u;
+}
+
+bool MemoryCheck::run()
+{
+    _usage.clear();
+    _failures.clear();
+
+    int functions = _functions;
+    for(int step=0; step<_steps; step++, functions *= 2) {
+        MemoryUsage u = measure(functions);
+        _usage.append(u);
+
+        if (u.costLines == 0) {
+            _failures << QStringLiteral("%1 functions: profile not loaded")
+                         .arg(functions);
+            continue;
+        }
+        if (u.bytesPerInputByte() > MaxBytesPerInputByte)
+            _failures << QStringLiteral("%1 functions: %2 bytes per input byte "
+                                        "(budget %3)")
+                         .arg(functions)
+                         .arg(u.bytesPerInputByte(), 0, 'f', 1)
+                         .arg(MaxBytesPerInputByte);
+        if (u.bytesPerCostLine() > MaxBytesPerCostLine)
+            _failures << QStringLiteral("%1 functions: %2 bytes per cost line "
+                                        "(budget %3)")
+                         .arg(functions)
+                         .arg(u.bytesPerCostLine(), 0, 'f', 1)
+                         .arg(MaxBytesPerCostLine);
+    }
+
+    return _failures.isEmpty();
+}
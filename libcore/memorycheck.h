@@ -0,0 +1,114 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Memory usage check for loading generated profiles
+ */
+
+#ifndef MEMORYCHECK_H
+#define MEMORYCHECK_H
+
+#include <QList>
+#include <QStringList>
+#include <QtGlobal>
+
+class QIODevice;
+
+/**
+ * Memory used for loading one generated profile and materializing
+ * the data needed by typical views.
+ */
+class MemoryUsage
+{
+public:
+    MemoryUsage();
+
+    int functions;
+    qint64 inputBytes;
+    // lines with cost data (cost, call and jump lines)
+    qint64 costLines;
+    // resident set size of the process before loading, and its peak
+    // while loading and materializing. 0 if not available
+    qint64 baseRss, peakRss;
+    // bytes allocated from the pools of the TraceData
+    quint64 fixPoolSize, fixPoolCapacity, dynPoolSize;
+    qint64 loadTime;
+
+    // growth of peak RSS per byte of the profile file
+    double bytesPerInputByte() const;
+    // pool space per cost line
+    double bytesPerCostLine() const;
+};
+
+/**
+ * Regression check for memory usage of large profile loads.
+ *
+ * Profiles of increasing size are generated in memory, loaded via
+ * TraceData::load() and fully materialized: instruction and source
+ * line maps plus coverage of the functions with highest inclusive
+ * cost. Peak RSS and pool usage are compared against the budgets
+ * below. Raising a budget is a reviewed change to this file.
+ * The check runs as test "cgview-memcheck" (cgview --memcheck 4).
+ */
+class MemoryCheck
+{
+public:
+    // peak RSS growth per input byte
+    static const double MaxBytesPerInputByte;
+    // FixPool/DynPool bytes per cost line
+    static const double MaxBytesPerCostLine;
+
+    enum { CostLinesPerFunction = 48, CallsPerFunction = 3,
+           FunctionsPerFile = 20, FunctionsPerObject = 500 };
+
+    MemoryCheck();
+
+    // number of profiles, starting with <functions> and doubling
+    void setSteps(int s) { _steps = s; }
+    void setFunctions(int n) { _functions = n; }
+    // functions materialized like a view does
+    void setTopFunctions(int n) { _topFunctions = n; }
+
+    // returns false if any budget is exceeded
+    bool run();
+    const QList<MemoryUsage>& usage() const { return _usage; }
+    // budget violations of last run(), human readable
+    QStringList failures() const { return _failures; }
+
+    /**
+     * Writes a callgrind profile with <functions> functions to <dev>.
+     * The call graph is acyclic, and the output is the same for
+     * the same parameters.
+     */
+    static void generateProfile(QIODevice* dev, int functions);
+
+    // memory usage of this process in bytes, 0 if unknown
+    static qint64 residentSize();
+    static qint64 peakResidentSize();
+    // restart peak measurement. Returns false if not supported
+    static bool resetPeak();
+
+private:
+    MemoryUsage measure(int functions);
+
+    int _steps, _functions, _topFunctions;
+    QList<MemoryUsage> _usage;
+    QStringList _failures;
+};
+
+#endif
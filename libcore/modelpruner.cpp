@@ -0,0 +1,408 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Pruning of profile data below a cost threshold
+ */
+
+#include "modelpruner.h"
+
+#include <string.h>
+
+#include <QList>
+
+#include "tracedata.h"
+#include "fixcost.h"
+#include "parallel.h"
+#include "utils.h"
+
+// name of synthetic functions holding the cost of pruned functions
+#define PRUNED_FUNCTION_NAME "(other)"
+
+
+//---------------------------------------------------
+// PruneInclusiveJob
+
+/* A cost summed up in Scan mode, with the part it is from */
+struct PruneEntry
+{
+    TracePart* part;
+    // called function, nullptr for exclusive cost
+    TraceFunction* to;
+    const QVector<SubCost>* cost;
+};
+
+typedef QHash<TraceFunction*, QVector<SubCost> > PruneCallTotals;
+
+// add <count> counters in event type mapping order to real type costs
+static void addReal(SubCost* to, EventTypeMapping* m,
+                    const SubCost* c, int count)
+{
+    for(int k=0; k<count; k++) {
+        int r = m->realIndex(k);
+        if (r == ProfileCostArray::InvalidIndex) continue;
+        to[r] += c[k];
+    }
+}
+
+/*
+ * Calculates exclusive and inclusive cost per function, and the
+ * cost of each call, indexed by real event type. Uses the costs
+ * summed up in Scan mode, and FixCost data of loaders without
+ * Scan mode support.
+ * The TraceData cost accessors are not used: they do lazy updates
+ * and are not allowed to be called from a ParallelJob.
+ */
+class PruneInclusiveJob: public ParallelJob
+{
+public:
+    PruneInclusiveJob(const QVector<TraceFunction*>& functions,
+                      const QVector<QList<PruneEntry> >& entries,
+                      int realCount)
+        : _functions(functions), _entries(entries), _realCount(realCount),
+          inclusive(functions.count() * realCount, SubCost(0)),
+          totals(workers() * realCount, SubCost(0)),
+          calls(functions.count())
+    {
+        // raw pointers: no implicit sharing checks in worker threads
+        _inclusive = inclusive.data();
+        _totals = totals.data();
+        _calls = calls.data();
+    }
+
+    void run(int from, int to, int worker) override
+    {
+        SubCost* total = _totals + worker * _realCount;
+
+        for(int i=from; i<to; i++) {
+            TraceFunction* f = _functions.at(i);
+            SubCost* incl = _inclusive + i * _realCount;
+            PruneCallTotals& calls = _calls[i];
+
+            foreach(const PruneEntry& e, _entries.at(i)) {
+                EventTypeMapping* m = e.part->eventTypeMapping();
+                if (!e.to)
+                    addReal(incl, m, e.cost->constData(), m->count());
+                else if (e.to != f)
+                    addReal(callCost(calls, e.to), m,
+                            e.cost->constData(), m->count());
+            }
+
+            foreach(TraceInclusiveCost* ic, f->deps()) {
+                TracePartFunction* pf = (TracePartFunction*) ic;
+                FixCost* fc = pf->firstFixCost();
+                for(; fc; fc = fc->nextCostOfPartFunction())
+                    fc->addTo(incl);
+
+                EventTypeMapping* m = pf->part()->eventTypeMapping();
+                foreach(TracePartCall* pc, pf->partCallings()) {
+                    TraceFunction* called = pc->call()->called();
+                    if (called == f) continue;
+                    FixCallCost* fcc = pc->firstFixCallCost();
+                    for(; fcc; fcc = fcc->nextCostOfPartCall())
+                        addReal(callCost(calls, called), m,
+                                fcc->costs(), fcc->costCount());
+                }
+            }
+
+            for(int e=0; e<_realCount; e++)
+                total[e] += incl[e];
+
+            PruneCallTotals::const_iterator it;
+            for(it = calls.constBegin(); it != calls.constEnd(); ++it)
+                for(int e=0; e<_realCount; e++)
+                    incl[e] += it.value().at(e);
+        }
+    }
+
+private:
+    SubCost* callCost(PruneCallTotals& calls, TraceFunction* called)
+    {
+        QVector<SubCost>& v = calls[called];
+        if (v.isEmpty()) v.fill(SubCost(0), _realCount);
+        return v.data();
+    }
+
+    const QVector<TraceFunction*>& _functions;
+    const QVector<QList<PruneEntry> >& _entries;
+    int _realCount;
+    SubCost *_inclusive, *_totals;
+    PruneCallTotals* _calls;
+
+public:
+    QVector<SubCost> inclusive;
+    // workers() rows of exclusive cost totals
+    QVector<SubCost> totals;
+    // cost of calls of each function, by called function
+    QVector<PruneCallTotals> calls;
+};
+
+
+//---------------------------------------------------
+// ModelPruner
+
+ModelPruner::ModelPruner(double threshold)
+{
+    _threshold = threshold;
+    _mode = Scan;
+    _lastPart = nullptr;
+    _lastCosts = nullptr;
+}
+
+ModelPruner::~ModelPruner()
+{
+    qDeleteAll(_costs);
+}
+
+// same key as used by TraceData::function()
+static QString functionKey(TraceFunction* f)
+{
+    return f->name() + f->file()->shortName() + f->object()->shortName();
+}
+
+// true if <cost> reaches <threshold> percent of <totals> for any type
+static bool reachesThreshold(const SubCost* cost, const SubCost* totals,
+                             int realCount, double threshold)
+{
+    // event types without any cost (e.g. unused counters) do not
+    // count: every function would reach their threshold
+    bool hasTotal = false;
+    for(int e=0; e<realCount; e++) {
+        if (totals[e] == 0) continue;
+        hasTotal = true;
+        if ((double)cost[e] * 100.0 >= threshold * (double)totals[e])
+            return true;
+    }
+    return !hasTotal;
+}
+
+void ModelPruner::decide(TraceData* d)
+{
+    int realCount = d->eventTypes()->realCount();
+
+    QVector<TraceFunction*> functions;
+    QHash<TraceFunction*, int> functionIndex;
+    TraceFunctionMap::Iterator it;
+    for (it = d->functionMap().begin(); it != d->functionMap().end(); ++it) {
+        functionIndex.insert(&(*it), functions.count());
+        functions.append(&(*it));
+    }
+    int fCount = functions.count();
+
+    // costs summed up while scanning, grouped by function
+    QVector<QList<PruneEntry> > entries(fCount);
+    QHash<TracePart*, PruneCostMap*>::const_iterator pit;
+    for(pit = _costs.constBegin(); pit != _costs.constEnd(); ++pit) {
+        PruneCostMap::const_iterator mit;
+        for(mit = pit.value()->constBegin();
+            mit != pit.value()->constEnd(); ++mit) {
+            PruneEntry e;
+            e.part = pit.key();
+            e.to = mit.key().second;
+            e.cost = &mit.value();
+            entries[functionIndex.value(mit.key().first)].append(e);
+        }
+    }
+
+    PruneInclusiveJob job(functions, entries, realCount);
+    Parallel::run(&job, fCount);
+
+    QVector<SubCost> totals = job.totals;
+    for(int w=1; w<job.workers(); w++)
+        for(int e=0; e<realCount; e++)
+            totals[e] += totals[w * realCount + e];
+
+    // keep functions reaching the threshold for at least one event type
+    QVector<int> id(fCount, 0);
+    for(int i=0; i<fCount; i++) {
+        QString key = functionKey(functions.at(i));
+        if (reachesThreshold(job.inclusive.constData() + i * realCount,
+                             totals.constData(), realCount, _threshold)) {
+            id[i] = _keptId.count() + 1;
+            _keptId.insert(key, id[i]);
+        }
+        else
+            _pruned.insert(key);
+    }
+
+    // calls between kept functions below the threshold
+    for(int i=0; i<fCount; i++) {
+        if (!id.at(i)) continue;
+        PruneCallTotals::const_iterator cit;
+        for(cit = job.calls.at(i).constBegin();
+            cit != job.calls.at(i).constEnd(); ++cit) {
+            int to = id.at(functionIndex.value(cit.key()));
+            if (!to) continue;
+            if (reachesThreshold(cit.value().constData(), totals.constData(),
+                                 realCount, _threshold)) continue;
+            _smallCalls.insert(((quint64)id.at(i) << 32) | (quint64)to);
+        }
+    }
+
+    if (0) qDebug("ModelPruner: %d of %d functions, %d calls below %f%%",
+                  _pruned.count(), fCount, _smallCalls.count(), _threshold);
+
+    qDeleteAll(_costs);
+    _costs.clear();
+    _lastPart = nullptr;
+    _lastCosts = nullptr;
+    _mode = Prune;
+}
+
+TraceFunction* ModelPruner::other(TraceData* d, TraceObject* object)
+{
+    TraceFunction* f = _other.value(object);
+    if (!f) {
+        f = d->function(QStringLiteral(PRUNED_FUNCTION_NAME),
+                        d->file(QString()), object);
+        _other.insert(object, f);
+        _others.insert(f);
+    }
+    return f;
+}
+
+TraceFunction* ModelPruner::fold(TraceData* d, const QString& key,
+                                 TraceObject* object)
+{
+    if ((_mode != Prune) || !_pruned.contains(key)) return nullptr;
+    return other(d, object);
+}
+
+void ModelPruner::added(TraceFunction* f, const QString& key)
+{
+    if ((_mode != Prune) || _smallCalls.isEmpty()) return;
+
+    int id = _keptId.value(key);
+    if (id) _id.insert(f, id);
+}
+
+bool ModelPruner::isSmallCall(TraceFunction* caller,
+                              TraceFunction* called) const
+{
+    if (_smallCalls.isEmpty()) return false;
+
+    quint64 from = _id.value(caller);
+    quint64 to = _id.value(called);
+    if (!from || !to) return false;
+    return _smallCalls.contains((from << 32) | to);
+}
+
+void ModelPruner::add(TracePart* part, const PruneKey& key,
+                      FixString& s, SubCost callCount)
+{
+    if (part != _lastPart) {
+        PruneCostMap*& costs = _costs[part];
+        if (!costs) costs = new PruneCostMap;
+        _lastPart = part;
+        _lastCosts = costs;
+    }
+
+    int count = part->eventTypeMapping()->count();
+    QVector<SubCost>& v = (*_lastCosts)[key];
+    if (v.isEmpty()) v.fill(SubCost(0), key.second ? count+1 : count);
+    SubCost* c = v.data();
+
+    SubCost value;
+    s.stripSpaces();
+    for(int i=0; i<count; i++) {
+        if (!s.stripUInt64(value)) break;
+        c[i] += value;
+    }
+    if (key.second) c[count] += callCount;
+}
+
+bool ModelPruner::addCost(TracePart* part, TraceFunction* f, FixString& s)
+{
+    if ((_mode == Prune) && !_others.contains(f)) return false;
+
+    add(part, PruneKey(f, nullptr), s, 0);
+    return true;
+}
+
+bool ModelPruner::addCallCost(TracePart* part, TraceFunction* caller,
+                              TraceFunction* called, SubCost callCount,
+                              FixString& s)
+{
+    if (_mode == Prune) {
+        if (_others.contains(caller)) {
+            // calls among pruned functions of same object vanish
+            if (called == caller) return true;
+        }
+        else if (isSmallCall(caller, called))
+            called = other(caller->data(), called->object());
+        else
+            return false;
+    }
+
+    add(part, PruneKey(caller, called), s, callCount);
+    return true;
+}
+
+bool ModelPruner::skipJump(TraceFunction* from, TraceFunction* to) const
+{
+    if (_mode == Scan) return true;
+    return _others.contains(from) || _others.contains(to);
+}
+
+void ModelPruner::flush(TracePart* part)
+{
+    if (_mode != Prune) return;
+
+    PruneCostMap* costs = _costs.take(part);
+    _lastPart = nullptr;
+    _lastCosts = nullptr;
+    if (!costs) return;
+
+    TraceData* d = part->data();
+    FixPool* pool = d->fixPool();
+    int count = part->eventTypeMapping()->count();
+
+    PruneCostMap::const_iterator it;
+    for(it = costs->constBegin(); it != costs->constEnd(); ++it) {
+        TraceFunction* from = it.key().first;
+        TraceFunction* to = it.key().second;
+        TracePartFunction* pf = from->partFunction(part,
+                                                   from->file()->partFile(part),
+                                                   from->object()->partObject(part));
+        // pruned functions only have one source without line information
+        TraceFunctionSource* source = from->sourceFile(nullptr, true);
+
+        int size = to ? count+1 : count;
+        SubCost* c = (SubCost*) pool->allocate(sizeof(SubCost) * size);
+        memcpy(c, it.value().constData(), sizeof(SubCost) * size);
+
+        if (!to) {
+            PositionSpec pos;
+            new (pool) FixCost(part, source, pos, pf, count, c);
+            continue;
+        }
+
+        TracePartFunction* calledPF;
+        calledPF = to->partFunction(part,
+                                    to->file()->partFile(part),
+                                    to->object()->partObject(part));
+        TraceCall* call = from->calling(to);
+        TracePartCall* partCall = call->partCall(part, pf, calledPF);
+        FixCallCost* fcc;
+        fcc = new (pool) FixCallCost(part, source, 0, Addr(0), partCall,
+                                     count, c);
+        fcc->setMax(d->callMax());
+        d->updateMaxCallCount(fcc->callCount());
+    }
+    delete costs;
+}
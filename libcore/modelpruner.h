@@ -0,0 +1,130 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Pruning of profile data below a cost threshold
+ */
+
+#ifndef MODELPRUNER_H
+#define MODELPRUNER_H
+
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "subcost.h"
+
+class TraceData;
+class TracePart;
+class TraceObject;
+class TraceFunction;
+class FixString;
+
+// node pair of a call, or function with nullptr for exclusive cost
+typedef QPair<TraceFunction*, TraceFunction*> PruneKey;
+// counters in event type mapping order of a part, call count appended
+typedef QHash<PruneKey, QVector<SubCost> > PruneCostMap;
+
+/**
+ * Folds functions with small inclusive cost into one synthetic
+ * "(other)" function per ELF object, while loading.
+ *
+ * A function is kept if its inclusive cost is at or above <threshold>
+ * percent of the total cost for at least one event type. Calls between
+ * kept functions below the threshold are folded into a call to the
+ * "(other)" function of the called object. Totals and the inclusive
+ * cost of kept functions do not change. The inclusive cost of an
+ * "(other)" function does not contain folded small calls, as this
+ * cost stays with the kept called function.
+ *
+ * Loading is done twice, see TraceData::load():
+ * - In Scan mode, loaders pass all cost lines to addCost() and
+ *   addCallCost(), which only sum them up per function and call.
+ *   No FixCost items are created. decide() calculates inclusive costs
+ *   in parallel (see Parallel), and switches to Prune mode.
+ * - In Prune mode, TraceData::function() returns the "(other)"
+ *   function for pruned functions. Loaders still pass each cost line,
+ *   and get back whether it was taken over: cost of "(other)" and of
+ *   small calls is summed up, and added as one FixCost item per part
+ *   and node (pair) by flush(). Thus, no detailed cost data of pruned
+ *   functions is allocated.
+ *
+ * Loaders not supporting this create FixCost items in both passes:
+ * these are included in decide(), and folded via TraceData::function().
+ */
+class ModelPruner
+{
+public:
+    enum Mode { Scan, Prune };
+
+    explicit ModelPruner(double threshold);
+    ~ModelPruner();
+
+    Mode mode() const { return _mode; }
+    double threshold() const { return _threshold; }
+    // number of functions folded into "(other)", valid after decide()
+    int prunedCount() const { return _pruned.count(); }
+    int smallCallCount() const { return _smallCalls.count(); }
+
+    // decide from the data loaded in Scan mode, and switch to Prune mode
+    void decide(TraceData* scanned);
+
+    // for TraceData::function(): "(other)" function if <key> is pruned
+    TraceFunction* fold(TraceData*, const QString& key, TraceObject*);
+    // for TraceData::function(): function created for <key>
+    void added(TraceFunction*, const QString& key);
+
+    /* For loaders: returns true if the cost in <s> was taken over,
+     * and no FixCost item should be created. */
+    bool addCost(TracePart*, TraceFunction*, FixString& s);
+    bool addCallCost(TracePart*, TraceFunction* caller,
+                     TraceFunction* called, SubCost callCount,
+                     FixString& s);
+    // true if jump data should be skipped
+    bool skipJump(TraceFunction* from, TraceFunction* to) const;
+    bool isOther(TraceFunction* f) const { return _others.contains(f); }
+    // add costs taken over for <part>, before its totals are calculated
+    void flush(TracePart*);
+
+private:
+    void add(TracePart*, const PruneKey&, FixString&, SubCost callCount);
+    TraceFunction* other(TraceData*, TraceObject*);
+    bool isSmallCall(TraceFunction* caller, TraceFunction* called) const;
+
+    double _threshold;
+    Mode _mode;
+
+    // costs taken over, per part
+    QHash<TracePart*, PruneCostMap*> _costs;
+    TracePart* _lastPart;
+    PruneCostMap* _lastCosts;
+
+    // decisions from Scan mode, by key of TraceData::function()
+    QSet<QString> _pruned;
+    QHash<QString, int> _keptId;
+    QSet<quint64> _smallCalls;
+
+    // Prune mode: ids of kept functions, "(other)" functions
+    QHash<TraceFunction*, int> _id;
+    QHash<TraceObject*, TraceFunction*> _other;
+    QSet<TraceFunction*> _others;
+};
+
+#endif
@@ -0,0 +1,358 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Data parallel passes over the profile data model
+ */
+
+#include "parallel.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+
+//---------------------------------------------------
+// ParallelJob, ParallelTask, ParallelObserver
+
+ParallelJob::ParallelJob()
+{
+    _workers = Parallel::workerCount();
+}
+
+ParallelJob::~ParallelJob()
+{}
+
+ParallelTask::~ParallelTask()
+{}
+
+ParallelObserver::~ParallelObserver()
+{}
+
+void ParallelObserver::jobStarted(ParallelJob*, int, int)
+{}
+
+void ParallelObserver::chunkFinished(ParallelJob*, int, int, int, qint64)
+{}
+
+void ParallelObserver::jobFinished(ParallelJob*, qint64)
+{}
+
+void ParallelObserver::taskFinished(ParallelTask*, qint64)
+{}
+
+
+//---------------------------------------------------
+// Scheduler state
+
+Q_GLOBAL_STATIC(QThreadPool, parallelPool)
+
+static QAtomicInt configuredWorkers(0);
+static QAtomicPointer<ParallelObserver> parallelObserver(nullptr);
+
+// worker count from environment, 0 if not set
+static int environmentWorkers()
+{
+    static const int n = qgetenv("KCACHEGRIND_THREADS").toInt();
+    return n;
+}
+
+static QThreadPool* pool()
+{
+    QThreadPool* p = parallelPool();
+    // nested jobs may need more threads than one job
+    int max = 2 * Parallel::workerCount();
+    if (p->maxThreadCount() != max)
+        p->setMaxThreadCount(max);
+    return p;
+}
+
+
+//---------------------------------------------------
+// ParallelRun
+
+/*
+ * Shared state of one Parallel::run() call.
+ * Helpers may start after the caller returned, when all chunks were
+ * done by others: the state therefore lives until the last reference
+ * is released, and a helper only accesses the job if it got a chunk.
+ */
+class ParallelRun
+{
+public:
+    ParallelRun(ParallelJob* job, int count, int chunkSize,
+                ParallelCancel* cancel, int refs)
+        : next(0), ref(refs)
+    {
+        _job = job;
+        _count = count;
+        _chunkSize = chunkSize;
+        _cancel = cancel;
+        _observer = Parallel::observer();
+    }
+
+    // runs chunks until all are taken, returns number of chunks taken
+    int work(int worker)
+    {
+        int chunks = 0;
+        QElapsedTimer timer;
+        while(1) {
+            int from = next.fetchAndAddOrdered(_chunkSize);
+            if (from >= _count) break;
+            chunks++;
+            if (_cancel && _cancel->isCanceled()) continue;
+
+            int to = from + _chunkSize;
+            if (to > _count) to = _count;
+            if (_observer) timer.start();
+            _job->run(from, to, worker);
+            if (_observer)
+                _observer->chunkFinished(_job, worker, from, to,
+                                         timer.nsecsElapsed());
+        }
+        return chunks;
+    }
+
+    void release()
+    {
+        if (!ref.deref()) delete this;
+    }
+
+    QAtomicInt next, ref;
+    // released by helpers for each chunk done
+    QSemaphore done;
+
+private:
+    ParallelJob* _job;
+    int _count, _chunkSize;
+    ParallelCancel* _cancel;
+    ParallelObserver* _observer;
+};
+
+class ParallelRunner: public QRunnable
+{
+public:
+    ParallelRunner(ParallelRun* run, int worker)
+    {
+        _run = run;
+        _worker = worker;
+    }
+
+    void run() override
+    {
+        int chunks = _run->work(_worker);
+        if (chunks > 0) _run->done.release(chunks);
+        _run->release();
+    }
+
+private:
+    ParallelRun* _run;
+    int _worker;
+};
+
+
+//---------------------------------------------------
+// ParallelGroupState
+
+/*
+ * Shared state of a task group: a queue of pending tasks, taken from
+ * the front by workers and from the back by a waiting thread.
+ */
+class ParallelGroupState
+{
+public:
+    ParallelGroupState(ParallelCancel* c)
+        : ref(1)
+    {
+        cancel = c;
+        unfinished = 0;
+    }
+
+    // runs one pending task, returns false if there is none
+    bool runOne(bool fromBack)
+    {
+        ParallelTask* task;
+        {
+            QMutexLocker locker(&mutex);
+            if (queue.isEmpty()) return false;
+            task = fromBack ? queue.takeLast() : queue.takeFirst();
+        }
+
+        if (!cancel || !cancel->isCanceled()) {
+            ParallelObserver* observer = Parallel::observer();
+            QElapsedTimer timer;
+            if (observer) timer.start();
+            task->run();
+            if (observer)
+                observer->taskFinished(task, timer.nsecsElapsed());
+        }
+
+        QMutexLocker locker(&mutex);
+        unfinished--;
+        if (unfinished == 0) finished.wakeAll();
+        return true;
+    }
+
+    void release()
+    {
+        if (!ref.deref()) delete this;
+    }
+
+    QAtomicInt ref;
+    QMutex mutex;
+    QWaitCondition finished;
+    QList<ParallelTask*> queue;
+    int unfinished;
+    ParallelCancel* cancel;
+};
+
+class ParallelGroupRunner: public QRunnable
+{
+public:
+    explicit ParallelGroupRunner(ParallelGroupState* state)
+    {
+        _state = state;
+    }
+
+    void run() override
+    {
+        _state->runOne(false);
+        _state->release();
+    }
+
+private:
+    ParallelGroupState* _state;
+};
+
+
+//---------------------------------------------------
+// ParallelTaskGroup
+
+ParallelTaskGroup::ParallelTaskGroup(ParallelCancel* cancel)
+{
+    _state = new ParallelGroupState(cancel);
+}
+
+ParallelTaskGroup::~ParallelTaskGroup()
+{
+    wait();
+    _state->release();
+}
+
+void ParallelTaskGroup::add(ParallelTask* task)
+{
+    if (!task) return;
+
+    {
+        QMutexLocker locker(&_state->mutex);
+        _state->queue.append(task);
+        _state->unfinished++;
+    }
+
+    // one runner per task: it may find the task already taken
+    _state->ref.ref();
+    ParallelGroupRunner* r = new ParallelGroupRunner(_state);
+    r->setAutoDelete(true);
+    pool()->start(r);
+}
+
+bool ParallelTaskGroup::wait()
+{
+    // work on pending tasks, newest first
+    while(_state->runOne(true)) {}
+
+    QMutexLocker locker(&_state->mutex);
+    while(_state->unfinished > 0)
+        _state->finished.wait(&_state->mutex);
+
+    return !(_state->cancel && _state->cancel->isCanceled());
+}
+
+
+//---------------------------------------------------
+// Parallel
+
+int Parallel::workerCount()
+{
+    int c = environmentWorkers();
+    if (c < 1) c = configuredWorkers.loadAcquire();
+    if (c < 1) c = QThread::idealThreadCount();
+    return (c < 1) ? 1 : c;
+}
+
+void Parallel::setWorkerCount(int c)
+{
+    configuredWorkers.storeRelease((c < 0) ? 0 : c);
+}
+
+void Parallel::setObserver(ParallelObserver* o)
+{
+    parallelObserver.storeRelease(o);
+}
+
+ParallelObserver* Parallel::observer()
+{
+    return parallelObserver.loadAcquire();
+}
+
+bool Parallel::run(ParallelJob* job, int count, int chunkSize,
+                   ParallelCancel* cancel)
+{
+    if (!job || count <= 0) return true;
+
+    // per-worker storage of the job may be sized for less workers
+    int workers = workerCount();
+    if (workers > job->workers()) workers = job->workers();
+    if (chunkSize <= 0) {
+        // a few chunks per worker for load balancing
+        chunkSize = count / (8 * workers);
+        if (chunkSize < 1) chunkSize = 1;
+    }
+    int chunks = (count + chunkSize - 1) / chunkSize;
+    if (workers > chunks) workers = chunks;
+
+    ParallelObserver* o = observer();
+    QElapsedTimer timer;
+    if (o) {
+        timer.start();
+        o->jobStarted(job, count, workers);
+    }
+
+    // one reference for each helper and the calling thread
+    ParallelRun* r = new ParallelRun(job, count, chunkSize, cancel, workers);
+    for(int w = 1; w < workers; w++) {
+        ParallelRunner* runner = new ParallelRunner(r, w);
+        runner->setAutoDelete(true);
+        pool()->start(runner);
+    }
+
+    // the calling thread is worker 0. Afterwards, all chunks are taken:
+    // only wait for chunks in progress, not for helpers still queued
+    int own = r->work(0);
+    r->done.acquire(chunks - own);
+    r->release();
+
+    if (o) o->jobFinished(job, timer.nsecsElapsed());
+
+    return !(cancel && cancel->isCanceled());
+}
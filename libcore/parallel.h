@@ -0,0 +1,223 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Data parallel passes over the profile data model
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+/**
+ * A job working on an index range [0, count[.
+ *
+ * The range is split into chunks, and run() is called for each chunk,
+ * possibly from different threads at the same time. <worker> is in
+ * [0, workers()[ and is unique among threads running concurrently:
+ * use it to index per-thread result storage, and merge these results
+ * after Parallel::run() returned. workers() is Parallel::workerCount()
+ * at construction of the job, and Parallel::run() never uses more.
+ *
+ * Important: the data model does lazy cost updates on read access.
+ * A job therefore only is allowed to read data which never changes
+ * after loading (names, FixCost lists, part status), and must not call
+ * any cost accessor of shared items triggering update().
+ * This restriction does not apply to frozen data (TraceData::freeze()).
+ */
+class ParallelJob
+{
+public:
+    ParallelJob();
+    virtual ~ParallelJob();
+
+    virtual void run(int from, int to, int worker) = 0;
+
+    int workers() const { return _workers; }
+
+private:
+    int _workers;
+};
+
+/**
+ * A job reducing an index range to one value of type T.
+ * reduce() accumulates a chunk into the partial result of a worker,
+ * which are combined in worker order into result().
+ * The default combine() uses operator+=. <init> is the start value of
+ * every partial result, and must be neutral for combine().
+ */
+template<class T>
+class ParallelReduceJob: public ParallelJob
+{
+public:
+    explicit ParallelReduceJob(const T& init);
+
+    virtual void reduce(int from, int to, T& acc) = 0;
+    virtual void combine(T& acc, const T& partial) { acc += partial; }
+
+    void run(int from, int to, int worker) override
+    { reduce(from, to, _partialData[worker]); }
+
+    // only valid after Parallel::run() returned
+    T result();
+
+private:
+    T _init;
+    QVector<T> _partial;
+    // raw pointer: no implicit sharing checks in worker threads
+    T* _partialData;
+};
+
+/**
+ * An independent piece of work for a ParallelTaskGroup.
+ */
+class ParallelTask
+{
+public:
+    virtual ~ParallelTask();
+
+    virtual void run() = 0;
+};
+
+/**
+ * Token for cancellation of running jobs or task groups, e.g. from
+ * the GUI thread. Chunks and tasks not yet started are skipped after
+ * cancel(). Long running chunks may check isCanceled() themselves.
+ */
+class ParallelCancel
+{
+public:
+    ParallelCancel() {}
+
+    void cancel() { _canceled.storeRelease(1); }
+    void reset() { _canceled.storeRelease(0); }
+    bool isCanceled() const { return _canceled.loadAcquire() != 0; }
+
+private:
+    QAtomicInt _canceled;
+};
+
+/**
+ * Timing hooks, see Parallel::setObserver().
+ * Called from worker threads at the same time: must be thread-safe.
+ * Times are in nanoseconds.
+ */
+class ParallelObserver
+{
+public:
+    virtual ~ParallelObserver();
+
+    virtual void jobStarted(ParallelJob*, int count, int workers);
+    virtual void chunkFinished(ParallelJob*, int worker,
+                               int from, int to, qint64 time);
+    virtual void jobFinished(ParallelJob*, qint64 time);
+    virtual void taskFinished(ParallelTask*, qint64 time);
+};
+
+class ParallelGroupState;
+
+/**
+ * Set of tasks running concurrently.
+ *
+ * Each task added is started as soon as a worker thread is free.
+ * wait() takes over tasks not yet started into the calling thread,
+ * and waits for the others to finish. Thus, task groups and
+ * Parallel::run() can be nested: a waiting thread always works on
+ * pending tasks instead of blocking a worker.
+ */
+class ParallelTaskGroup
+{
+public:
+    explicit ParallelTaskGroup(ParallelCancel* cancel = nullptr);
+    // waits for all tasks
+    ~ParallelTaskGroup();
+
+    // <task> is not owned by the group
+    void add(ParallelTask* task);
+    // returns false if canceled
+    bool wait();
+
+private:
+    ParallelGroupState* _state;
+};
+
+/**
+ * Scheduler for parallel jobs and task groups.
+ *
+ * Workers are threads of a pool private to libcore, which does not
+ * need an event loop. The calling thread always is worker 0.
+ *
+ * This is self-scheduling, not work stealing: there are no per-worker
+ * deques. All workers of a job fetch chunks from one shared atomic
+ * counter, so fast workers take over chunks from slow ones. Pending
+ * tasks of a task group are in one mutex protected FIFO, taken from
+ * the front by workers and from the back by a waiting thread. With a
+ * few coarse chunks or tasks per worker, the single counter or mutex
+ * is not contended; a job with tiny chunks should use a larger
+ * <chunkSize> instead.
+ */
+class Parallel
+{
+public:
+    /**
+     * Maximal number of workers running a job,
+     * including the calling thread.
+     * Defaults to the number of CPU cores. Environment variable
+     * KCACHEGRIND_THREADS overrides both default and setWorkerCount().
+     */
+    static int workerCount();
+    // 0 restores the default
+    static void setWorkerCount(int);
+
+    /**
+     * Run <job> over index range [0, count[ and wait for completion.
+     * With <chunkSize> 0, a chunk size is choosen to give some
+     * load balancing among workers. Calls can be nested.
+     * Returns false if canceled via <cancel>.
+     */
+    static bool run(ParallelJob* job, int count, int chunkSize = 0,
+                    ParallelCancel* cancel = nullptr);
+
+    // timing hooks for all jobs and tasks, not owned
+    static void setObserver(ParallelObserver*);
+    static ParallelObserver* observer();
+};
+
+
+//---------------------------------------------------
+// ParallelReduceJob
+
+template<class T>
+ParallelReduceJob<T>::ParallelReduceJob(const T& init)
+    : _init(init), _partial(workers(), init)
+{
+    _partialData = _partial.data();
+}
+
+template<class T>
+T ParallelReduceJob<T>::result()
+{
+    T res = _init;
+    for(int w=0; w<_partial.count(); w++)
+        combine(res, _partial.at(w));
+    return res;
+}
+
+#endif
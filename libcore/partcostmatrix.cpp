@@ -0,0 +1,380 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Per-part costs of functions and calls as sparse matrices
+ */
+
+#include "partcostmatrix.h"
+
+#include <algorithm>
+
+#include <QPair>
+
+#include "tracedata.h"
+#include "fixcost.h"
+#include "parallel.h"
+
+typedef QPair<int, CostItem*> PartEntry;
+
+
+//---------------------------------------------------
+// PartCostJob
+
+/* Fills rows of a function matrix (from FixCost lists) or
+ * of a call matrix (from FixCallCost lists, with call count) */
+class PartCostJob: public ParallelJob
+{
+public:
+    PartCostJob(const QVector<TraceFunction*>* functions,
+                const QVector<TraceCall*>* calls,
+                const QHash<TracePart*, int>& partIndex,
+                const int* rowStart, int* part, SubCost* cost,
+                int width, int realCount)
+        : _functions(functions), _calls(calls), _partIndex(partIndex),
+          _rowStart(rowStart), _part(part), _cost(cost),
+          _width(width), _realCount(realCount)
+    {}
+
+    void run(int from, int to, int) override
+    {
+        QVector<PartEntry> entries;
+
+        for(int row=from; row<to; row++) {
+            entries.clear();
+            if (_functions) {
+                foreach(TraceInclusiveCost* ic, _functions->at(row)->deps())
+                    entries.append(PartEntry(_partIndex.value(ic->part()), ic));
+            }
+            else {
+                foreach(TraceCallCost* cc, _calls->at(row)->deps())
+                    entries.append(PartEntry(_partIndex.value(cc->part()), cc));
+            }
+            std::sort(entries.begin(), entries.end());
+
+            int e = _rowStart[row];
+            foreach(const PartEntry& pe, entries) {
+                _part[e] = pe.first;
+                SubCost* c = _cost + e * _width;
+                EventTypeMapping* m = pe.second->part()->eventTypeMapping();
+
+                if (_functions) {
+                    TracePartFunction* pf = (TracePartFunction*) pe.second;
+                    for(FixCost* fc = pf->firstFixCost(); fc;
+                        fc = fc->nextCostOfPartFunction()) {
+                        const SubCost* fcc = fc->costs();
+                        for(int k=0; k<fc->costCount(); k++)
+                            c[m->realIndex(k)] += fcc[k];
+                    }
+                }
+                else {
+                    TracePartCall* pc = (TracePartCall*) pe.second;
+                    for(FixCallCost* fcc = pc->firstFixCallCost(); fcc;
+                        fcc = fcc->nextCostOfPartCall()) {
+                        const SubCost* cc = fcc->costs();
+                        for(int k=0; k<fcc->costCount(); k++)
+                            c[m->realIndex(k)] += cc[k];
+                        c[_realCount] += fcc->callCount();
+                    }
+                }
+                e++;
+            }
+        }
+    }
+
+private:
+    const QVector<TraceFunction*>* _functions;
+    const QVector<TraceCall*>* _calls;
+    const QHash<TracePart*, int>& _partIndex;
+    const int* _rowStart;
+    int* _part;
+    SubCost* _cost;
+    int _width, _realCount;
+};
+
+
+//---------------------------------------------------
+// PartCostMatrix::Matrix
+
+int PartCostMatrix::Matrix::find(int row, int p) const
+{
+    if (row < 0) return -1;
+
+    const int* first = part.constData() + rowStart.at(row);
+    const int* last = part.constData() + rowStart.at(row+1);
+    const int* e = std::lower_bound(first, last, p);
+    if ((e == last) || (*e != p)) return -1;
+    return e - part.constData();
+}
+
+SubCost PartCostMatrix::Matrix::subCost(int entry, EventType* t,
+                                        int realCount) const
+{
+    if ((entry < 0) || !t) return 0;
+
+    QVector<const SubCost*> columns(realCount);
+    const SubCost* c = cost.constData() + entry * width;
+    for(int i=0; i<realCount; i++)
+        columns[i] = c + i;
+    SubCost res;
+    t->subCosts(columns.constData(), 1, &res);
+    return res;
+}
+
+
+//---------------------------------------------------
+// PartCostMatrix
+
+PartCostMatrix::PartCostMatrix(TraceData* data)
+{
+    _data = data;
+    _valid = false;
+    _realCount = 0;
+}
+
+void PartCostMatrix::allocate(Matrix& m, int width,
+                              const QVector<int>& rowCount)
+{
+    m.width = width;
+    m.rowStart.resize(rowCount.count() + 1);
+    int entries = 0;
+    for(int row=0; row<rowCount.count(); row++) {
+        m.rowStart[row] = entries;
+        entries += rowCount.at(row);
+    }
+    m.rowStart[rowCount.count()] = entries;
+    m.part.fill(0, entries);
+    m.cost.fill(SubCost(0), entries * width);
+}
+
+void PartCostMatrix::update()
+{
+    if (_valid) return;
+
+    _realCount = _data->eventTypes()->realCount();
+
+    _partIndex.clear();
+    int p = 0;
+    foreach(TracePart* part, _data->parts())
+        _partIndex.insert(part, p++);
+
+    _functions.clear();
+    _calls.clear();
+    _fRow.clear();
+    _cRow.clear();
+    QVector<int> fCount, cCount;
+    TraceFunctionMap::Iterator it;
+    for ( it = _data->functionMap().begin();
+          it != _data->functionMap().end(); ++it ) {
+        TraceFunction* f = &(*it);
+        _fRow.insert(f, _functions.count());
+        _functions.append(f);
+        fCount.append(f->deps().count());
+
+        foreach(TraceCall* c, f->callings()) {
+            _cRow.insert(c, _calls.count());
+            _calls.append(c);
+            cCount.append(c->deps().count());
+        }
+    }
+
+    allocate(_f, _realCount, fCount);
+    allocate(_c, _realCount + 1, cCount);
+
+    PartCostJob fJob(&_functions, nullptr, _partIndex,
+                     _f.rowStart.constData(), _f.part.data(), _f.cost.data(),
+                     _f.width, _realCount);
+    Parallel::run(&fJob, _functions.count());
+
+    PartCostJob cJob(nullptr, &_calls, _partIndex,
+                     _c.rowStart.constData(), _c.part.data(), _c.cost.data(),
+                     _c.width, _realCount);
+    Parallel::run(&cJob, _calls.count());
+
+    _valid = true;
+
+    if (0) qDebug("PartCostMatrix: %d function entries, %d call entries",
+                  functionEntries(), callEntries());
+}
+
+QList<TracePart*> PartCostMatrix::parts(TraceFunction* f)
+{
+    update();
+
+    QList<TracePart*> res;
+    int row = _fRow.value(f, -1);
+    if (row < 0) return res;
+    for(int e = _f.rowStart.at(row); e < _f.rowStart.at(row+1); e++)
+        res.append(_data->parts().at(_f.part.at(e)));
+    return res;
+}
+
+SubCost PartCostMatrix::selfCost(TraceFunction* f, TracePart* p,
+                                 EventType* t)
+{
+    update();
+
+    int e = _f.find(_fRow.value(f, -1), _partIndex.value(p, -1));
+    return _f.subCost(e, t, _realCount);
+}
+
+int PartCostMatrix::rowCosts(const Matrix& m, int row, EventType* t,
+                             QVector<int>& parts,
+                             QVector<SubCost>& costs) const
+{
+    int first = m.rowStart.at(row);
+    int n = m.rowStart.at(row+1) - first;
+    parts.resize(n);
+    costs.resize(n);
+    if (n == 0) return 0;
+
+    // transpose the entries into columns for batch evaluation
+    QVector<SubCost> c(n * _realCount);
+    QVector<const SubCost*> columns(_realCount);
+    for(int i=0; i<_realCount; i++) {
+        columns[i] = c.constData() + i * n;
+        for(int e=0; e<n; e++)
+            c[i * n + e] = m.cost.at((first + e) * m.width + i);
+    }
+    for(int e=0; e<n; e++)
+        parts[e] = m.part.at(first + e);
+    t->subCosts(columns.constData(), n, costs.data());
+
+    return n;
+}
+
+int PartCostMatrix::selfCosts(int row, EventType* t,
+                              QVector<int>& parts,
+                              QVector<SubCost>& costs) const
+{
+    if ((row < 0) || (row >= _functions.count()) || !t) return 0;
+
+    return rowCosts(_f, row, t, parts, costs);
+}
+
+int PartCostMatrix::inclusiveCosts(int row, EventType* t,
+                                   QVector<int>& parts,
+                                   QVector<SubCost>& costs) const
+{
+    if ((row < 0) || (row >= _functions.count()) || !t) return 0;
+    TraceFunction* f = _functions.at(row);
+
+    // per part: call count and cost of calls to f, and the cost of
+    // f and its calls, used for parts where f is not called
+    QHash<int, int> slot;
+    QVector<uint64> calledCount, callerCost, ownCost;
+    QVector<int> p;
+    QVector<SubCost> c;
+
+    foreach(TraceCall* call, f->callers(true)) {
+        int crow = _cRow.value(call, -1);
+        if (crow < 0) continue;
+        int n = rowCosts(_c, crow, t, p, c);
+        int first = _c.rowStart.at(crow);
+        for(int e=0; e<n; e++) {
+            int s = slot.value(p.at(e), -1);
+            if (s < 0) {
+                s = slot.count();
+                slot.insert(p.at(e), s);
+                calledCount.append(0);
+                callerCost.append(0);
+                ownCost.append(0);
+            }
+            calledCount[s] += _c.cost.at((first + e) * _c.width + _realCount).v;
+            if (!call->isRecursion())
+                callerCost[s] += c.at(e).v;
+        }
+    }
+
+    for(int i=0; i<=f->callings().count(); i++) {
+        int n;
+        if (i < f->callings().count()) {
+            TraceCall* call = f->callings().at(i);
+            if (call->isRecursion()) continue;
+            n = rowCosts(_c, _cRow.value(call), t, p, c);
+        }
+        else
+            n = rowCosts(_f, row, t, p, c);
+
+        for(int e=0; e<n; e++) {
+            int s = slot.value(p.at(e), -1);
+            if (s < 0) {
+                s = slot.count();
+                slot.insert(p.at(e), s);
+                calledCount.append(0);
+                callerCost.append(0);
+                ownCost.append(0);
+            }
+            ownCost[s] += c.at(e).v;
+        }
+    }
+
+    QList<int> keys = slot.keys();
+    std::sort(keys.begin(), keys.end());
+    parts.resize(keys.count());
+    costs.resize(keys.count());
+    for(int i=0; i<keys.count(); i++) {
+        int s = slot.value(keys.at(i));
+        parts[i] = keys.at(i);
+        costs[i] = (calledCount.at(s) > 0) ? callerCost.at(s) : ownCost.at(s);
+    }
+    return keys.count();
+}
+
+SubCost PartCostMatrix::callCost(TraceCall* c, TracePart* p, EventType* t)
+{
+    update();
+
+    int e = _c.find(_cRow.value(c, -1), _partIndex.value(p, -1));
+    return _c.subCost(e, t, _realCount);
+}
+
+SubCost PartCostMatrix::callCount(TraceCall* c, TracePart* p)
+{
+    update();
+
+    int e = _c.find(_cRow.value(c, -1), _partIndex.value(p, -1));
+    if (e < 0) return 0;
+    return _c.cost.at(e * _c.width + _realCount);
+}
+
+SubCost PartCostMatrix::inclusiveCost(TraceFunction* f, TracePart* p,
+                                      EventType* t)
+{
+    update();
+
+    uint64 calledCount = 0;
+    foreach(TraceCall* c, f->callers(true))
+        calledCount += callCount(c, p);
+
+    SubCost res = 0;
+    if (calledCount > 0) {
+        foreach(TraceCall* c, f->callers(true)) {
+            if (c->isRecursion()) continue;
+            res += callCost(c, p, t);
+        }
+        return res;
+    }
+
+    foreach(TraceCall* c, f->callings()) {
+        if (c->isRecursion()) continue;
+        res += callCost(c, p, t);
+    }
+    res += selfCost(f, p, t);
+    return res;
+}
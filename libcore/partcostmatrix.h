@@ -0,0 +1,120 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Per-part costs of functions and calls as sparse matrices
+ */
+
+#ifndef PARTCOSTMATRIX_H
+#define PARTCOSTMATRIX_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "subcost.h"
+
+class TraceData;
+class TracePart;
+class TraceFunction;
+class TraceCall;
+class EventType;
+
+/**
+ * Costs of all functions and calls for each profile part, stored
+ * as two matrices in compressed sparse row (CSR) format: one row
+ * per function or call, with one entry for each part the function
+ * or call has cost in, sorted by part. An entry holds the self cost
+ * of a function for all real event types, or the cost and call count
+ * of a call.
+ *
+ * This gives per-part costs without going through TracePartFunction
+ * and TracePartCall items, which update lazily on read and thus can
+ * not be used from parallel jobs. The part items stay the storage of
+ * per-part costs: a matrix is a temporary copy, only to be built by
+ * analyses over all parts (phase detection, fleet statistics) for
+ * the time of the analysis. Entries do not depend on part activation,
+ * so a matrix stays valid until parts are added. It is built in
+ * parallel, directly from the FixCost lists.
+ */
+class PartCostMatrix
+{
+public:
+    explicit PartCostMatrix(TraceData*);
+
+    void invalidate() { _valid = false; }
+    bool isValid() const { return _valid; }
+    void update();
+
+    // all accessors below call update() if needed
+    QList<TracePart*> parts(TraceFunction*);
+    SubCost selfCost(TraceFunction*, TracePart*, EventType*);
+    /* Same as TracePartFunction: sum of calls to the function, or
+     * for functions without callers, self cost plus calls from it */
+    SubCost inclusiveCost(TraceFunction*, TracePart*, EventType*);
+    SubCost callCost(TraceCall*, TracePart*, EventType*);
+    SubCost callCount(TraceCall*, TracePart*);
+
+    // function rows, in order of the function map
+    int functionCount() { update(); return _functions.count(); }
+    TraceFunction* function(int row) { return _functions.value(row); }
+    /* Self costs of function <row> in all parts it has cost in:
+     * <parts> gets indexes into TraceData::parts(), <costs> the cost.
+     * Returns the number of entries. Only reads the matrix, so it
+     * can be used from parallel jobs after update(). */
+    int selfCosts(int row, EventType*,
+                  QVector<int>& parts, QVector<SubCost>& costs) const;
+    // same for inclusive cost, with the rule of inclusiveCost()
+    int inclusiveCosts(int row, EventType*,
+                       QVector<int>& parts, QVector<SubCost>& costs) const;
+
+    // number of matrix entries for functions and calls
+    int functionEntries() const { return _f.part.count(); }
+    int callEntries() const { return _c.part.count(); }
+
+private:
+    // CSR matrix with <width> counters per entry
+    class Matrix {
+    public:
+        QVector<int> rowStart, part;
+        QVector<SubCost> cost;
+        int width;
+
+        // index of entry, -1 if not found
+        int find(int row, int part) const;
+        SubCost subCost(int entry, EventType*, int realCount) const;
+    };
+
+    void allocate(Matrix& m, int width, const QVector<int>& rowCount);
+    // entries of a matrix row, see selfCosts()
+    int rowCosts(const Matrix& m, int row, EventType*,
+                 QVector<int>& parts, QVector<SubCost>& costs) const;
+
+    TraceData* _data;
+    bool _valid;
+    int _realCount;
+
+    QHash<TracePart*, int> _partIndex;
+    QHash<TraceFunction*, int> _fRow;
+    QHash<TraceCall*, int> _cRow;
+    QVector<TraceFunction*> _functions;
+    QVector<TraceCall*> _calls;
+    Matrix _f, _c;
+};
+
+#endif
@@ -0,0 +1,375 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Detection of program phases in a sequence of profile parts
+ */
+
+#include "phasedetection.h"
+
+#include <algorithm>
+
+#include <QObject>
+#include <QPair>
+
+#include "tracedata.h"
+#include "partcostmatrix.h"
+#include "parallel.h"
+
+
+//---------------------------------------------------
+// ProgramPhase
+
+ProgramPhase::ProgramPhase()
+{
+    first = last = -1;
+    topFunction = nullptr;
+}
+
+QString ProgramPhase::name() const
+{
+    QString n;
+    if (first == last)
+        n = QObject::tr("Part %1").arg(first + 1);
+    else
+        n = QObject::tr("Parts %1 - %2").arg(first + 1).arg(last + 1);
+    if (topFunction)
+        n += QStringLiteral(" (%1)").arg(topFunction->prettyName());
+    return n;
+}
+
+
+//---------------------------------------------------
+// Parallel jobs for PhaseDetection
+
+/* Total self cost of each function over all parts, and of each part
+ * over all functions (one sum per worker) */
+class FunctionTotalJob: public ParallelJob
+{
+public:
+    FunctionTotalJob(PartCostMatrix* m, EventType* t, int partCount)
+        : _m(m), _t(t), total(m->functionCount(), 0),
+          partTotal(workers() * partCount, 0),
+          _partCount(partCount)
+    {
+        // raw pointers: no implicit sharing checks in worker threads
+        _total = total.data();
+        _partTotal = partTotal.data();
+    }
+
+    void run(int from, int to, int worker) override
+    {
+        QVector<int> parts;
+        QVector<SubCost> costs;
+        uint64* pt = _partTotal + worker * _partCount;
+
+        for(int row=from; row<to; row++) {
+            int n = _m->selfCosts(row, _t, parts, costs);
+            uint64 sum = 0;
+            for(int e=0; e<n; e++) {
+                sum += costs.at(e).v;
+                pt[parts.at(e)] += costs.at(e).v;
+            }
+            _total[row] = sum;
+        }
+    }
+
+private:
+    PartCostMatrix* _m;
+    EventType* _t;
+
+public:
+    QVector<uint64> total;
+    // workers() rows of part totals
+    QVector<uint64> partTotal;
+
+private:
+    int _partCount;
+    uint64 *_total, *_partTotal;
+};
+
+/* Cost shares of selected functions in each part */
+class PartShareJob: public ParallelJob
+{
+public:
+    PartShareJob(PartCostMatrix* m, EventType* t, const QVector<int>& rows,
+                 const QVector<SubCost>& partCost, double* shares, int dim)
+        : _m(m), _t(t), _rows(rows), _partCost(partCost),
+          _shares(shares), _dim(dim)
+    {}
+
+    void run(int from, int to, int) override
+    {
+        QVector<int> parts;
+        QVector<SubCost> costs;
+
+        for(int k=from; k<to; k++) {
+            int n = _m->selfCosts(_rows.at(k), _t, parts, costs);
+            for(int e=0; e<n; e++) {
+                int p = parts.at(e);
+                uint64 pc = _partCost.at(p).v;
+                if (pc == 0) continue;
+                _shares[p * _dim + k] = (double) costs.at(e).v / pc;
+            }
+        }
+    }
+
+private:
+    PartCostMatrix* _m;
+    EventType* _t;
+    const QVector<int>& _rows;
+    const QVector<SubCost>& _partCost;
+    double* _shares;
+    int _dim;
+};
+
+/* Best split position in a range of parts (one result per worker) */
+class SplitJob: public ParallelJob
+{
+public:
+    SplitJob(const PhaseDetection* d, int from, int to)
+        : _d(d), _from(from), _to(to), _sse(d->sse(from, to)),
+          pos(workers(), -1),
+          gain(workers(), 0.0)
+    {
+        _pos = pos.data();
+        _gain = gain.data();
+    }
+
+    void run(int from, int to, int worker) override
+    {
+        for(int i=from; i<to; i++) {
+            int t = _from + 1 + i;
+            double g = _sse - _d->sse(_from, t) - _d->sse(t, _to);
+            if ((_pos[worker] < 0) || (g > _gain[worker])) {
+                _pos[worker] = t;
+                _gain[worker] = g;
+            }
+        }
+    }
+
+private:
+    const PhaseDetection* _d;
+    int _from, _to;
+    double _sse;
+
+public:
+    QVector<int> pos;
+    QVector<double> gain;
+
+private:
+    int* _pos;
+    double* _gain;
+};
+
+
+/* A range [from, to[ of parts, with best split position and its gain */
+struct PhaseSegment
+{
+    int from, to, split;
+    double gain;
+};
+
+
+//---------------------------------------------------
+// PhaseDetection
+
+PhaseDetection::PhaseDetection(TraceData* data)
+{
+    _data = data;
+    _eventType = nullptr;
+    _functionCount = 32;
+    _maxPhases = 10;
+    _minGain = 0.02;
+    _dim = 0;
+}
+
+static bool higherTotal(const QPair<uint64, int>& a,
+                        const QPair<uint64, int>& b)
+{
+    return a.first > b.first;
+}
+
+void PhaseDetection::computeVectors()
+{
+    // only needed while computing the vectors
+    PartCostMatrix matrix(_data);
+    PartCostMatrix* m = &matrix;
+    int partCount = _data->parts().count();
+
+    // no lazy parsing from parallel jobs
+    _eventType->parseFormula();
+
+    FunctionTotalJob totalJob(m, _eventType, partCount);
+    Parallel::run(&totalJob, m->functionCount());
+
+    _partCost.fill(SubCost(0), partCount);
+    for(int w=0; w<totalJob.workers(); w++)
+        for(int p=0; p<partCount; p++)
+            _partCost[p].v += totalJob.partTotal.at(w * partCount + p);
+
+    // functions with highest self cost over all parts
+    QVector< QPair<uint64, int> > order;
+    for(int row=0; row<totalJob.total.count(); row++)
+        if (totalJob.total.at(row) > 0)
+            order.append(qMakePair(totalJob.total.at(row), row));
+    int k = qMin(_functionCount, order.count());
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                      higherTotal);
+
+    QVector<int> rows;
+    _functions.clear();
+    for(int i=0; i<k; i++) {
+        rows.append(order.at(i).second);
+        _functions.append(m->function(order.at(i).second));
+    }
+    _dim = k + 1;
+
+    QVector<double> shares(partCount * _dim, 0.0);
+    PartShareJob shareJob(m, _eventType, rows, _partCost,
+                          shares.data(), _dim);
+    Parallel::run(&shareJob, k, 1);
+
+    // last component: share of all other functions; then prefix sums
+    _sum.fill(0.0, (partCount + 1) * _dim);
+    _sqSum.fill(0.0, partCount + 1);
+    for(int p=0; p<partCount; p++) {
+        double* x = shares.data() + p * _dim;
+        double other = (_partCost.at(p).v > 0) ? 1.0 : 0.0;
+        for(int i=0; i<k; i++)
+            other -= x[i];
+        x[k] = qMax(other, 0.0);
+
+        double sq = 0.0;
+        for(int i=0; i<_dim; i++) {
+            _sum[(p+1) * _dim + i] = _sum.at(p * _dim + i) + x[i];
+            sq += x[i] * x[i];
+        }
+        _sqSum[p+1] = _sqSum.at(p) + sq;
+    }
+}
+
+double PhaseDetection::sse(int from, int to) const
+{
+    int len = to - from;
+    if (len < 2) return 0.0;
+
+    const double* s1 = _sum.constData() + to * _dim;
+    const double* s0 = _sum.constData() + from * _dim;
+    double s = 0.0;
+    for(int i=0; i<_dim; i++) {
+        double d = s1[i] - s0[i];
+        s += d * d;
+    }
+    return _sqSum.at(to) - _sqSum.at(from) - s / len;
+}
+
+int PhaseDetection::bestSplit(int from, int to, double* gain)
+{
+    *gain = 0.0;
+    if (to - from < 2) return -1;
+
+    SplitJob job(this, from, to);
+    Parallel::run(&job, to - from - 1);
+
+    int best = -1;
+    for(int w=0; w<job.pos.count(); w++) {
+        if (job.pos.at(w) < 0) continue;
+        if ((best < 0) || (job.gain.at(w) > *gain)) {
+            best = job.pos.at(w);
+            *gain = job.gain.at(w);
+        }
+    }
+    return best;
+}
+
+int PhaseDetection::detect()
+{
+    _phases.clear();
+
+    const TracePartList& parts = _data->parts();
+    int partCount = parts.count();
+    if (partCount == 0) return 0;
+
+    if (!_eventType)
+        _eventType = _data->eventTypes()->realType(0);
+    if (!_eventType) return 0;
+
+    computeVectors();
+
+    QVector<PhaseSegment> segments;
+    PhaseSegment s;
+    s.from = 0;
+    s.to = partCount;
+    s.split = bestSplit(0, partCount, &s.gain);
+    segments.append(s);
+
+    double total = sse(0, partCount);
+    while(segments.count() < _maxPhases) {
+        int best = -1;
+        for(int i=0; i<segments.count(); i++) {
+            if (segments.at(i).split < 0) continue;
+            if ((best < 0) || (segments.at(i).gain > segments.at(best).gain))
+                best = i;
+        }
+        if (best < 0) break;
+        if (segments.at(best).gain <= _minGain * total) break;
+
+        PhaseSegment left = segments.at(best), right = segments.at(best);
+        left.to = right.from = segments.at(best).split;
+        left.split = bestSplit(left.from, left.to, &left.gain);
+        right.split = bestSplit(right.from, right.to, &right.gain);
+        segments[best] = left;
+        segments.insert(best + 1, right);
+    }
+
+    foreach(const PhaseSegment& seg, segments) {
+        ProgramPhase ph;
+        ph.first = seg.from;
+        ph.last = seg.to - 1;
+        ph.cost = 0;
+        for(int p=seg.from; p<seg.to; p++) {
+            ph.parts.append(parts.at(p));
+            ph.cost.v += _partCost.at(p).v;
+        }
+
+        // function with highest summed share in the phase
+        double maxShare = 0.0;
+        const double* s1 = _sum.constData() + seg.to * _dim;
+        const double* s0 = _sum.constData() + seg.from * _dim;
+        for(int i=0; i<_functions.count(); i++) {
+            if (s1[i] - s0[i] <= maxShare) continue;
+            maxShare = s1[i] - s0[i];
+            ph.topFunction = _functions.at(i);
+        }
+        _phases.append(ph);
+    }
+
+    if (0) qDebug("PhaseDetection: %d parts, %d functions, %d phases",
+                  partCount, _functions.count(), _phases.count());
+
+    return _phases.count();
+}
+
+int PhaseDetection::phaseOf(TracePart* part) const
+{
+    for(int i=0; i<_phases.count(); i++)
+        if (_phases.at(i).parts.contains(part))
+            return i;
+    return -1;
+}
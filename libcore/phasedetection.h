@@ -0,0 +1,113 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Detection of program phases in a sequence of profile parts
+ */
+
+#ifndef PHASEDETECTION_H
+#define PHASEDETECTION_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "subcost.h"
+
+class TraceData;
+class TracePart;
+class TraceFunction;
+class EventType;
+
+/**
+ * A phase: a range of consecutive profile parts with similar cost
+ * distribution among functions.
+ */
+class ProgramPhase
+{
+public:
+    ProgramPhase();
+
+    // range of indexes into TraceData::parts()
+    int first, last;
+    QList<TracePart*> parts;
+    SubCost cost;
+    // function with highest self cost in the phase
+    TraceFunction* topFunction;
+
+    QString name() const;
+};
+
+/**
+ * Splits the parts of a profile (e.g. time slices from
+ * "--dump-every-bb") into phases by change-point detection.
+ *
+ * Each part is described by a vector with the cost shares of the
+ * functions with highest self cost over the whole run, plus one share
+ * for all other functions. Phases are found by binary segmentation:
+ * the range of parts giving the largest reduction of squared distances
+ * to the phase mean is split until <maxPhases> is reached or the
+ * reduction gets below <minGain> of the total.
+ *
+ * Costs come from a temporary PartCostMatrix, so all parts are used,
+ * independent from part activation. Part vectors and split candidates
+ * are computed in parallel.
+ */
+class PhaseDetection
+{
+public:
+    explicit PhaseDetection(TraceData*);
+
+    void setEventType(EventType* t) { _eventType = t; }
+    void setFunctionCount(int n) { _functionCount = n; }
+    void setMaxPhases(int n) { _maxPhases = n; }
+    void setMinGain(double g) { _minGain = g; }
+
+    EventType* eventType() const { return _eventType; }
+
+    // returns number of phases found
+    int detect();
+
+    int count() const { return _phases.count(); }
+    const ProgramPhase& phase(int i) const { return _phases.at(i); }
+    // -1 if part is not known
+    int phaseOf(TracePart*) const;
+
+    // sum of squared distances of part vectors in [from, to[ to their mean
+    double sse(int from, int to) const;
+
+private:
+    void computeVectors();
+    // best split position in [from, to[, with gain
+    int bestSplit(int from, int to, double* gain);
+
+    TraceData* _data;
+    EventType* _eventType;
+    int _functionCount, _maxPhases;
+    double _minGain;
+
+    // selected functions, and dimension of part vectors (one more)
+    QVector<TraceFunction*> _functions;
+    int _dim;
+    // prefix sums over parts: vectors (_dim per part) and squared norms
+    QVector<double> _sum, _sqSum;
+    QVector<SubCost> _partCost;
+    QList<ProgramPhase> _phases;
+};
+
+#endif
@@ -18,27 +18,98 @@
 
 #include "pool.h"
 
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <qglobal.h>
 
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
 // FixPool
 
 #define CHUNK_SIZE 100000
 
+// FixPool chunks grow up to this size, but are at most
+// 1/CHUNK_GROWTH_DIVISOR of the space already allocated from the pool,
+// to keep unused space in the last chunk small. Thus, the maximum is
+// reached only after MAX_CHUNK_SIZE * CHUNK_GROWTH_DIVISOR (512 MB)
+#define MAX_CHUNK_SIZE (64 << 20)
+#define CHUNK_GROWTH_DIVISOR 8
+// chunks at least this size are mapped directly
+#define MAP_CHUNK_SIZE (2 << 20)
+// objects start at multiples of this (enough for pointers and 64bit costs)
+#define OBJECT_ALIGN 8
+
 struct SpaceChunk
 {
     struct SpaceChunk* next;
-    unsigned int used;
-    char space[1];
+    size_t used, size;
+    bool mapped;
+    alignas(alignof(max_align_t)) char space[1];
 };
 
+static inline unsigned int alignedSize(unsigned int size)
+{
+    return (size + OBJECT_ALIGN - 1) & ~(OBJECT_ALIGN - 1);
+}
+
+static struct SpaceChunk* newChunk(size_t size)
+{
+    size_t len = offsetof(struct SpaceChunk, space) + size;
+    struct SpaceChunk* chunk = nullptr;
+    bool mapped = false;
+
+#ifdef Q_OS_UNIX
+    if (size >= MAP_CHUNK_SIZE) {
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+            madvise(p, len, MADV_HUGEPAGE);
+#endif
+            chunk = (struct SpaceChunk*) p;
+            mapped = true;
+        }
+    }
+#endif
+    if (!chunk)
+        chunk = (struct SpaceChunk*) malloc(len);
+
+    if (!chunk) {
+        qFatal("ERROR: Out of memory. Sorry. KCachegrind has to terminate.\n\n"
+               "You probably tried to load a profile data file too huge for"
+               "this system. You could try loading this file on a 64-bit OS.");
+        exit(1);
+    }
+    chunk->next = nullptr;
+    chunk->used = 0;
+    chunk->size = size;
+    chunk->mapped = mapped;
+
+    return chunk;
+}
+
+static void freeChunk(struct SpaceChunk* chunk)
+{
+#ifdef Q_OS_UNIX
+    if (chunk->mapped) {
+        munmap(chunk, offsetof(struct SpaceChunk, space) + chunk->size);
+        return;
+    }
+#endif
+    free(chunk);
+}
+
 FixPool::FixPool()
 {
     _first = _last = nullptr;
     _reservation = 0;
+    _chunkSize = CHUNK_SIZE;
     _count = 0;
     _size = 0;
+    _capacity = 0;
 }
 
 FixPool::~FixPool()
@@ -47,16 +118,17 @@ FixPool::~FixPool()
 
     while(chunk) {
         next = chunk->next;
-        free(chunk);
+        freeChunk(chunk);
         chunk = next;
     }
 
-    if (0) qDebug("~FixPool: Had %d objects with total size %d\n",
-                  _count, _size);
+    if (0) qDebug("~FixPool: Had %llu objects with total size %llu (%llu allocated)\n",
+                  _count, _size, _capacity);
 }
 
 void* FixPool::allocate(unsigned int size)
 {
+    size = alignedSize(size);
     if (!ensureSpace(size)) return nullptr;
 
     _reservation = 0;
@@ -71,6 +143,7 @@ void* FixPool::allocate(unsigned int size)
 
 void* FixPool::reserve(unsigned int size)
 {
+    size = alignedSize(size);
     if (!ensureSpace(size)) return nullptr;
     _reservation = size;
 
@@ -80,6 +153,7 @@ void* FixPool::reserve(unsigned int size)
 
 bool FixPool::allocateReserved(unsigned int size)
 {
+    size = alignedSize(size);
     if (_reservation < size) return false;
 
     _reservation = 0;
@@ -91,32 +165,50 @@ bool FixPool::allocateReserved(unsigned int size)
     return true;
 }
 
+void FixPool::merge(FixPool* pool)
+{
+    if (!pool || (pool == this) || !pool->_first) return;
+
+    // put chunks in front to keep free space of our last chunk usable
+    pool->_last->next = _first;
+    _first = pool->_first;
+    if (!_last) _last = pool->_last;
+
+    _count += pool->_count;
+    _size += pool->_size;
+    _capacity += pool->_capacity;
+
+    pool->_first = pool->_last = nullptr;
+    pool->_reservation = 0;
+    pool->_count = 0;
+    pool->_size = 0;
+    pool->_capacity = 0;
+}
+
 bool FixPool::ensureSpace(unsigned int size)
 {
-    if (_last && _last->used + size <= CHUNK_SIZE) return true;
+    if (_last && _last->used + size <= _last->size) return true;
 
-    struct SpaceChunk* newChunk;
+    // oversized requests get a chunk of their own size
+    size_t chunkSize = _chunkSize;
+    if (size > chunkSize) chunkSize = size;
 
-    // we do not allow allocation sizes > CHUNK_SIZE
-    if (size > CHUNK_SIZE) return false;
+    struct SpaceChunk* chunk = newChunk(chunkSize);
+    _capacity += chunkSize;
 
-    newChunk = (struct SpaceChunk*) malloc(sizeof(struct SpaceChunk) +
-                                           CHUNK_SIZE);
-    if (!newChunk) {
-        qFatal("ERROR: Out of memory. Sorry. KCachegrind has to terminate.\n\n"
-               "You probably tried to load a profile data file too huge for"
-               "this system. You could try loading this file on a 64-bit OS.");
-        exit(1);
-    }
-    newChunk->next = nullptr;
-    newChunk->used = 0;
+    // double, but proportional to the space already used
+    size_t limit = _size / CHUNK_GROWTH_DIVISOR;
+    if (limit > MAX_CHUNK_SIZE) limit = MAX_CHUNK_SIZE;
+    _chunkSize *= 2;
+    if (_chunkSize > limit) _chunkSize = limit;
+    if (_chunkSize < CHUNK_SIZE) _chunkSize = CHUNK_SIZE;
 
     if (!_last) {
-        _last = _first = newChunk;
+        _last = _first = chunk;
     }
     else {
-        _last->next = newChunk;
-        _last = newChunk;
+        _last->next = chunk;
+        _last = chunk;
     }
     return true;
 }
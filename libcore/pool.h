@@ -19,6 +19,9 @@
 #ifndef POOL_H
 #define POOL_H
 
+#include <stddef.h>
+#include <qglobal.h>
+
 /**
  * Pool objects: containers for many small objects.
  */
@@ -30,6 +33,18 @@ struct SpaceChunk;
  *
  * For objects with fixed size and life time
  * ending with that of the pool.
+ *
+ * Space is taken from chunks doubling in size, but never larger than
+ * 1/8 of the space already allocated from the pool, so that at most
+ * that fraction is left unused at the end. With the maximum of 64 MB,
+ * chunks only reach that size after 512 MB are allocated. Large chunks
+ * are directly mapped from the OS (with a hint to use huge pages where
+ * available). Objects are 8-byte aligned.
+ *
+ * A pool must only be used by one thread at a time. For parallel
+ * loading, give each worker its own pool, and merge() these into
+ * the pool of the TraceData afterwards. Merging only moves chunks:
+ * objects keep their address.
  */
 class FixPool
 {
@@ -57,6 +72,19 @@ public:
      */
     bool allocateReserved(unsigned int size);
 
+    /**
+     * Take over all chunks of @p pool, which is empty afterwards.
+     * Objects allocated from @p pool stay valid, with their life time
+     * now ending with that of this pool.
+     */
+    void merge(FixPool* pool);
+
+    // number of objects and bytes allocated
+    quint64 count() const { return _count; }
+    quint64 size() const { return _size; }
+    // bytes taken from the OS
+    quint64 capacity() const { return _capacity; }
+
 private:
     /* Checks that there is enough space in the last chunk.
      * Returns false if this is not possible.
@@ -65,7 +93,9 @@ private:
 
     struct SpaceChunk *_first, *_last;
     unsigned int _reservation;
-    int _count, _size;
+    // size of next chunk to allocate
+    size_t _chunkSize;
+    quint64 _count, _size, _capacity;
 };
 
 /**
@@ -97,6 +127,11 @@ public:
      */
     void free(char** ptr);
 
+    // bytes in use (including freed objects not yet compacted),
+    // and bytes allocated
+    unsigned int used() const { return _used; }
+    unsigned int size() const { return _size; }
+
 private:
     /* Checks that there is enough space. If not,
      * it compactifies, possibly moving objects.
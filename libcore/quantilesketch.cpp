@@ -0,0 +1,164 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Mergeable sketch for quantiles of a stream of values
+ */
+
+#include "quantilesketch.h"
+
+#include <algorithm>
+
+
+//---------------------------------------------------
+// QuantileSketch
+
+QuantileSketch::QuantileSketch(double compression)
+{
+    _compression = (compression < 10.0) ? 10.0 : compression;
+    _count = 0.0;
+    _min = _max = 0.0;
+}
+
+void QuantileSketch::clear()
+{
+    _count = 0.0;
+    _min = _max = 0.0;
+    _centroids.clear();
+    _buffer.clear();
+}
+
+void QuantileSketch::add(double value, double weight)
+{
+    if (weight <= 0.0) return;
+
+    if (_count == 0.0)
+        _min = _max = value;
+    else {
+        if (value < _min) _min = value;
+        if (value > _max) _max = value;
+    }
+    _count += weight;
+
+    Centroid c = { value, weight };
+    _buffer.append(c);
+    if (_buffer.count() >= 5 * _compression)
+        compress();
+}
+
+void QuantileSketch::merge(const QuantileSketch& s)
+{
+    if (s._count == 0.0) return;
+
+    if (_count == 0.0) {
+        _min = s._min;
+        _max = s._max;
+    }
+    else {
+        if (s._min < _min) _min = s._min;
+        if (s._max > _max) _max = s._max;
+    }
+    _count += s._count;
+
+    _buffer += s._centroids;
+    _buffer += s._buffer;
+    compress();
+}
+
+int QuantileSketch::size() const
+{
+    compress();
+    return _centroids.count();
+}
+
+/* Greedy merge of neighbouring centroids, sorted by mean. A merged
+ * centroid covering the quantile range [q0, q2] may have a weight of
+ * at most 4 * count * min(q0(1-q0), q2(1-q2)) / compression.
+ */
+void QuantileSketch::compress() const
+{
+    if (_buffer.isEmpty()) return;
+
+    QVector<Centroid> all = _centroids + _buffer;
+    _buffer.clear();
+    std::sort(all.begin(), all.end());
+
+    double total = 0.0;
+    foreach(const Centroid& c, all)
+        total += c.weight;
+
+    QVector<Centroid> res;
+    Centroid cur = all.at(0);
+    double soFar = 0.0;
+    for(int i=1; i<all.count(); i++) {
+        const Centroid& next = all.at(i);
+        double w = cur.weight + next.weight;
+        double q0 = soFar / total;
+        double q2 = (soFar + w) / total;
+        double limit = 4.0 * total *
+                       std::min(q0 * (1.0 - q0), q2 * (1.0 - q2)) /
+                       _compression;
+
+        if (w <= limit) {
+            cur.mean += (next.mean - cur.mean) * next.weight / w;
+            cur.weight = w;
+            continue;
+        }
+        res.append(cur);
+        soFar += cur.weight;
+        cur = next;
+    }
+    res.append(cur);
+
+    _centroids = res;
+}
+
+/* Linear interpolation between centroid means, which are assumed at
+ * the middle of their weight. Below the first and above the last
+ * centroid, interpolate to the exact minimum and maximum.
+ */
+double QuantileSketch::quantile(double q) const
+{
+    if (_count == 0.0) return 0.0;
+    if (q <= 0.0) return _min;
+    if (q >= 1.0) return _max;
+
+    compress();
+    if (_centroids.count() == 1) return _centroids.at(0).mean;
+
+    double rank = q * _count;
+    const Centroid& first = _centroids.first();
+    if (rank < first.weight / 2.0)
+        return _min + (first.mean - _min) * rank / (first.weight / 2.0);
+
+    double center = first.weight / 2.0;
+    for(int i=1; i<_centroids.count(); i++) {
+        const Centroid& prev = _centroids.at(i-1);
+        const Centroid& c = _centroids.at(i);
+        double nextCenter = center + (prev.weight + c.weight) / 2.0;
+        if (rank < nextCenter)
+            return prev.mean + (c.mean - prev.mean) *
+                   (rank - center) / (nextCenter - center);
+        center = nextCenter;
+    }
+
+    const Centroid& last = _centroids.last();
+    double rest = _count - center;
+    if (rest <= 0.0) return _max;
+    return last.mean + (_max - last.mean) * (rank - center) / rest;
+}
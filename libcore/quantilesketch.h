@@ -0,0 +1,74 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Mergeable sketch for quantiles of a stream of values
+ */
+
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <QVector>
+
+/**
+ * A merging t-digest: values are summarized by centroids (mean and
+ * weight), with small centroids near the ends of the distribution and
+ * larger ones in the middle. This gives good accuracy for extreme
+ * quantiles like P99 with a few hundred centroids for the default
+ * <compression>, growing only logarithmically with the number of
+ * values added.
+ *
+ * Sketches with the same compression can be merged, e.g. to combine
+ * results of parallel workers. Values added are buffered and
+ * merged into the centroids when the buffer is full, or on access.
+ */
+class QuantileSketch
+{
+public:
+    explicit QuantileSketch(double compression = 50.0);
+
+    void add(double value, double weight = 1.0);
+    void merge(const QuantileSketch&);
+    void clear();
+
+    // total weight of values added
+    double count() const { return _count; }
+    double min() const { return _min; }
+    double max() const { return _max; }
+    // estimated value at quantile <q> in [0, 1]; 0 if empty
+    double quantile(double q) const;
+
+    // number of centroids, for memory statistics
+    int size() const;
+
+private:
+    struct Centroid {
+        double mean, weight;
+        bool operator<(const Centroid& c) const { return mean < c.mean; }
+    };
+
+    // merge buffered values into centroids
+    void compress() const;
+
+    double _compression;
+    double _count, _min, _max;
+    // compress() is done lazily on read access
+    mutable QVector<Centroid> _centroids, _buffer;
+};
+
+#endif
@@ -26,12 +26,21 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QDebug>
+#include <QVarLengthArray>
 
 #include "logger.h"
 #include "loader.h"
 #include "globalconfig.h"
 #include "utils.h"
 #include "fixcost.h"
+#include "modelpruner.h"
+#include "groupcallgraph.h"
+#include "dominators.h"
+#include "computecache.h"
+#include "addressindex.h"
+#include "groupcosts.h"
+#include "fleetstats.h"
+#include "loadstats.h"
 
 
 #define TRACE_DEBUG      0
@@ -167,6 +176,13 @@ ProfileCostArray* TraceInclusiveCost::inclusive()
     return &_inclusive;
 }
 
+void TraceInclusiveCost::freeze()
+{
+    if (_frozen) return;
+    ProfileCostArray::freeze();
+    _inclusive.freeze();
+}
+
 void TraceInclusiveCost::addInclusive(ProfileCostArray* c)
 {
     _inclusive.addCost(c);
@@ -215,7 +231,8 @@ ProfileCostArray* TraceListCost::findDepFromPart(TracePart* part)
 
     foreach(ProfileCostArray* dep, _deps) {
         if (dep->part() == part) {
-            _lastDep = dep;
+            // no cache update allowed for concurrent readers
+            if (!_frozen) _lastDep = dep;
             return dep;
         }
     }
@@ -223,6 +240,14 @@ ProfileCostArray* TraceListCost::findDepFromPart(TracePart* part)
 }
 
 
+void TraceListCost::freeze()
+{
+    if (_frozen) return;
+    ProfileCostArray::freeze();
+    foreach(ProfileCostArray* item, _deps)
+        item->freeze();
+}
+
 void TraceListCost::update()
 {
     if (!_dirty) return;
@@ -233,12 +258,14 @@ void TraceListCost::update()
 #endif
 
     clear();
+    QVarLengthArray<ProfileCostArray*, 32> items;
     foreach(ProfileCostArray* item, _deps) {
         if (onlyActiveParts())
             if (!item->part() || !item->part()->isActive()) continue;
 
-        addCost(item);
+        items.append(item);
     }
+    addCosts(items.constData(), items.count());
 
     _dirty = false;
 
@@ -289,7 +316,8 @@ TraceJumpCost* TraceJumpListCost::findDepFromPart(TracePart* part)
 
     foreach(TraceJumpCost* dep, _deps) {
         if (dep->part() == part) {
-            _lastDep = dep;
+            // no cache update allowed for concurrent readers
+            if (!_frozen) _lastDep = dep;
             return dep;
         }
     }
@@ -297,6 +325,14 @@ TraceJumpCost* TraceJumpListCost::findDepFromPart(TracePart* part)
 }
 
 
+void TraceJumpListCost::freeze()
+{
+    if (_frozen) return;
+    TraceJumpCost::freeze();
+    foreach(TraceJumpCost* item, _deps)
+        item->freeze();
+}
+
 void TraceJumpListCost::update()
 {
     if (!_dirty) return;
@@ -363,7 +399,8 @@ TraceCallCost* TraceCallListCost::findDepFromPart(TracePart* part)
 
     foreach(TraceCallCost* dep, _deps) {
         if (dep->part() == part) {
-            _lastDep = dep;
+            // no cache update allowed for concurrent readers
+            if (!_frozen) _lastDep = dep;
             return dep;
         }
     }
@@ -371,6 +408,14 @@ TraceCallCost* TraceCallListCost::findDepFromPart(TracePart* part)
 }
 
 
+void TraceCallListCost::freeze()
+{
+    if (_frozen) return;
+    TraceCallCost::freeze();
+    foreach(TraceCallCost* item, _deps)
+        item->freeze();
+}
+
 void TraceCallListCost::update()
 {
     if (!_dirty) return;
@@ -384,13 +429,15 @@ void TraceCallListCost::update()
      * i.e. do not change cost */
     if (_deps.count()>0) {
         clear();
+        QVarLengthArray<ProfileCostArray*, 32> items;
         foreach(TraceCallCost* item, _deps) {
             if (onlyActiveParts())
                 if (!item->part() || !item->part()->isActive()) continue;
 
-            addCost(item);
+            items.append(item);
             addCallCount(item->callCount());
         }
+        addCosts(items.constData(), items.count());
     }
 
     _dirty = false;
@@ -442,13 +489,22 @@ TraceInclusiveCost* TraceInclusiveListCost::findDepFromPart(TracePart* part)
 
     foreach(TraceInclusiveCost* dep, _deps) {
         if (dep->part() == part) {
-            _lastDep = dep;
+            // no cache update allowed for concurrent readers
+            if (!_frozen) _lastDep = dep;
             return dep;
         }
     }
     return nullptr;
 }
 
+void TraceInclusiveListCost::freeze()
+{
+    if (_frozen) return;
+    TraceInclusiveCost::freeze();
+    foreach(TraceInclusiveCost* item, _deps)
+        item->freeze();
+}
+
 void TraceInclusiveListCost::update()
 {
     if (!_dirty) return;
@@ -459,13 +515,16 @@ void TraceInclusiveListCost::update()
 #endif
 
     clear();
+    QVarLengthArray<ProfileCostArray*, 32> items, inclusive;
     foreach(TraceInclusiveCost* item, _deps) {
         if (onlyActiveParts())
             if (!item->part() || !item->part()->isActive()) continue;
 
-        addCost(item);
-        addInclusive(item->inclusive());
+        items.append(item);
+        inclusive.append(item->inclusive());
     }
+    addCosts(items.constData(), items.count());
+    _inclusive.addCosts(inclusive.constData(), inclusive.count());
 
     _dirty = false;
 
@@ -948,7 +1007,8 @@ TraceInstrJump::~TraceInstrJump()
 
 TracePartInstrJump* TraceInstrJump::partInstrJump(TracePart* part)
 {
-    static TracePartInstrJump* item = nullptr;
+    // per thread, as profiles can be loaded in parallel
+    static thread_local TracePartInstrJump* item = nullptr;
 
     // shortcut if recently used
     if (item &&
@@ -2883,14 +2943,31 @@ QString TraceFile::prettyLongName() const
 
 TraceObject::TraceObject()
     : TraceCostItem(ProfileContext::context(ProfileContext::Object))
-{}
+{
+    _addressIndex = nullptr;
+}
 
 TraceObject::~TraceObject()
 {
+    delete _addressIndex;
+
     // we are the owner of items generated in our factory
     qDeleteAll(_deps);
 }
 
+AddressIndex* TraceObject::addressIndex()
+{
+    if (!_addressIndex)
+        _addressIndex = new AddressIndex(this);
+    return _addressIndex;
+}
+
+void TraceObject::invalidateAddressIndex()
+{
+    delete _addressIndex;
+    _addressIndex = nullptr;
+}
+
 TracePartObject* TraceObject::partObject(TracePart* part)
 {
     TracePartObject* item = (TracePartObject*) findDepFromPart(part);
@@ -2915,6 +2992,8 @@ void TraceObject::addFunction(TraceFunction* function)
 
     _functions.append(function);
 
+    invalidateAddressIndex();
+
     invalidate();
 
 #if TRACE_DEBUG
@@ -3081,11 +3160,32 @@ void TraceData::init()
     _fixPool = nullptr;
     _dynPool = nullptr;
 
+    _objectCallGraph = nullptr;
+    _classCallGraph = nullptr;
+    _fileCallGraph = nullptr;
+    _dominators = nullptr;
+    _computeCache = nullptr;
+    _groupCosts = nullptr;
+    _fleetStatistics = nullptr;
+    _fleetEventType = nullptr;
+    _loadStatistics = nullptr;
+    _pruner = nullptr;
+
     _arch = ArchUnknown;
 }
 
 TraceData::~TraceData()
 {
+    // cached results may refer to functions
+    delete _computeCache;
+    delete _objectCallGraph;
+    delete _classCallGraph;
+    delete _fileCallGraph;
+    delete _dominators;
+    delete _groupCosts;
+    delete _fleetStatistics;
+    delete _loadStatistics;
+
     qDeleteAll(_parts);
 
     delete _fixPool;
@@ -3155,17 +3255,32 @@ int TraceData::load(QStringList files)
         return 0;
     }
 
+    LoadStatistics* stats = newLoadStatistics();
+    double threshold = GlobalConfig::pruneThreshold();
+    if (threshold > 0.0) {
+        stats->startPhase(QStringLiteral("prune"));
+        _pruner = scanForPruning(files, nullptr, threshold);
+    }
+
     QStringList::const_iterator it;
     int partsLoaded = 0;
     for (it = files.constBegin(); it != files.constEnd(); ++it ) {
         QFile file(*it);
-        partsLoaded += internalLoad(&file, *it);
+        partsLoaded += internalLoad(&file, *it, stats);
+    }
+    delete _pruner;
+    _pruner = nullptr;
+
+    if (partsLoaded == 0) {
+        stats->finish();
+        return 0;
     }
-    if (partsLoaded == 0) return 0;
 
+    stats->startPhase(QStringLiteral("cycles"));
     std::sort(_parts.begin(), _parts.end(), partLessThan);
     invalidateDynamicCost();
     updateFunctionCycles();
+    stats->finish();
 
     return partsLoaded;
 }
@@ -3178,15 +3293,68 @@ int TraceData::load(QString file)
 int TraceData::load(QIODevice* file, const QString& filename)
 {
     _traceName = filename;
-    int partsLoaded = internalLoad(file, filename);
+
+    LoadStatistics* stats = newLoadStatistics();
+    // pruning needs to read the data twice
+    double threshold = GlobalConfig::pruneThreshold();
+    if ((threshold > 0.0) && !file->isSequential()) {
+        stats->startPhase(QStringLiteral("prune"));
+        _pruner = scanForPruning(QStringList(filename), file, threshold);
+    }
+
+    int partsLoaded = internalLoad(file, filename, stats);
+    delete _pruner;
+    _pruner = nullptr;
+
     if (partsLoaded>0) {
+        stats->startPhase(QStringLiteral("cycles"));
         invalidateDynamicCost();
         updateFunctionCycles();
     }
+    stats->finish();
     return partsLoaded;
 }
 
-int TraceData::internalLoad(QIODevice* device, const QString& filename)
+LoadStatistics* TraceData::newLoadStatistics()
+{
+    delete _loadStatistics;
+    _loadStatistics = new LoadStatistics();
+    return _loadStatistics;
+}
+
+/**
+ * Loads <files> (or <device> if given) into temporary data, with
+ * cost only summed up per function and call instead of creating
+ * FixCost items. Returns a ModelPruner in Prune mode, to be used
+ * while loading the same data again.
+ */
+ModelPruner* TraceData::scanForPruning(const QStringList& files,
+                                       QIODevice* device, double threshold)
+{
+    TraceData scan(_logger);
+    scan._pruner = new ModelPruner(threshold);
+    // statistics are only kept for the loading pass
+    LoadStatistics stats;
+
+    if (device) {
+        scan.internalLoad(device, files.first(), &stats);
+        if (device->isOpen()) device->close();
+    }
+    else {
+        foreach(const QString& name, files) {
+            QFile file(name);
+            scan.internalLoad(&file, name, &stats);
+        }
+    }
+
+    ModelPruner* pruner = scan._pruner;
+    scan._pruner = nullptr;
+    pruner->decide(&scan);
+    return pruner;
+}
+
+int TraceData::internalLoad(QIODevice* device, const QString& filename,
+                            LoadStatistics* stats)
 {
     if (!device->open( QIODevice::ReadOnly ) ) {
         _logger->loadStart(filename);
@@ -3194,7 +3362,8 @@ int TraceData::internalLoad(QIODevice* device, const QString& filename)
         return 0;
     }
 
-    Loader* l = Loader::matchingLoader(device);
+    // own instance, as other profiles may be loaded in parallel
+    Loader* l = Loader::createMatchingLoader(device);
     if (!l) {
         // special case empty file: ignore...
         if (device->size() == 0) return 0;
@@ -3204,10 +3373,13 @@ int TraceData::internalLoad(QIODevice* device, const QString& filename)
         return 0;
     }
     l->setLogger(_logger);
+    l->setStatistics(stats);
+    stats->addFile(filename, device->size());
+    stats->startPhase(QStringLiteral("parse"));
 
     int partsLoaded = l->load(this, device, filename);
 
-    l->setLogger(nullptr);
+    delete l;
 
     return partsLoaded;
 }
@@ -3215,6 +3387,7 @@ int TraceData::internalLoad(QIODevice* device, const QString& filename)
 bool TraceData::activateParts(const TracePartList& l)
 {
     bool changed = false;
+    if (_frozen) return false;
 
     foreach(TracePart* part, _parts)
         if (part->activate(l.contains(part)))
@@ -3234,6 +3407,7 @@ bool TraceData::activateParts(const TracePartList& l)
 bool TraceData::activateParts(TracePartList l, bool active)
 {
     bool changed = false;
+    if (_frozen) return false;
 
     foreach(TracePart* part, l) {
         if (_parts.contains(part))
@@ -3251,6 +3425,7 @@ bool TraceData::activateParts(TracePartList l, bool active)
 
 bool TraceData::activatePart(TracePart* p, bool active)
 {
+    if (_frozen) return false;
     return p->activate(active);
 }
 
@@ -3259,6 +3434,96 @@ bool TraceData::activateAll(bool active)
     return activateParts(_parts, active);
 }
 
+void TraceData::freeze()
+{
+    if (_frozen) return;
+
+    // derived event types parse their formula on first use, which
+    // would modify them from concurrent readers
+    EventTypeSet* m = eventTypes();
+    for (int i=0; i<m->derivedCount(); i++)
+        m->derivedType(i)->parseFormula();
+
+    // create lazily filled maps first, as this adds cost items
+    TraceFunctionMap::Iterator it;
+    for ( it = _functionMap.begin(); it != _functionMap.end(); ++it ) {
+        (*it).instrMap();
+        foreach(TraceFunctionSource* sf, (*it).sourceFiles())
+            sf->lineMap();
+    }
+
+    // calculates totals
+    ProfileCostArray::freeze();
+    _totals.freeze();
+    _callMax.freeze();
+
+    // all list cost items freeze the items they depend on
+    foreach(TracePart* part, _parts) {
+        part->freeze();
+        part->totals()->freeze();
+    }
+
+    TraceObjectMap::Iterator oit;
+    for ( oit = _objectMap.begin(); oit != _objectMap.end(); ++oit )
+        (*oit).freeze();
+    TraceClassMap::Iterator cit;
+    for ( cit = _classMap.begin(); cit != _classMap.end(); ++cit )
+        (*cit).freeze();
+    TraceFileMap::Iterator fit;
+    for ( fit = _fileMap.begin(); fit != _fileMap.end(); ++fit )
+        (*fit).freeze();
+
+    QList<TraceFunction*> functions;
+    for ( it = _functionMap.begin(); it != _functionMap.end(); ++it )
+        functions.append(&(*it));
+    foreach(TraceFunctionCycle* cycle, _functionCycles)
+        functions.append(cycle);
+
+    foreach(TraceFunction* f, functions) {
+        f->freeze();
+
+        foreach(TraceCall* call, f->callings()) {
+            call->freeze();
+            foreach(TraceLineCall* lc, call->lineCalls())
+                lc->freeze();
+            foreach(TraceInstrCall* ic, call->instrCalls())
+                ic->freeze();
+        }
+
+        foreach(TraceFunctionSource* sf, f->sourceFiles()) {
+            sf->freeze();
+            TraceLineMap* lineMap = sf->lineMap();
+            if (!lineMap) continue;
+            TraceLineMap::Iterator lit;
+            for ( lit = lineMap->begin(); lit != lineMap->end(); ++lit ) {
+                (*lit).freeze();
+                foreach(TraceLineJump* lj, (*lit).lineJumps())
+                    lj->freeze();
+            }
+        }
+
+        TraceInstrMap* instrMap = f->instrMap();
+        if (!instrMap) continue;
+        TraceInstrMap::Iterator iit;
+        for ( iit = instrMap->begin(); iit != instrMap->end(); ++iit ) {
+            (*iit).freeze();
+            foreach(TraceInstrJump* ij, (*iit).instrJumps())
+                ij->freeze();
+        }
+    }
+
+    // on-demand aggregates and analyses, which then stay valid.
+    // Creating them here publishes them before any concurrent reader
+    groupCosts()->update();
+    groupCallGraph(ProfileContext::Object)->update();
+    groupCallGraph(ProfileContext::Class)->update();
+    groupCallGraph(ProfileContext::File)->update();
+    dominators()->calculate();
+    computeCache();
+    for ( oit = _objectMap.begin(); oit != _objectMap.end(); ++oit )
+        (*oit).addressIndex();
+}
+
 void TraceData::addPart(TracePart* part)
 {
     if (_parts.contains(part)>0) return;
@@ -3269,6 +3534,12 @@ void TraceData::addPart(TracePart* part)
         part->setPartNumber(_maxPartNumber);
     }
     _parts.append(part);
+
+    TraceObjectMap::Iterator oit;
+    for ( oit = _objectMap.begin(); oit != _objectMap.end(); ++oit )
+        (*oit).invalidateAddressIndex();
+    delete _fleetStatistics;
+    _fleetStatistics = nullptr;
 }
 
 TracePart* TraceData::partWithName(const QString& name)
@@ -3307,12 +3578,17 @@ QString TraceData::activePartRange()
 
 void TraceData::invalidateDynamicCost()
 {
+    // frozen costs and derived data stay valid forever
+    if (_frozen) return;
+
     // invalidate all dynamic costs
 
     TraceObjectMap::Iterator oit;
     for ( oit = _objectMap.begin();
-          oit != _objectMap.end(); ++oit )
+          oit != _objectMap.end(); ++oit ) {
         (*oit).invalidate();
+        (*oit).invalidateAddressIndex();
+    }
 
     TraceClassMap::Iterator cit;
     for ( cit = _classMap.begin();
@@ -3330,6 +3606,13 @@ void TraceData::invalidateDynamicCost()
         (*it).invalidateDynamicCost();
     }
 
+    if (_objectCallGraph) _objectCallGraph->invalidate();
+    if (_classCallGraph) _classCallGraph->invalidate();
+    if (_fileCallGraph) _fileCallGraph->invalidate();
+    if (_dominators) _dominators->invalidate();
+    if (_computeCache) _computeCache->invalidate();
+    if (_groupCosts) _groupCosts->invalidate();
+
     invalidate();
 
 }
@@ -3445,6 +3728,12 @@ TraceFunction* TraceData::function(const QString& name,
     // The change was motivated by bug ID 3014067 (on SourceForge).
     QString key = name + file->shortName() + object->shortName();
 
+    // while loading with pruning, small functions become "(other)"
+    if (_pruner) {
+        TraceFunction* other = _pruner->fold(this, key, object);
+        if (other) return other;
+    }
+
     TraceFunctionMap::Iterator it;
     it = _functionMap.find(key);
     if (it == _functionMap.end()) {
@@ -3468,6 +3757,8 @@ TraceFunction* TraceData::function(const QString& name,
         c->addFunction(&f);
         object->addFunction(&f);
         file->addFunction(&f);
+
+        if (_pruner) _pruner->added(&f, key);
     }
 
     return &(it.value());
@@ -3738,15 +4029,67 @@ void TraceData::updateFunctionCycles()
 
 void TraceData::updateObjectCycles()
 {
+    groupCallGraph(ProfileContext::Object)->update();
 }
 
 
 void TraceData::updateClassCycles()
 {
+    groupCallGraph(ProfileContext::Class)->update();
 }
 
 
 void TraceData::updateFileCycles()
 {
+    groupCallGraph(ProfileContext::File)->update();
+}
+
+GroupCallGraph* TraceData::groupCallGraph(ProfileContext::Type t)
+{
+    GroupCallGraph** g;
+    switch(t) {
+    case ProfileContext::Object: g = &_objectCallGraph; break;
+    case ProfileContext::Class:  g = &_classCallGraph; break;
+    case ProfileContext::File:   g = &_fileCallGraph; break;
+    default: return nullptr;
+    }
+
+    if (!*g)
+        *g = new GroupCallGraph(this, t);
+    return *g;
+}
+
+Dominators* TraceData::dominators()
+{
+    if (!_dominators)
+        _dominators = new Dominators(this);
+    return _dominators;
+}
+
+ComputeCache* TraceData::computeCache()
+{
+    if (!_computeCache)
+        _computeCache = new ComputeCache(this);
+    return _computeCache;
+}
+
+GroupCosts* TraceData::groupCosts()
+{
+    if (!_groupCosts)
+        _groupCosts = new GroupCosts(this);
+    return _groupCosts;
+}
+
+FleetStatistics* TraceData::fleetStatistics(EventType* t, bool create)
+{
+    if (_fleetStatistics && (_fleetEventType == t))
+        return _fleetStatistics;
+    if (!create) return nullptr;
+
+    delete _fleetStatistics;
+    _fleetStatistics = new FleetStatistics();
+    _fleetEventType = t;
+    _fleetStatistics->addParts(this, t);
+    return _fleetStatistics;
 }
 
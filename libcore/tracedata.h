@@ -37,6 +37,14 @@
 #include "eventtype.h"
 
 class QFile;
+class GroupCallGraph;
+class Dominators;
+class ComputeCache;
+class GroupCosts;
+class FleetStatistics;
+class LoadStatistics;
+class ModelPruner;
+class AddressIndex;
 
 /**
  * All cost items are classes prefixed with "Trace".
@@ -262,6 +270,8 @@ public:
     ProfileCostArray* inclusive();
     void addInclusive(ProfileCostArray*);
 
+    void freeze() override;
+
 protected:
     ProfileCostArray _inclusive;
 };
@@ -279,6 +289,7 @@ public:
 
     // reimplementation for dependency list
     void update() override;
+    void freeze() override;
 
     TraceCostList& deps() { return _deps; }
     void addDep(ProfileCostArray*);
@@ -308,6 +319,7 @@ public:
 
     // reimplementation for dependency list
     void update() override;
+    void freeze() override;
 
     TraceJumpCostList deps() { return _deps; }
     void addDep(TraceJumpCost*);
@@ -339,6 +351,7 @@ public:
 
     // reimplementation for dependency list
     void update() override;
+    void freeze() override;
 
     TraceCallCostList deps() { return _deps; }
     void addDep(TraceCallCost*);
@@ -367,6 +380,7 @@ public:
 
     // reimplementation for dependency
     void update() override;
+    void freeze() override;
 
     TraceInclusiveCostList deps() { return _deps; }
     void addDep(TraceInclusiveCost*);
@@ -1347,9 +1361,15 @@ public:
     // part factory
     TracePartObject* partObject(TracePart*);
 
+    // address ranges of functions (created on demand)
+    AddressIndex* addressIndex();
+    // ranges have to be recalculated, e.g. after adding parts
+    void invalidateAddressIndex();
+
 private:
     TraceFunctionList _functions;
     QString _dir;
+    AddressIndex* _addressIndex;
 };
 
 
@@ -1382,6 +1402,11 @@ public:
     int load(QString file);
     int load(QIODevice*, const QString&);
 
+    // diagnostics and timing of last load() call
+    LoadStatistics* loadStatistics() { return _loadStatistics; }
+    // set while loading with pruning, for loaders (see ModelPruner)
+    ModelPruner* pruner() const { return _pruner; }
+
     /** returns true if something changed. These do NOT
      * invalidate the dynamic costs on a activation change,
      * i.e. all cost items depends on active parts.
@@ -1393,6 +1418,25 @@ public:
     bool activatePart(TracePart*, bool active);
     bool activateAll(bool active=true);
 
+    /**
+     * Snapshot mode: calculate all costs of the current part
+     * activation, including source line and instruction level items
+     * and the group aggregates, and freeze all cost items.
+     * Afterwards, cost accessors of the data model do not modify
+     * anything, and can be used concurrently from multiple threads
+     * without locking. There is no way back: activation changes are
+     * refused. Group costs, group call graphs, dominators, address
+     * indexes and the compute cache are created here, too, and then
+     * also can be used concurrently. Coverage has to be calculated
+     * without associations (Coverage::coverage() with a result map).
+     * fleetStatistics() replaces its result per event type, so it
+     * still is to be used from one thread.
+     * Formulas of derived event types are parsed here; for types
+     * added afterwards, call EventType::parseFormula() before
+     * concurrent use.
+     */
+    void freeze() override;
+
     // to be used by loader
     void addPart(TracePart*);
 
@@ -1444,6 +1488,18 @@ public:
 
     const TraceFunctionCycleList& functionCycles() { return _functionCycles; }
 
+    // calls aggregated to Object, File or Class level, with group cycles
+    GroupCallGraph* groupCallGraph(ProfileContext::Type);
+    // dominator tree of call graph with dominated cost (cached)
+    Dominators* dominators();
+    // derived data shared among views (cached)
+    ComputeCache* computeCache();
+    // self cost of all objects, files and classes (cached)
+    GroupCosts* groupCosts();
+    // percentiles of function costs with parts as hosts (cached).
+    // Without <create>, returns nullptr if not calculated yet
+    FleetStatistics* fleetStatistics(EventType*, bool create = true);
+
     ProfileCostArray* callMax() { return &_callMax; }
     SubCost maxCallCount() { return _maxCallCount; }
     void updateMaxCallCount(SubCost);
@@ -1466,7 +1522,7 @@ public:
     // invalidates all cost items dependent on active state of parts
     void invalidateDynamicCost();
 
-    // cycle detection
+    // cycle detection (for groups: see groupCallGraph)
     void updateFunctionCycles();
     void updateObjectCycles();
     void updateClassCycles();
@@ -1476,7 +1532,12 @@ public:
 private:
     void init();
     // add profile parts from one file
-    int internalLoad(QIODevice* file, const QString& filename);
+    int internalLoad(QIODevice* file, const QString& filename,
+                     LoadStatistics* stats);
+    LoadStatistics* newLoadStatistics();
+    // pass 1 of pruning: sum up costs of <files> per function and call
+    ModelPruner* scanForPruning(const QStringList& files, QIODevice* device,
+                                double threshold);
 
     // for notification callbacks
     Logger* _logger;
@@ -1501,6 +1562,8 @@ private:
     QString _command;
     Arch _arch;
     QString _traceName;
+    LoadStatistics* _loadStatistics;
+    ModelPruner* _pruner;
 
     // Max of all costs of calls: This allows to see if the incl. cost can
     // be hidden for a cost type, as it is always the same as self cost
@@ -1511,6 +1574,16 @@ private:
     TraceFunctionCycleList _functionCycles;
     int _functionCycleCount;
     bool _inFunctionCycleUpdate;
+
+    // created on demand, invalidated with dynamic cost
+    GroupCallGraph* _objectCallGraph;
+    GroupCallGraph* _classCallGraph;
+    GroupCallGraph* _fileCallGraph;
+    Dominators* _dominators;
+    ComputeCache* _computeCache;
+    GroupCosts* _groupCosts;
+    FleetStatistics* _fleetStatistics;
+    EventType* _fleetEventType;
 };
 
 
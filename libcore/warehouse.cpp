@@ -0,0 +1,420 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Warehouse: summaries of many profile runs for trend queries
+ */
+
+#include "warehouse.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include <QDir>
+
+#include "tracedata.h"
+
+
+// order of movers: largest absolute change first
+class MoverGreater
+{
+public:
+    bool operator()(const WarehouseMover& m1, const WarehouseMover& m2) const
+    {
+        return delta(m1) > delta(m2);
+    }
+
+    static quint64 delta(const WarehouseMover& m)
+    {
+        return (m.to > m.from) ? (uint64) m.to - (uint64) m.from
+                               : (uint64) m.from - (uint64) m.to;
+    }
+};
+
+// function with its id, to sort by id when writing a run
+class WarehouseEntry
+{
+public:
+    quint32 id;
+    TraceFunction* function;
+
+    bool operator<(const WarehouseEntry& e) const { return id < e.id; }
+};
+
+// line in a text file may not contain tabs or newlines
+static QString cleanField(QString s)
+{
+    s.replace('\t', ' ');
+    s.replace('\n', ' ');
+    return s;
+}
+
+
+//---------------------------------------------------
+// Warehouse::Block
+
+int Warehouse::Block::eventSlot(int event) const
+{
+    for(int i=0; i<eventCount; i++)
+        if (events[i] == (quint32) event) return i;
+    return -1;
+}
+
+const quint64* Warehouse::Block::column(Warehouse::Metric m, int slot) const
+{
+    int c = (m == Warehouse::Calls) ? 2 * eventCount : 2 * slot + (int) m;
+    return columns + c * functionCount;
+}
+
+// index of function, -1 if not found
+qint64 Warehouse::Block::find(int function) const
+{
+    const quint32* end = functions + functionCount;
+    const quint32* f = std::lower_bound(functions, end, (quint32) function);
+    if ((f == end) || (*f != (quint32) function)) return -1;
+    return f - functions;
+}
+
+
+//---------------------------------------------------
+// Warehouse
+
+Warehouse::Warehouse(const QString& dir)
+{
+    _dir = dir;
+    _map = nullptr;
+    _mapSize = 0;
+}
+
+Warehouse::~Warehouse()
+{
+    if (_map) _data.unmap((uchar*) _map);
+}
+
+bool Warehouse::readLines(const QString& name, QStringList& lines,
+                          QString* error)
+{
+    lines.clear();
+    QFile file(_dir + '/' + name);
+    if (!file.exists()) return true;
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.fileName() + ": " + file.errorString();
+        return false;
+    }
+    while (!file.atEnd()) {
+        QByteArray l = file.readLine();
+        if (l.endsWith('\n')) l.chop(1);
+        lines.append(QString::fromUtf8(l));
+    }
+    return true;
+}
+
+bool Warehouse::appendLines(const QString& name, const QStringList& lines,
+                            QString* error)
+{
+    if (lines.isEmpty()) return true;
+
+    QFile file(_dir + '/' + name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        if (error) *error = file.fileName() + ": " + file.errorString();
+        return false;
+    }
+    QByteArray b;
+    foreach(const QString& l, lines)
+        b += l.toUtf8() + '\n';
+    if (file.write(b) != b.size()) {
+        if (error) *error = file.fileName() + ": " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool Warehouse::mapData(QString* error)
+{
+    if (_map) {
+        _data.unmap((uchar*) _map);
+        _map = nullptr;
+        _mapSize = 0;
+    }
+    _data.close();
+    _data.setFileName(_dir + QStringLiteral("/data"));
+    if (!_data.exists() || (_data.size() == 0)) return true;
+
+    if (!_data.open(QIODevice::ReadOnly)) {
+        if (error) *error = _data.fileName() + ": " + _data.errorString();
+        return false;
+    }
+    _mapSize = _data.size();
+    _map = _data.map(0, _mapSize);
+    if (!_map) {
+        if (error) *error = _data.fileName() + ": " + _data.errorString();
+        _mapSize = 0;
+        return false;
+    }
+    return true;
+}
+
+bool Warehouse::open(QString* error)
+{
+    if (!QDir().mkpath(_dir)) {
+        if (error) *error = QObject::tr("Cannot create directory %1").arg(_dir);
+        return false;
+    }
+
+    QStringList runs;
+    if (!readLines(QStringLiteral("functions"), _functions, error) ||
+        !readLines(QStringLiteral("events"), _events, error) ||
+        !readLines(QStringLiteral("runs"), runs, error))
+        return false;
+
+    _functionIds.clear();
+    for(int i=0; i<_functions.count(); i++)
+        _functionIds.insert(_functions.at(i), i);
+
+    _runs.clear();
+    foreach(const QString& l, runs) {
+        QStringList f = l.split('\t');
+        if (f.count() < 5) continue;
+        WarehouseRun r;
+        r.offset = f[0].toULongLong();
+        r.time = QDateTime::fromSecsSinceEpoch(f[1].toLongLong());
+        r.parts = f[2].toInt();
+        r.traceName = f[3];
+        r.command = f[4];
+        _runs.append(r);
+    }
+
+    return mapData(error);
+}
+
+QString Warehouse::functionName(int id) const
+{
+    QStringList f = _functions.value(id).split('\t');
+    QString name = f[0];
+    QStringList location;
+    for(int i=1; i<f.count(); i++)
+        if (!f[i].isEmpty()) location << f[i];
+    if (location.isEmpty()) return name;
+    return QStringLiteral("%1 (%2)").arg(name).arg(location.join(QStringLiteral(", ")));
+}
+
+QList<int> Warehouse::findFunctions(const QString& name) const
+{
+    QList<int> res;
+    QString prefix = name + '\t';
+    for(int i=0; i<_functions.count(); i++)
+        if (_functions.at(i).startsWith(prefix))
+            res.append(i);
+    return res;
+}
+
+bool Warehouse::block(int run, Block* b) const
+{
+    if ((run < 0) || (run >= _runs.count()) || !_map) return false;
+
+    quint64 offset = _runs.at(run).offset;
+    if (offset + sizeof(WarehouseBlock) > (quint64) _mapSize) return false;
+    const WarehouseBlock* h = (const WarehouseBlock*) (_map + offset);
+    if ((memcmp(h->magic, WAREHOUSE_MAGIC, 8) != 0) ||
+        (h->byteOrder != WAREHOUSE_BYTEORDER)) return false;
+
+    quint64 pos = offset + sizeof(WarehouseBlock);
+    b->eventCount = h->eventCount;
+    b->functionCount = h->functionCount;
+    b->events = (const quint32*) (_map + pos);
+    pos += h->eventCount * sizeof(quint32);
+    if (pos % 8) pos += 8 - (pos % 8);
+    b->functions = (const quint32*) (_map + pos);
+    pos += h->functionCount * sizeof(quint32);
+    if (pos % 8) pos += 8 - (pos % 8);
+    b->columns = (const quint64*) (_map + pos);
+    pos += (2 * h->eventCount + 1) * h->functionCount * sizeof(quint64);
+
+    return pos <= (quint64) _mapSize;
+}
+
+bool Warehouse::value(int run, int function, Metric m, int event,
+                      SubCost* v) const
+{
+    Block b;
+    if (!block(run, &b)) return false;
+
+    int slot = b.eventSlot(event);
+    if ((m != Calls) && (slot < 0)) return false;
+    qint64 i = b.find(function);
+    if (i < 0) return false;
+
+    *v = b.column(m, slot)[i];
+    return true;
+}
+
+QList<WarehouseMover> Warehouse::topMovers(int run1, int run2, Metric m,
+                                           int event, int count) const
+{
+    QList<WarehouseMover> res;
+    Block b1, b2;
+    if (!block(run1, &b1) || !block(run2, &b2)) return res;
+    int slot1 = b1.eventSlot(event);
+    int slot2 = b2.eventSlot(event);
+    if ((m != Calls) && ((slot1 < 0) || (slot2 < 0))) return res;
+
+    const quint64* c1 = b1.column(m, slot1);
+    const quint64* c2 = b2.column(m, slot2);
+
+    // merge sorted function ids of both runs
+    QVector<WarehouseMover> movers;
+    quint64 i1 = 0, i2 = 0;
+    while ((i1 < b1.functionCount) || (i2 < b2.functionCount)) {
+        WarehouseMover mv;
+        if ((i2 == b2.functionCount) ||
+            ((i1 < b1.functionCount) && (b1.functions[i1] < b2.functions[i2]))) {
+            mv.function = b1.functions[i1];
+            mv.from = c1[i1++];
+            mv.to = 0;
+        }
+        else if ((i1 == b1.functionCount) ||
+                 (b2.functions[i2] < b1.functions[i1])) {
+            mv.function = b2.functions[i2];
+            mv.from = 0;
+            mv.to = c2[i2++];
+        }
+        else {
+            mv.function = b1.functions[i1];
+            mv.from = c1[i1++];
+            mv.to = c2[i2++];
+        }
+        if ((uint64) mv.from == (uint64) mv.to) continue;
+        movers.append(mv);
+    }
+
+    if (count > movers.count()) count = movers.count();
+    std::partial_sort(movers.begin(), movers.begin() + count, movers.end(),
+                      MoverGreater());
+    for(int i=0; i<count; i++)
+        res.append(movers.at(i));
+
+    return res;
+}
+
+bool Warehouse::addRun(TraceData* d, QString* error)
+{
+    EventTypeSet* m = d->eventTypes();
+    int eventCount = m->realCount();
+
+    // intern event types and functions
+    QStringList newEvents, newFunctions;
+    QVector<quint32> events(eventCount);
+    for(int e=0; e<eventCount; e++) {
+        QString name = cleanField(m->realType(e)->name());
+        int id = _events.indexOf(name);
+        if (id < 0) {
+            id = _events.count();
+            _events.append(name);
+            newEvents.append(name);
+        }
+        events[e] = id;
+    }
+
+    QVector<WarehouseEntry> entries;
+    TraceFunctionMap::Iterator it;
+    for ( it = d->functionMap().begin(); it != d->functionMap().end(); ++it ) {
+        TraceFunction* f = &(*it);
+        bool hasCost = (f->calledCount() > 0);
+        for(int e=0; !hasCost && (e<eventCount); e++)
+            hasCost = (f->inclusive()->subCost(m->realType(e)) > 0);
+        if (!hasCost) continue;
+
+        // file needed to distinguish static functions with same name
+        QString key = cleanField(f->name()) + '\t' +
+                      (f->object() ? cleanField(f->object()->shortName()) : QString()) +
+                      '\t' +
+                      (f->file() ? cleanField(f->file()->shortName()) : QString());
+        int id = _functionIds.value(key, -1);
+        if (id < 0) {
+            id = _functions.count();
+            _functions.append(key);
+            _functionIds.insert(key, id);
+            newFunctions.append(key);
+        }
+        WarehouseEntry entry;
+        entry.id = id;
+        entry.function = f;
+        entries.append(entry);
+    }
+    std::sort(entries.begin(), entries.end());
+
+    int fcount = entries.count();
+    QVector<quint32> functions(fcount);
+    QVector<quint64> columns((2 * eventCount + 1) * fcount);
+    for(int i=0; i<fcount; i++) {
+        TraceFunction* f = entries.at(i).function;
+        functions[i] = entries.at(i).id;
+        for(int e=0; e<eventCount; e++) {
+            EventType* et = m->realType(e);
+            columns[(2*e) * fcount + i] = f->subCost(et);
+            columns[(2*e+1) * fcount + i] = f->inclusive()->subCost(et);
+        }
+        columns[2 * eventCount * fcount + i] = f->calledCount();
+    }
+
+    WarehouseBlock h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, WAREHOUSE_MAGIC, 8);
+    h.byteOrder = WAREHOUSE_BYTEORDER;
+    h.eventCount = eventCount;
+    h.functionCount = fcount;
+
+    // names first: a run only may reference known ids
+    if (!appendLines(QStringLiteral("events"), newEvents, error) ||
+        !appendLines(QStringLiteral("functions"), newFunctions, error))
+        return false;
+
+    QFile file(_dir + QStringLiteral("/data"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        if (error) *error = file.fileName() + ": " + file.errorString();
+        return false;
+    }
+    static const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    quint64 offset = file.size();
+    QByteArray b((const char*) &h, sizeof(h));
+    b.append((const char*) events.constData(), eventCount * sizeof(quint32));
+    if (b.size() % 8) b.append(zeros, 8 - (b.size() % 8));
+    b.append((const char*) functions.constData(), fcount * sizeof(quint32));
+    if (b.size() % 8) b.append(zeros, 8 - (b.size() % 8));
+    b.append((const char*) columns.constData(), columns.count() * sizeof(quint64));
+    if (file.write(b) != b.size()) {
+        if (error) *error = file.fileName() + ": " + file.errorString();
+        return false;
+    }
+    file.close();
+
+    WarehouseRun r;
+    r.offset = offset;
+    r.time = QDateTime::currentDateTime();
+    r.parts = d->parts().count();
+    r.traceName = cleanField(d->shortTraceName());
+    r.command = cleanField(d->command());
+    QString line = QStringLiteral("%1\t%2\t%3\t%4\t%5")
+                   .arg(r.offset).arg(r.time.toSecsSinceEpoch()).arg(r.parts)
+                   .arg(r.traceName).arg(r.command);
+    if (!appendLines(QStringLiteral("runs"), QStringList(line), error))
+        return false;
+    _runs.append(r);
+
+    return mapData(error);
+}
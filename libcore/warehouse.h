@@ -0,0 +1,162 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Warehouse: summaries of many profile runs for trend queries
+ */
+
+#ifndef WAREHOUSE_H
+#define WAREHOUSE_H
+
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "subcost.h"
+
+class TraceData;
+
+/**
+ * A warehouse is a directory with per-function summaries of
+ * profile runs, e.g. from nightly runs of the same program, to
+ * query trends without keeping the profile data files:
+ *
+ *  - "functions": interned function keys, one per line (UTF-8):
+ *    tab separated name, object and source file (keeping static
+ *    functions with same name apart). The line number is the
+ *    function id.
+ *  - "events": interned event type names, one per line.
+ *  - "runs": one line per run, tab separated: offset of the run
+ *    block in "data", time of adding (seconds since epoch),
+ *    number of parts, trace name and command.
+ *  - "data": run blocks, appended for each run.
+ *
+ * A run block starts with a WarehouseBlock header, followed by the
+ * event ids and the sorted function ids of the run, and then by
+ * columns of 64bit values with one entry per function: exclusive
+ * and inclusive cost for each event, and finally the call count.
+ * Arrays are 8-byte aligned. Only functions with cost are stored.
+ *
+ * Queries memory map "data". Sorted function ids allow binary
+ * search in each run and merging of two runs.
+ * Warehouse files are only valid for hosts with the byte order
+ * they were written with.
+ */
+
+#define WAREHOUSE_MAGIC "KCGRUNS1"
+#define WAREHOUSE_BYTEORDER 0x01020304
+
+struct WarehouseBlock {
+    char magic[8];
+    quint32 byteOrder;
+    quint32 eventCount;
+    quint64 functionCount;
+};
+
+class WarehouseRun
+{
+public:
+    quint64 offset;
+    QDateTime time;
+    int parts;
+    QString traceName, command;
+};
+
+class WarehouseMover
+{
+public:
+    int function;
+    SubCost from, to;
+};
+
+class Warehouse
+{
+public:
+    enum Metric { Exclusive = 0, Inclusive, Calls };
+
+    explicit Warehouse(const QString& dir);
+    ~Warehouse();
+
+    // read index files, creating an empty warehouse if needed
+    bool open(QString* error = nullptr);
+    // append summary of profile data <d> as new run
+    bool addRun(TraceData* d, QString* error = nullptr);
+
+    int runCount() const { return _runs.count(); }
+    const WarehouseRun& run(int i) const { return _runs.at(i); }
+
+    int functionCount() const { return _functions.count(); }
+    QString functionName(int id) const;
+    // ids of functions with given name, in all ELF objects
+    QList<int> findFunctions(const QString& name) const;
+
+    QStringList events() const { return _events; }
+    // -1 if unknown
+    int eventId(const QString& name) const { return _events.indexOf(name); }
+
+    /**
+     * Value of a metric of <function> in <run>. For exclusive and
+     * inclusive metric, <event> is the event id.
+     * Returns false if the function has no cost in the run.
+     */
+    bool value(int run, int function, Metric m, int event,
+               SubCost* v) const;
+
+    /**
+     * The <count> functions with largest absolute change of the metric
+     * from run <run1> to run <run2>, largest first.
+     */
+    QList<WarehouseMover> topMovers(int run1, int run2, Metric m,
+                                    int event, int count) const;
+
+private:
+    // columns of a run block
+    class Block {
+    public:
+        int eventCount;
+        quint64 functionCount;
+        const quint32* events;
+        const quint32* functions;
+        const quint64* columns;
+
+        int eventSlot(int event) const;
+        const quint64* column(Warehouse::Metric m, int slot) const;
+        qint64 find(int function) const;
+    };
+
+    bool block(int run, Block* b) const;
+    bool readLines(const QString& name, QStringList& lines, QString* error);
+    bool appendLines(const QString& name, const QStringList& lines,
+                     QString* error);
+    bool mapData(QString* error);
+
+    QString _dir;
+    QStringList _functions, _events;
+    QHash<QString, int> _functionIds;
+    QList<WarehouseRun> _runs;
+
+    QFile _data;
+    const uchar* _map;
+    qint64 _mapSize;
+};
+
+#endif
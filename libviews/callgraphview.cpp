@@ -52,6 +52,7 @@
 #include "config.h"
 #include "globalguiconfig.h"
 #include "listutils.h"
+#include "groupcallgraph.h"
 
 
 #define DEBUG_GRAPH 0
@@ -65,6 +66,7 @@
 #define DEFAULT_SHOWSKIPPED   false
 #define DEFAULT_EXPANDCYCLES  false
 #define DEFAULT_CLUSTERGROUPS false
+#define DEFAULT_GROUPGRAPH    false
 #define DEFAULT_DETAILLEVEL   1
 #define DEFAULT_LAYOUT        GraphOptions::TopDown
 #define DEFAULT_ZOOMPOS       Auto
@@ -136,6 +138,7 @@ public:
 GraphNode::GraphNode()
 {
     _f=nullptr;
+    _group = nullptr;
     self = incl = 0;
     _cn = nullptr;
 
@@ -405,6 +408,7 @@ TraceCall* GraphNode::priorVisibleCallee(GraphEdge* e)
 GraphEdge::GraphEdge()
 {
     _c=nullptr;
+    _groupEdge = nullptr;
     _from = _to = nullptr;
     _fromNode = _toNode = nullptr;
     cost = count = 0;
@@ -419,6 +423,11 @@ QString GraphEdge::prettyName()
     if (_c)
         return _c->prettyName();
 
+    if (_groupEdge)
+        return QObject::tr("Calls from %1 to %2")
+                .arg(_groupEdge->caller()->prettyName())
+                .arg(_groupEdge->called()->prettyName());
+
     if (_from)
         return QObject::tr("Call(s) from %1").arg(_from->prettyName());
 
@@ -520,6 +529,7 @@ StorableGraphOptions::StorableGraphOptions()
     _maxCalleeDepth    = DEFAULT_MAXCALLEE;
     _showSkipped       = DEFAULT_SHOWSKIPPED;
     _expandCycles      = DEFAULT_EXPANDCYCLES;
+    _groupGraph        = DEFAULT_GROUPGRAPH;
     _detailLevel       = DEFAULT_DETAILLEVEL;
     _layout            = DEFAULT_LAYOUT;
 }
@@ -536,6 +546,7 @@ GraphExporter::GraphExporter()
     _go = this;
     _tmpFile = nullptr;
     _item = nullptr;
+    _data = nullptr;
     reset(nullptr, nullptr, nullptr, ProfileContext::InvalidType, QString());
 }
 
@@ -546,6 +557,7 @@ GraphExporter::GraphExporter(TraceData* d, TraceFunction* f,
     _go = this;
     _tmpFile = nullptr;
     _item = nullptr;
+    _data = nullptr;
     reset(d, f, ct, gt, filename);
 }
 
@@ -560,12 +572,14 @@ GraphExporter::~GraphExporter()
 }
 
 
-void GraphExporter::reset(TraceData*, CostItem* i, EventType* ct,
+void GraphExporter::reset(TraceData* d, CostItem* i, EventType* ct,
                           ProfileContext::Type gt, QString filename)
 {
     _graphCreated = false;
     _nodeMap.clear();
     _edgeMap.clear();
+    _groupNodeMap.clear();
+    _groupEdgeMap.clear();
 
     if (_item && _tmpFile) {
         _tmpFile->setAutoRemove(true);
@@ -584,6 +598,7 @@ void GraphExporter::reset(TraceData*, CostItem* i, EventType* ct,
     }
 
     _item = i;
+    _data = d;
     _eventType = ct;
     _groupType = gt;
     if (!i)
@@ -612,6 +627,35 @@ void GraphExporter::setGraphOptions(GraphOptions* go)
     _go = go;
 }
 
+bool GraphExporter::isGroupGraph()
+{
+    if (!_go->groupGraph()) return false;
+
+    return (_groupType == ProfileContext::Object) ||
+           (_groupType == ProfileContext::File) ||
+           (_groupType == ProfileContext::Class);
+}
+
+TraceCostItem* GraphExporter::group(TraceFunction* f)
+{
+    if (!f)
+        return nullptr;
+
+    switch (_groupType) {
+    case ProfileContext::Object:
+        return f->object();
+    case ProfileContext::Class:
+        return f->cls();
+    case ProfileContext::File:
+        return f->file();
+    case ProfileContext::FunctionCycle:
+        return f->cycle();
+    default:
+        break;
+    }
+    return nullptr;
+}
+
 void GraphExporter::createGraph()
 {
     if (!_item)
@@ -620,6 +664,11 @@ void GraphExporter::createGraph()
         return;
     _graphCreated = true;
 
+    if (isGroupGraph()) {
+        createGroupGraph();
+        return;
+    }
+
     if ((_item->type() == ProfileContext::Function) ||(_item->type()
                                                        == ProfileContext::FunctionCycle)) {
         TraceFunction* f = (TraceFunction*) _item;
@@ -661,6 +710,48 @@ void GraphExporter::createGraph()
     }
 }
 
+/* The group call graph always is complete, only limited by inclusive
+ * cost of groups relative to total cost.
+ */
+void GraphExporter::createGroupGraph()
+{
+    GroupCallGraph* g = _data ? _data->groupCallGraph(_groupType) : nullptr;
+    if (!g)
+        return;
+
+    double total = _data->subCost(_eventType);
+    _realFuncLimit = total * _go->funcLimit();
+    _realCallLimit = _realFuncLimit * _go->callLimit();
+
+    foreach(GroupCallEdge* ge, g->edges()) {
+        QPair<TraceCostItem*,TraceCostItem*> p(ge->caller(), ge->called());
+        GraphEdge& e = _groupEdgeMap[p];
+        e.setGroupEdge(ge);
+        e.cost = ge->subCost(_eventType);
+        e.count = ge->callCount();
+
+        _groupNodeMap[p.first].setGroup(p.first);
+        _groupNodeMap[p.second].setGroup(p.second);
+    }
+
+    // group of active function is shown even without calls
+    TraceFunction* f;
+    if (_item->type() == ProfileContext::Call)
+        f = ((TraceCall*)_item)->caller(true);
+    else
+        f = (TraceFunction*) _item;
+    TraceCostItem* active = group(f);
+    if (active)
+        _groupNodeMap[active].setGroup(active);
+
+    GroupNodeMap::Iterator nit;
+    for (nit = _groupNodeMap.begin(); nit != _groupNodeMap.end(); ++nit ) {
+        GraphNode& n = *nit;
+        n.incl = n.group()->inclusive()->subCost(_eventType);
+        n.self = n.group()->subCost(_eventType);
+    }
+}
+
 
 void GraphExporter::writeDot(QIODevice* device)
 {
@@ -712,11 +803,34 @@ void GraphExporter::writeDot(QIODevice* device)
         default:
             break;
         }
-        if (f)
+        if (f && isGroupGraph())
+            *stream << QStringLiteral("  center=G%1;\n").arg((qptrdiff)group(f), 0, 16);
+        else if (f)
             *stream << QStringLiteral("  center=F%1;\n").arg((qptrdiff)f, 0, 16);
         *stream << QStringLiteral("  overlap=false;\n  splines=true;\n");
     }
 
+    if (isGroupGraph())
+        writeGroupDot(stream);
+    else
+        writeFunctionDot(stream);
+
+    *stream << "}\n";
+
+    if (!device) {
+        if (_tmpFile) {
+            stream->flush();
+            _tmpFile->seek(0);
+        } else {
+            file->close();
+            delete file;
+        }
+    }
+    delete stream;
+}
+
+void GraphExporter::writeFunctionDot(QTextStream* stream)
+{
     // for clustering
     QMap<TraceCostItem*,QList<GraphNode*> > nLists;
 
@@ -892,19 +1006,100 @@ void GraphExporter::writeDot(QIODevice* device)
         GraphNode& n = *nit;
         n.clearEdges();
     }
+}
 
-    *stream << "}\n";
+void GraphExporter::writeGroupDot(QTextStream* stream)
+{
+    GroupCallGraph* g = _data ? _data->groupCallGraph(_groupType) : nullptr;
+    if (!g)
+        return;
 
-    if (!device) {
-        if (_tmpFile) {
-            stream->flush();
-            _tmpFile->seek(0);
-        } else {
-            file->close();
-            delete file;
+    // for clustering: group cycles
+    QMap<int,QList<GraphNode*> > nLists;
+
+    GroupNodeMap::Iterator nit;
+    for (nit = _groupNodeMap.begin(); nit != _groupNodeMap.end(); ++nit ) {
+        GraphNode& n = *nit;
+
+        if (n.incl <= _realFuncLimit)
+            continue;
+        nLists[g->cycle(n.group())].append(&n);
+    }
+
+    QMap<int,QList<GraphNode*> >::Iterator lit;
+    for (lit = nLists.begin(); lit != nLists.end(); ++lit) {
+        bool cluster = _go->clusterGroups() && (lit.key() > 0);
+
+        if (cluster)
+            *stream << QStringLiteral("subgraph \"cluster%1\" { label=\"%2\";\n")
+                       .arg(lit.key())
+                       .arg(QObject::tr("Cycle %1").arg(lit.key()));
+
+        foreach(GraphNode* np, lit.value()) {
+            TraceCostItem* i = np->group();
+
+            QString abr = GlobalConfig::shortenSymbol(i->prettyName());
+            // escape quotation marks to avoid invalid dot syntax
+            abr.replace("\"", "\\\"");
+            *stream << QStringLiteral("  G%1 [").arg((qptrdiff)i, 0, 16);
+            if (_useBox) {
+                // same space reservation as for functions
+                if ((int)abr.length() < 8) abr = abr + QString(8 - abr.length(),'_');
+
+                *stream << QStringLiteral("shape=box,label=\"** %1 **\\n**\\n%2\"];\n")
+                           .arg(abr)
+                           .arg(SubCost(np->incl).pretty());
+            } else
+                *stream << QStringLiteral("label=\"%1\\n%2\"];\n")
+                           .arg(abr)
+                           .arg(SubCost(np->incl).pretty());
         }
+
+        if (cluster)
+            *stream << QStringLiteral("}\n");
     }
-    delete stream;
+
+    GroupEdgeMap::Iterator eit;
+    for (eit = _groupEdgeMap.begin(); eit != _groupEdgeMap.end(); ++eit ) {
+        GraphEdge& e = *eit;
+        GroupCallEdge* ge = e.groupEdge();
+
+        if (e.cost < _realCallLimit)
+            continue;
+        // do not show calls inside of group cycles
+        if (!_go->expandCycles() && ge->inCycle())
+            continue;
+
+        GraphNode& from = _groupNodeMap[ge->caller()];
+        GraphNode& to = _groupNodeMap[ge->called()];
+
+        e.setCallerNode(&from);
+        e.setCalleeNode(&to);
+
+        if ((from.incl <= _realFuncLimit) ||(to.incl <= _realFuncLimit))
+            continue;
+
+        *stream << QStringLiteral("  G%1 -> G%2 [weight=%3")
+                   .arg((qptrdiff)ge->caller(), 0, 16)
+                   .arg((qptrdiff)ge->called(), 0, 16)
+                   .arg((long)log(log(e.cost)));
+
+        if (_go->detailLevel() ==1) {
+            *stream << QStringLiteral(",label=\"%1 (%2x)\"")
+                       .arg(SubCost(e.cost).pretty())
+                       .arg(SubCost(e.count).pretty());
+        }
+        else if (_go->detailLevel() ==2)
+            *stream << QStringLiteral(",label=\"%3\\n%4 x\"")
+                       .arg(SubCost(e.cost).pretty())
+                       .arg(SubCost(e.count).pretty());
+
+        *stream << QStringLiteral("];\n");
+    }
+
+    // visible edges are inserted again on parsing in CallGraphView
+    for (nit = _groupNodeMap.begin(); nit != _groupNodeMap.end(); ++nit )
+        (*nit).clearEdges();
 }
 
 void GraphExporter::sortEdges()
@@ -914,6 +1109,9 @@ void GraphExporter::sortEdges()
         GraphNode& n = *nit;
         n.sortEdges();
     }
+    GroupNodeMap::Iterator git;
+    for (git = _groupNodeMap.begin(); git != _groupNodeMap.end(); ++git )
+        (*git).sortEdges();
 }
 
 TraceFunction* GraphExporter::toFunc(QString s)
@@ -949,6 +1147,39 @@ GraphEdge* GraphExporter::edge(TraceFunction* f1, TraceFunction* f2)
     return &(*it);
 }
 
+TraceCostItem* GraphExporter::toGroup(QString s)
+{
+    if (s[0] != 'G')
+        return nullptr;
+    bool ok;
+    TraceCostItem* g = (TraceCostItem*) s.midRef(1).toULongLong(&ok, 16);
+    if (!ok)
+        return nullptr;
+
+    return g;
+}
+
+GraphNode* GraphExporter::groupNode(TraceCostItem* g)
+{
+    if (!g)
+        return nullptr;
+
+    GroupNodeMap::Iterator it = _groupNodeMap.find(g);
+    if (it == _groupNodeMap.end())
+        return nullptr;
+
+    return &(*it);
+}
+
+GraphEdge* GraphExporter::groupEdge(TraceCostItem* g1, TraceCostItem* g2)
+{
+    GroupEdgeMap::Iterator it = _groupEdgeMap.find(qMakePair(g1, g2));
+    if (it == _groupEdgeMap.end())
+        return nullptr;
+
+    return &(*it);
+}
+
 /**
  * We do a DFS and do not stop on already visited nodes/edges,
  * but add up costs. We only stop if limits/max depth is reached.
@@ -1183,11 +1414,12 @@ CanvasNode::CanvasNode(CallGraphView* v, GraphNode* n, int x, int y, int w,
     if (!_node || !_view)
         return;
 
-    if (_node->function())
-        setText(0, _node->function()->prettyName());
+    if (_node->costItem())
+        setText(0, _node->costItem()->prettyName());
 
+    // the group call graph is not restricted to the active function
     ProfileCostArray* totalCost;
-    if (GlobalConfig::showExpanded()) {
+    if (GlobalConfig::showExpanded() && !_node->group()) {
         if (_view->activeFunction()) {
             if (_view->activeFunction()->cycle())
                 totalCost = _view->activeFunction()->cycle()->inclusive();
@@ -1220,8 +1452,12 @@ void CanvasNode::updateGroup()
     if (!_view || !_node)
         return;
 
-    QColor c = GlobalGUIConfig::functionColor(_view->groupType(),
-                                              _node->function());
+    QColor c;
+    if (_node->group())
+        c = GlobalGUIConfig::groupColor(_node->group());
+    else
+        c = GlobalGUIConfig::functionColor(_view->groupType(),
+                                           _node->function());
     setBackColor(c);
     update();
 }
@@ -1278,7 +1514,7 @@ CanvasEdgeLabel::CanvasEdgeLabel(CallGraphView* v, CanvasEdge* ce, int x,
 
     setPosition(1, DrawParams::BottomCenter);
     ProfileCostArray* totalCost;
-    if (GlobalConfig::showExpanded()) {
+    if (GlobalConfig::showExpanded() && !e->groupEdge()) {
         if (_view->activeFunction()) {
             if (_view->activeFunction()->cycle())
                 totalCost = _view->activeFunction()->cycle()->inclusive();
@@ -1504,6 +1740,13 @@ void CanvasFrame::paint(QPainter* p,
 }
 
 
+// plain output of dot for a graph, shared among call graph views
+class CallGraphLayout: public ComputeResult
+{
+public:
+    QString output;
+};
+
 
 //
 // CallGraphView
@@ -1571,7 +1814,10 @@ QString CallGraphView::whatsThis() const
               "<p>If the graph is larger than the widget area, an overview "
               "panner is shown in one edge. "
               "There are similar visualization options to the "
-              "Call Treemap; the selected function is highlighted.</p>");
+              "Call Treemap; the selected function is highlighted.</p>"
+              "<p>When grouping by ELF object, source file or class, "
+              "the option 'Calls between Groups' shows the calls "
+              "aggregated between these groups instead.</p>");
 }
 
 void CallGraphView::updateSizes(QSize s)
@@ -1731,7 +1977,7 @@ void CallGraphView::keyPressEvent(QKeyEvent* e)
 
     if ((e->key() == Qt::Key_Return) ||(e->key() == Qt::Key_Space)) {
         if (_selectedNode)
-            activated(_selectedNode->function());
+            activated(_selectedNode->costItem());
         else if (_selectedEdge && _selectedEdge->call())
             activated(_selectedEdge->call());
         return;
@@ -1864,6 +2110,10 @@ void CallGraphView::doUpdate(int changeType, bool)
             n = _exporter.node((TraceFunction*)_selectedItem);
             if (n == _selectedNode)
                 return;
+        } else if (_selectedItem->type() == _groupType) {
+            n = _exporter.groupNode((TraceCostItem*)_selectedItem);
+            if (n == _selectedNode)
+                return;
         } else if (_selectedItem->type() == ProfileContext::Call) {
             TraceCall* c = (TraceCall*)_selectedItem;
             e = _exporter.edge(c->caller(false), c->called(false));
@@ -1914,7 +2164,7 @@ void CallGraphView::doUpdate(int changeType, bool)
         if (!_scene)
             return;
 
-        if (_clusterGroups) {
+        if (_clusterGroups || _groupGraph) {
             refresh();
             return;
         }
@@ -2051,6 +2301,29 @@ void CallGraphView::refresh()
     _selectedNode = nullptr;
     _selectedEdge = nullptr;
 
+    // another view may have layouted the same graph already
+    QString options = QStringLiteral("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                      .arg(layoutString(_layout))
+                      .arg(_funcLimit).arg(_callLimit)
+                      .arg(_maxCallerDepth).arg(_maxCalleeDepth)
+                      .arg(_showSkipped).arg(_expandCycles)
+                      .arg(_clusterGroups).arg(_detailLevel);
+    options += QStringLiteral(" %1 ").arg(_groupGraph);
+    options += ProfileContext::typeName(_groupType);
+    ComputeCache* cache = _data->computeCache();
+    _layoutKey = cache->key(ComputeCache::CallGraphLayout, _activeItem,
+                            _eventType, nullptr, options);
+    CallGraphLayout* layout = (CallGraphLayout*) cache->result(_layoutKey);
+    if (layout) {
+        // node names in the layout are derived from function pointers
+        _exporter.reset(_data, _activeItem, _eventType, _groupType);
+        _exporter.createGraph();
+        _unparsedOutput = layout->output;
+        layout->deref();
+        showLayout();
+        return;
+    }
+
     /*
      * Call 'dot' asynchronously in the background with the aim to
      * - have responsive GUI while layout task runs (potentially long!)
@@ -2147,9 +2420,23 @@ void CallGraphView::dotExited()
     }
 
     _unparsedOutput.append(QString::fromLocal8Bit(_renderProcess->readAllStandardOutput()));
+    bool ok = (_renderProcess->exitStatus() == QProcess::NormalExit) &&
+              (_renderProcess->exitCode() == 0);
     _renderProcess->deleteLater();
     _renderProcess = nullptr;
 
+    if (ok && _data) {
+        CallGraphLayout* layout = new CallGraphLayout;
+        layout->output = _unparsedOutput;
+        _data->computeCache()->insert(_layoutKey, layout);
+        layout->deref();
+    }
+
+    showLayout();
+}
+
+void CallGraphView::showLayout()
+{
     QString line, cmd;
     CanvasNode *rItem;
     QGraphicsEllipseItem* eItem;
@@ -2270,7 +2557,11 @@ void CallGraphView::dotExited()
             width = nodeWidth.toDouble();
             height = nodeHeight.toDouble();
 
-            GraphNode* n = _exporter.node(_exporter.toFunc(nodeName));
+            GraphNode* n;
+            if (nodeName[0] == 'G')
+                n = _exporter.groupNode(_exporter.toGroup(nodeName));
+            else
+                n = _exporter.node(_exporter.toFunc(nodeName));
 
             int xx = (int)(scaleX * x + _xMargin);
             int yy = (int)(scaleY * (dotHeight - y)+ _yMargin);
@@ -2311,9 +2602,14 @@ void CallGraphView::dotExited()
             n->setCanvasNode(rItem);
 
             if (n) {
-                if (n->function() == activeItem())
+                if (n->group()) {
+                    // group of active function is the active node
+                    if (n->group() == _exporter.group(activeFunction()))
+                        activeNode = n;
+                }
+                else if (n->function() == activeItem())
                     activeNode = n;
-                if (n->function() == selectedItem())
+                if (n->costItem() == selectedItem())
                     _selectedNode = n;
                 rItem->setSelected(n == _selectedNode);
             }
@@ -2332,8 +2628,13 @@ void CallGraphView::dotExited()
         int points, i;
         lineStream >> node1Name >> node2Name >> points;
 
-        GraphEdge* e = _exporter.edge(_exporter.toFunc(node1Name),
-                                      _exporter.toFunc(node2Name));
+        GraphEdge* e;
+        if (node1Name[0] == 'G')
+            e = _exporter.groupEdge(_exporter.toGroup(node1Name),
+                                    _exporter.toGroup(node2Name));
+        else
+            e = _exporter.edge(_exporter.toFunc(node1Name),
+                               _exporter.toFunc(node2Name));
         if (!e) {
             qDebug() << "Unknown edge '"<< node1Name << "'-'"<< node2Name
                      << "' from dot ("<< _exporter.filename() << ":"<< lineno
@@ -2387,9 +2688,9 @@ void CallGraphView::dotExited()
         sItem->setZValue(0.5);
         sItem->show();
 
-        if (e->call() == selectedItem())
+        if (e->call() && (e->call() == selectedItem()))
             _selectedEdge = e;
-        if (e->call() == activeItem())
+        if (e->call() && (e->call() == activeItem()))
             activeEdge = e;
         sItem->setSelected(e == _selectedEdge);
 
@@ -2623,9 +2924,9 @@ void CallGraphView::mousePressEvent(QMouseEvent* e)
             GraphNode* n = ((CanvasNode*)i)->node();
             if (0)
                 qDebug("CallGraphView: Got Node '%s'",
-                       qPrintable(n->function()->prettyName()));
+                       qPrintable(n->costItem()->prettyName()));
 
-            selected(n->function());
+            selected(n->costItem());
         }
 
         // redirect from label / arrow to edge
@@ -2678,9 +2979,9 @@ void CallGraphView::mouseDoubleClickEvent(QMouseEvent* e)
         GraphNode* n = ((CanvasNode*)i)->node();
         if (0)
             qDebug("CallGraphView: Double Clicked on Node '%s'",
-                   qPrintable(n->function()->prettyName()));
+                   qPrintable(n->costItem()->prettyName()));
 
-        activated(n->function());
+        activated(n->costItem());
     }
 
     // redirect from label / arrow to edge
@@ -2943,8 +3244,10 @@ void CallGraphView::contextMenuEvent(QContextMenuEvent* e)
     QMenu popup;
     TraceFunction *f = nullptr, *cycle = nullptr;
     TraceCall* c = nullptr;
+    TraceCostItem* group = nullptr;
 
     QAction* activateFunction = nullptr;
+    QAction* activateGroup = nullptr;
     QAction* activateCycle = nullptr;
     QAction* activateCall = nullptr;
     if (i) {
@@ -2952,18 +3255,25 @@ void CallGraphView::contextMenuEvent(QContextMenuEvent* e)
             GraphNode* n = ((CanvasNode*)i)->node();
             if (0)
                 qDebug("CallGraphView: Menu on Node '%s'",
-                       qPrintable(n->function()->prettyName()));
+                       qPrintable(n->costItem()->prettyName()));
 
             f = n->function();
-            cycle = f->cycle();
-
-            QString name = f->prettyName();
-            QString menuStr = tr("Go to '%1'")
-                              .arg(GlobalConfig::shortenSymbol(name));
-            activateFunction = popup.addAction(menuStr);
-            if (cycle && (cycle != f)) {
-                name = GlobalConfig::shortenSymbol(cycle->prettyName());
-                activateCycle = popup.addAction(tr("Go to '%1'").arg(name));
+            group = n->group();
+            if (f) {
+                cycle = f->cycle();
+
+                QString name = f->prettyName();
+                QString menuStr = tr("Go to '%1'")
+                                  .arg(GlobalConfig::shortenSymbol(name));
+                activateFunction = popup.addAction(menuStr);
+                if (cycle && (cycle != f)) {
+                    name = GlobalConfig::shortenSymbol(cycle->prettyName());
+                    activateCycle = popup.addAction(tr("Go to '%1'").arg(name));
+                }
+            }
+            else if (group) {
+                QString name = GlobalConfig::shortenSymbol(group->prettyName());
+                activateGroup = popup.addAction(tr("Go to '%1'").arg(name));
             }
             popup.addSeparator();
         }
@@ -3028,6 +3338,15 @@ void CallGraphView::contextMenuEvent(QContextMenuEvent* e)
     toggleCluster->setCheckable(true);
     toggleCluster->setChecked(_clusterGroups);
 
+    QAction* toggleGroupGraph;
+    toggleGroupGraph = gpopup->addAction(tr("Calls between Groups"));
+    toggleGroupGraph->setCheckable(true);
+    toggleGroupGraph->setChecked(_groupGraph);
+    // only for grouping by ELF object, source file or class
+    toggleGroupGraph->setEnabled((groupType() == ProfileContext::Object) ||
+                                 (groupType() == ProfileContext::File) ||
+                                 (groupType() == ProfileContext::Class));
+
     QMenu* vpopup = popup.addMenu(tr("Visualization"));
     QAction* layoutCompact = vpopup->addAction(tr("Compact"));
     layoutCompact->setCheckable(true);
@@ -3050,6 +3369,8 @@ void CallGraphView::contextMenuEvent(QContextMenuEvent* e)
         activated(cycle);
     else if (a == activateCall)
         activated(c);
+    else if (a == activateGroup)
+        activated(group);
 
     else if (a == stopLayout)
         stopRendering();
@@ -3101,6 +3422,10 @@ void CallGraphView::contextMenuEvent(QContextMenuEvent* e)
         _clusterGroups = !_clusterGroups;
         refresh();
     }
+    else if (a == toggleGroupGraph) {
+        _groupGraph = !_groupGraph;
+        refresh();
+    }
 
     else if (a == layoutCompact) {
         _detailLevel = 0;
@@ -3164,6 +3489,7 @@ void CallGraphView::restoreOptions(const QString& prefix, const QString& postfix
     _showSkipped = g->value(QStringLiteral("ShowSkipped"), DEFAULT_SHOWSKIPPED).toBool();
     _expandCycles = g->value(QStringLiteral("ExpandCycles"), DEFAULT_EXPANDCYCLES).toBool();
     _clusterGroups = g->value(QStringLiteral("ClusterGroups"), DEFAULT_CLUSTERGROUPS).toBool();
+    _groupGraph = g->value(QStringLiteral("GroupGraph"), DEFAULT_GROUPGRAPH).toBool();
     _detailLevel = g->value(QStringLiteral("DetailLevel"), DEFAULT_DETAILLEVEL).toInt();
     _layout = GraphOptions::layout(g->value(QStringLiteral("Layout"),
                                             layoutString(DEFAULT_LAYOUT)).toString());
@@ -3184,6 +3510,7 @@ void CallGraphView::saveOptions(const QString& prefix, const QString& postfix)
     g->setValue(QStringLiteral("ShowSkipped"), _showSkipped, DEFAULT_SHOWSKIPPED);
     g->setValue(QStringLiteral("ExpandCycles"), _expandCycles, DEFAULT_EXPANDCYCLES);
     g->setValue(QStringLiteral("ClusterGroups"), _clusterGroups, DEFAULT_CLUSTERGROUPS);
+    g->setValue(QStringLiteral("GroupGraph"), _groupGraph, DEFAULT_GROUPGRAPH);
     g->setValue(QStringLiteral("DetailLevel"), _detailLevel, DEFAULT_DETAILLEVEL);
     g->setValue(QStringLiteral("Layout"), layoutString(_layout), layoutString(DEFAULT_LAYOUT));
     g->setValue(QStringLiteral("ZoomPosition"), zoomPosString(_zoomPosition),
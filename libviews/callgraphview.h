@@ -44,15 +44,18 @@
 #include "treemap.h" // for DrawParams
 #include "tracedata.h"
 #include "traceitemview.h"
+#include "computecache.h"
 
 class QProcess;
 class QTemporaryFile;
 class QIODevice;
+class QTextStream;
 
 class CanvasNode;
 class CanvasEdge;
 class GraphEdge;
 class CallGraphView;
+class GroupCallEdge;
 
 
 // temporary parts of call graph to be shown
@@ -71,6 +74,23 @@ public:
         _f = f;
     }
 
+    // for the group call graph: node is an ELF object, file or class
+    TraceCostItem* group() const
+    {
+        return _group;
+    }
+
+    void setGroup(TraceCostItem* g)
+    {
+        _group = g;
+    }
+
+    // function, or group in the group call graph
+    CostItem* costItem() const
+    {
+        return _f ? (CostItem*) _f : (CostItem*) _group;
+    }
+
     CanvasNode* canvasNode() const
     {
         return _cn;
@@ -119,6 +139,7 @@ public:
 
 private:
     TraceFunction* _f;
+    TraceCostItem* _group;
     CanvasNode* _cn;
     bool _visible;
 
@@ -155,6 +176,17 @@ public:
         _c = c;
     }
 
+    // for the group call graph: calls between two groups
+    GroupCallEdge* groupEdge() const
+    {
+        return _groupEdge;
+    }
+
+    void setGroupEdge(GroupCallEdge* e)
+    {
+        _groupEdge = e;
+    }
+
     bool isVisible() const
     {
         return _visible;
@@ -220,6 +252,7 @@ private:
     // we have a _c *and* _from/_to because for collapsed edges,
     // only _to or _from will be unequal nullptr
     TraceCall* _c;
+    GroupCallEdge* _groupEdge;
     TraceFunction * _from, * _to;
     GraphNode *_fromNode, *_toNode;
     CanvasEdge* _ce;
@@ -231,6 +264,8 @@ private:
 
 typedef QMap<TraceFunction*, GraphNode> GraphNodeMap;
 typedef QMap<QPair<TraceFunction*, TraceFunction*>, GraphEdge> GraphEdgeMap;
+typedef QMap<TraceCostItem*, GraphNode> GroupNodeMap;
+typedef QMap<QPair<TraceCostItem*, TraceCostItem*>, GraphEdge> GroupEdgeMap;
 
 
 /* Abstract Interface for graph options */
@@ -246,6 +281,7 @@ public:
     virtual bool showSkipped() = 0;
     virtual bool expandCycles() = 0;
     virtual bool clusterGroups() = 0;
+    virtual bool groupGraph() = 0;
     virtual int detailLevel() = 0;
     virtual Layout layout() = 0;
 
@@ -267,6 +303,7 @@ public:
     bool showSkipped() override { return _showSkipped; }
     bool expandCycles() override { return _expandCycles; }
     bool clusterGroups() override { return _clusterGroups; }
+    bool groupGraph() override { return _groupGraph; }
     int detailLevel() override { return _detailLevel; }
     Layout layout() override { return _layout; }
 
@@ -278,13 +315,14 @@ public:
     void setShowSkipped(bool b) { _showSkipped = b; }
     void setExpandCycles(bool b) { _expandCycles = b; }
     void setClusterGroups(bool b) { _clusterGroups = b; }
+    void setGroupGraph(bool b) { _groupGraph = b; }
     void setDetailLevel(int l) { _detailLevel = l; }
     void setLayout(Layout l) { _layout = l; }
 
 protected:
     double _funcLimit, _callLimit;
     int _maxCallerDepth, _maxCalleeDepth;
-    bool _showSkipped, _expandCycles, _clusterGroups;
+    bool _showSkipped, _expandCycles, _clusterGroups, _groupGraph;
     int _detailLevel;
     Layout _layout;
 };
@@ -315,14 +353,22 @@ public:
 
     int edgeCount()
     {
-        return _edgeMap.count();
+        return _edgeMap.count() + _groupEdgeMap.count();
     }
 
     int nodeCount()
     {
-        return _nodeMap.count();
+        return _nodeMap.count() + _groupNodeMap.count();
     }
 
+    /* With option groupGraph() and group type Object, File or Class,
+     * the graph has groups as nodes and calls between groups as edges
+     * (see GroupCallGraph), instead of the functions around the active one
+     */
+    bool isGroupGraph();
+    // group of function according to group type
+    TraceCostItem* group(TraceFunction*);
+
     // Set the object from which to get graph options for creation.
     // Default is this object itself (supply 0 for default)
     void setGraphOptions(GraphOptions* go = nullptr);
@@ -342,6 +388,10 @@ public:
     TraceFunction* toFunc(QString);
     GraphNode* node(TraceFunction*);
     GraphEdge* edge(TraceFunction*, TraceFunction*);
+    // same for nodes/edges of the group call graph
+    TraceCostItem* toGroup(QString);
+    GraphNode* groupNode(TraceCostItem*);
+    GraphEdge* groupEdge(TraceCostItem*, TraceCostItem*);
 
     /* After CanvasEdges are attached to GraphEdges, we can
      * sort the incoming and outgoing edges of all nodes
@@ -351,7 +401,11 @@ public:
 
 private:
     void buildGraph(TraceFunction*, int, bool, double);
+    void createGroupGraph();
+    void writeFunctionDot(QTextStream*);
+    void writeGroupDot(QTextStream*);
 
+    TraceData* _data;
     QString _dotName;
     CostItem* _item;
     EventType* _eventType;
@@ -368,6 +422,8 @@ private:
     // graph parts written to file
     GraphNodeMap _nodeMap;
     GraphEdgeMap _edgeMap;
+    GroupNodeMap _groupNodeMap;
+    GroupEdgeMap _groupEdgeMap;
 };
 
 
@@ -636,6 +692,7 @@ private:
     CostItem* canShow(CostItem*) override;
     void doUpdate(int, bool) override;
     void refresh();
+    void showLayout();
     void makeFrame(CanvasNode*, bool active);
     void clear();
     void showText(QString);
@@ -679,6 +736,8 @@ private:
     GraphNode* _prevSelectedNode;
     QPoint _prevSelectedPos;
     QString _unparsedOutput;
+    // key of the layout currently calculated by dot
+    ComputeKey _layoutKey;
 };
 
 
@@ -23,6 +23,7 @@
 #include "callitem.h"
 
 #include <QFontMetrics>
+#include <QHeaderView>
 
 #include "globalguiconfig.h"
 #include "listutils.h"
@@ -39,6 +40,7 @@ CallItem::CallItem(CallView* view, QTreeWidget* parent, TraceCall* c)
         setTextAlignment(i, Qt::AlignRight);
 
     _call = c;
+    _more = 0;
     _view = view;
 
     _active = _view->activeFunction();
@@ -61,14 +63,39 @@ CallItem::CallItem(CallView* view, QTreeWidget* parent, TraceCall* c)
     updateCost();
 }
 
+CallItem::CallItem(CallView* view, QTreeWidget* parent, int more)
+    : QTreeWidgetItem(parent)
+{
+    _call = nullptr;
+    _more = more;
+    _view = view;
+    _active = nullptr;
+    _shown = nullptr;
+
+    setToolTip(5, QObject::tr("Activate to show more calls"));
+    setMore(more);
+}
+
+void CallItem::setMore(int more)
+{
+    _more = more;
+    //~ singular (%n more call...)
+    //~ plural (%n more calls...)
+    setText(5, QObject::tr("(%n more call(s)...)", "", _more));
+}
+
 void  CallItem::updateGroup()
 {
+    if (!_call) return;
+
     QColor c = GlobalGUIConfig::functionColor(_view->groupType(), _shown);
     setIcon(5, colorPixmap(10, 10, c));
 }
 
 void CallItem::updateCost()
 {
+    if (!_call) return;
+
     bool sameCycle = _shown->cycle() && (_active->cycle() == _shown->cycle());
     bool shownIsCycle = (_shown == _shown->cycle());
     bool selectedIsCycle = (_active == _active->cycle());
@@ -160,6 +187,13 @@ bool CallItem::operator<(const QTreeWidgetItem& other) const
     const CallItem* ci1 = this;
     const CallItem* ci2 = (CallItem*) &other;
 
+    // placeholder always at end, in both sort orders
+    if (ci1->_more || ci2->_more) {
+        bool ascending = (treeWidget()->header()->sortIndicatorOrder() ==
+                          Qt::AscendingOrder);
+        return ci1->_more ? !ascending : ascending;
+    }
+
     if (col==0)
         return ci1->_sum < ci2->_sum;
 
@@ -32,9 +32,14 @@ class CallItem: public QTreeWidgetItem
 {
 public:
     CallItem(CallView*, QTreeWidget*, TraceCall* c);
+    // placeholder for <more> calls not shown yet
+    CallItem(CallView*, QTreeWidget*, int more);
 
     bool operator<(const QTreeWidgetItem& other) const override;
+    // nullptr for placeholder
     TraceCall* call() { return _call; }
+    int more() const { return _more; }
+    void setMore(int more);
     CallView* view() { return _view; }
     void updateCost();
     void updateGroup();
@@ -43,6 +48,7 @@ private:
     SubCost _sum, _sum2;
     SubCost _cc;
     TraceCall* _call;
+    int _more;
     CallView* _view;
     TraceFunction *_active, *_shown;
 };
@@ -28,9 +28,163 @@
 #include <QTreeWidget>
 #include <QHeaderView>
 #include <QKeyEvent>
+#include <QMutex>
+#include <QThreadPool>
 
 #include "globalconfig.h"
 #include "callitem.h"
+#include "computecache.h"
+
+
+/* A call with the value of the sort column, read on the GUI thread:
+ * cost accessors do lazy updates and are not safe on worker threads.
+ */
+struct CallListEntry
+{
+    TraceCall* call;
+    int index;
+    uint64 value;
+    QString name;
+};
+
+// order of entries as shown with given sort column and order
+class CallListLess
+{
+public:
+    CallListLess(bool byName, bool ascending)
+    { _byName = byName; _ascending = ascending; }
+
+    bool operator()(const CallListEntry& e1, const CallListEntry& e2) const
+    {
+        if (_byName) {
+            if (e1.name != e2.name)
+                return _ascending ? (e1.name < e2.name) : (e2.name < e1.name);
+        }
+        else if (e1.value != e2.value)
+            return _ascending ? (e1.value < e2.value) : (e1.value > e2.value);
+
+        // keep list order among equal values
+        return e1.index < e2.index;
+    }
+
+private:
+    bool _byName, _ascending;
+};
+
+/*
+ * Calls with cost of an event type. Only a prefix of the list is
+ * sorted by the sort column of the view: for functions with lots of
+ * callers or callees, we never need to sort more than the calls shown.
+ *
+ * Sorting runs on a worker thread. Views waiting for the result get
+ * their selectionFinished() slot called (queued) afterwards.
+ * The worker only moves entries behind sorted(), so the GUI thread
+ * can read the sorted prefix at any time.
+ */
+class CallListResult: public ComputeResult
+{
+public:
+    CallListResult(const QVector<CallListEntry>& entries,
+                   bool byName, bool ascending);
+
+    int count() const { return _count; }
+    TraceCall* call(int i) const { return _data[i].call; }
+    // number of entries at start of list in final order
+    int sorted();
+
+    /* Make sure the first <n> entries get sorted. Returns true if
+     * this already is the case, otherwise sorting is started on a
+     * worker thread and <receiver> is notified when done.
+     */
+    bool request(int n, QObject* receiver);
+    // do not notify <receiver> any longer
+    void cancel(QObject* receiver);
+
+    // runs on worker thread
+    void select();
+
+private:
+    QVector<CallListEntry> _entries;
+    CallListEntry* _data;
+    int _count;
+    CallListLess _less;
+
+    QMutex _mutex;
+    int _sorted, _requested;
+    bool _running;
+    QList<QObject*> _waiting;
+};
+
+// worker thread task for CallListResult::select()
+class CallListTask: public QRunnable
+{
+public:
+    explicit CallListTask(CallListResult* r) { _result = r; r->ref(); }
+    ~CallListTask() override { _result->deref(); }
+
+    void run() override { _result->select(); }
+
+private:
+    CallListResult* _result;
+};
+
+CallListResult::CallListResult(const QVector<CallListEntry>& entries,
+                               bool byName, bool ascending)
+    : _entries(entries), _less(byName, ascending)
+{
+    // detach now: no implicit sharing checks on the worker thread
+    _data = _entries.data();
+    _count = _entries.count();
+    _sorted = 0;
+    _requested = 0;
+    _running = false;
+}
+
+int CallListResult::sorted()
+{
+    QMutexLocker locker(&_mutex);
+    return _sorted;
+}
+
+bool CallListResult::request(int n, QObject* receiver)
+{
+    QMutexLocker locker(&_mutex);
+    if (n > _count) n = _count;
+    if (n <= _sorted) return true;
+
+    if (n > _requested) _requested = n;
+    if (!_waiting.contains(receiver))
+        _waiting.append(receiver);
+    if (!_running) {
+        _running = true;
+        QThreadPool::globalInstance()->start(new CallListTask(this));
+    }
+    return false;
+}
+
+void CallListResult::cancel(QObject* receiver)
+{
+    QMutexLocker locker(&_mutex);
+    _waiting.removeAll(receiver);
+}
+
+void CallListResult::select()
+{
+    QMutexLocker locker(&_mutex);
+    while (_sorted < _requested) {
+        int from = _sorted, to = _requested;
+        locker.unlock();
+        std::partial_sort(_data + from, _data + to, _data + _count, _less);
+        locker.relock();
+        _sorted = to;
+    }
+    _running = false;
+
+    // notify while holding the lock: receivers cancel before deletion
+    foreach(QObject* o, _waiting)
+        QMetaObject::invokeMethod(o, "selectionFinished", Qt::QueuedConnection);
+    _waiting.clear();
+}
 
 
 //
@@ -42,6 +196,10 @@ CallView::CallView(bool showCallers, TraceItemView* parentView, QWidget* parent)
     : QTreeWidget(parent), TraceItemView(parentView)
 {
     _showCallers = showCallers;
+    _calls = nullptr;
+    _shownCount = 0;
+    _wantedCount = 0;
+    _moreItem = nullptr;
 
     QStringList headerLabels;
     headerLabels << tr( "Cost" )
@@ -78,6 +236,17 @@ CallView::CallView(bool showCallers, TraceItemView* parentView, QWidget* parent)
 
     connect(header(), &QHeaderView::sectionClicked,
             this, &CallView::headerClicked);
+
+    connect(header(), &QHeaderView::sortIndicatorChanged,
+            this, &CallView::sortChanged);
+}
+
+CallView::~CallView()
+{
+    if (_calls) {
+        ((CallListResult*)_calls)->cancel(this);
+        _calls->deref();
+    }
 }
 
 QString CallView::whatsThis() const
@@ -155,6 +324,7 @@ void CallView::selectedSlot(QTreeWidgetItem * i, QTreeWidgetItem *)
 {
     if (!i) return;
     TraceCall* c = ((CallItem*) i)->call();
+    if (!c) return;
     // Should we skip cycles here?
     CostItem* f = _showCallers ? c->caller(false) : c->called(false);
 
@@ -167,6 +337,10 @@ void CallView::activatedSlot(QTreeWidgetItem* i,int)
     if (!i) return;
 
     TraceCall* c = ((CallItem*) i)->call();
+    if (!c) {
+        showMore();
+        return;
+    }
     // skip cycles: use the context menu to get to the cycle...
     CostItem* f = _showCallers ? c->caller(true) : c->called(true);
 
@@ -182,6 +356,15 @@ void CallView::headerClicked(int col)
     sortByColumn(col, Qt::DescendingOrder);
 }
 
+void CallView::sortChanged(int, Qt::SortOrder)
+{
+    CallListResult* r = (CallListResult*) _calls;
+    if (!r) return;
+
+    // if not all calls are shown, the shown ones depend on sort order
+    if (_shownCount < r->count()) refresh();
+}
+
 void CallView::keyPressEvent(QKeyEvent* event)
 {
     QTreeWidgetItem *item = currentItem();
@@ -189,6 +372,10 @@ void CallView::keyPressEvent(QKeyEvent* event)
                  (event->key() == Qt::Key_Space)))
     {
         TraceCall* c = ((CallItem*) item)->call();
+        if (!c) {
+            showMore();
+            return;
+        }
         CostItem* f = _showCallers ? c->caller(false) : c->called(false);
 
         TraceItemView::activated(f);
@@ -223,7 +410,7 @@ void CallView::doUpdate(int changeType, bool)
         CallItem* ci = (CallItem*) currentItem();
         TraceCall* c;
         CostItem* ti;
-        if (ci) {
+        if (ci && ci->call()) {
             c = ci->call();
             ti = _showCallers ? c->caller() : c->called();
             if (ti == _selectedItem) return;
@@ -233,6 +420,7 @@ void CallView::doUpdate(int changeType, bool)
         for (int i=0; i<topLevelItemCount();i++) {
             item = topLevelItem(i);
             c = ((CallItem*) item)->call();
+            if (!c) continue;
             ti = _showCallers ? c->caller() : c->called();
             if (ti == _selectedItem) {
                 scrollToItem(item);
@@ -259,6 +447,15 @@ void CallView::doUpdate(int changeType, bool)
 void CallView::refresh()
 {
     clear();
+    _moreItem = nullptr;
+    _shownCount = 0;
+    _wantedCount = 0;
+    if (_calls) {
+        ((CallListResult*)_calls)->cancel(this);
+        _calls->deref();
+        _calls = nullptr;
+    }
+
     setColumnHidden(2, (_eventType2 == nullptr));
     setColumnHidden(3, (_eventType2 == nullptr));
 
@@ -276,13 +473,103 @@ void CallView::refresh()
     TraceFunction* f = activeFunction();
     if (!f) return;
 
-    // In the call lists, we skip cycles to show the real call relations
-    TraceCallList l = _showCallers ? f->callers(true) : f->callings(true);
+    // calls shown are the first ones in current sort order
+    int col = header()->sortIndicatorSection();
+    Qt::SortOrder order = header()->sortIndicatorOrder();
+
+    // other views may have the same call list already
+    ComputeCache* cache = _data->computeCache();
+    ComputeKey key = cache->key(_showCallers ? ComputeCache::CallerList :
+                                               ComputeCache::CalleeList,
+                                f, _eventType, _eventType2,
+                                QStringLiteral("%1 %2").arg(col).arg(order));
+    CallListResult* r = (CallListResult*) cache->result(key);
+    if (!r) {
+        bool baseIsCycle = (f == f->cycle());
+        QVector<CallListEntry> entries;
+
+        // In the call lists, we skip cycles to show the real call relations
+        TraceCallList l = _showCallers ? f->callers(true) : f->callings(true);
+        foreach(TraceCall* call, l) {
+            if (call->subCost(_eventType) == 0) continue;
+
+            CallListEntry e;
+            e.call = call;
+            e.index = entries.count();
+            e.value = 0;
+
+            uint64 cc = call->callCount().v;
+            if (cc == 0) cc = 1;
+            switch(col) {
+            case 0: e.value = call->subCost(_eventType).v; break;
+            case 1: e.value = call->subCost(_eventType).v / cc; break;
+            case 2:
+                if (_eventType2) e.value = call->subCost(_eventType2).v;
+                break;
+            case 3:
+                if (_eventType2) e.value = call->subCost(_eventType2).v / cc;
+                break;
+            case 4: e.value = call->callCount().v; break;
+            default:
+                // same text as shown by CallItem
+                if (_showCallers) {
+                    e.name = call->callerName(!baseIsCycle);
+                    call->caller(true)->addPrettyLocation(e.name);
+                }
+                else {
+                    e.name = call->calledName(!baseIsCycle);
+                    call->called(true)->addPrettyLocation(e.name);
+                }
+                break;
+            }
+            entries.append(e);
+        }
+        r = new CallListResult(entries, (col == 5),
+                               (order == Qt::AscendingOrder));
+        cache->insert(key, r);
+    }
+    _calls = r;
+
+    showMore();
+}
+
+/* Add the next maxListCount() calls in sort order as items.
+ * For hub functions with many thousands of callers/callees, creating
+ * items for all calls would block the GUI. Items are added as soon as
+ * the worker thread has sorted enough calls.
+ */
+void CallView::showMore()
+{
+    CallListResult* r = (CallListResult*) _calls;
+    if (!r) return;
+
+    _wantedCount = _shownCount + GlobalConfig::maxListCount();
+    if (r->request(_wantedCount, this))
+        selectionFinished();
+}
+
+void CallView::selectionFinished()
+{
+    CallListResult* r = (CallListResult*) _calls;
+    if (!r) return;
+
+    int count = qMin(_wantedCount, r->sorted());
+    if (count <= _shownCount) return;
 
     QList<QTreeWidgetItem*> items;
-    foreach(TraceCall* call, l)
-        if (call->subCost(_eventType)>0)
-            items.append(new CallItem(this, nullptr, call));
+    for (int i = _shownCount; i < count; i++)
+        items.append(new CallItem(this, nullptr, r->call(i)));
+    _shownCount = count;
+
+    int more = r->count() - _shownCount;
+    if (_moreItem) {
+        ((CallItem*)_moreItem)->setMore(more);
+        _moreItem->setHidden(more == 0);
+    }
+    else if (more > 0) {
+        _moreItem = new CallItem(this, nullptr, more);
+        items.append(_moreItem);
+    }
 
     // when inserting, switch off sorting for performance reason
     setSortingEnabled(false);
@@ -27,6 +27,8 @@
 #include "tracedata.h"
 #include "traceitemview.h"
 
+class ComputeResult;
+
 class CallView: public QTreeWidget, public TraceItemView
 {
     Q_OBJECT
@@ -34,6 +36,7 @@ class CallView: public QTreeWidget, public TraceItemView
 public:
     CallView(bool showCallers, TraceItemView* parentView,
              QWidget* parent=nullptr);
+    ~CallView() override;
 
     QWidget* widget() override { return this; }
     QString whatsThis() const override;
@@ -44,6 +47,11 @@ protected Q_SLOTS:
     void selectedSlot(QTreeWidgetItem*, QTreeWidgetItem*);
     void activatedSlot(QTreeWidgetItem*, int);
     void headerClicked(int);
+    void sortChanged(int, Qt::SortOrder);
+
+private Q_SLOTS:
+    // sorting of calls on worker thread done
+    void selectionFinished();
 
 protected:
     void keyPressEvent(QKeyEvent* event) override;
@@ -52,9 +60,14 @@ private:
     CostItem* canShow(CostItem*) override;
     void doUpdate(int, bool) override;
     void refresh();
+    void showMore();
     void setCostColumnWidths();
 
     bool _showCallers;
+    // calls of active function in sort order, shown up to _shownCount
+    ComputeResult* _calls;
+    int _shownCount, _wantedCount;
+    QTreeWidgetItem* _moreItem;
 };
 
 #endif
@@ -31,7 +31,7 @@
 // CallerCoverageItem
 
 
-CallerCoverageItem::CallerCoverageItem(QTreeWidget* parent, Coverage* c,
+CallerCoverageItem::CallerCoverageItem(QTreeWidget* parent, CoverageValues* c,
                                        TraceFunction* base,
                                        EventType* ct,
                                        ProfileContext::Type gt)
@@ -51,7 +51,7 @@ CallerCoverageItem::CallerCoverageItem(QTreeWidget* parent, Coverage* c,
     setGroupType(gt);
 }
 
-CallerCoverageItem::CallerCoverageItem(QTreeWidget* parent, int skipped, Coverage* c,
+CallerCoverageItem::CallerCoverageItem(QTreeWidget* parent, int skipped, CoverageValues* c,
                                        TraceFunction* base,
                                        EventType* ct,
                                        ProfileContext::Type gt)
@@ -166,7 +166,7 @@ bool CallerCoverageItem::operator<( const QTreeWidgetItem & other ) const
 
 // CalleeCoverageItem
 
-CalleeCoverageItem::CalleeCoverageItem(QTreeWidget* parent, Coverage* c,
+CalleeCoverageItem::CalleeCoverageItem(QTreeWidget* parent, CoverageValues* c,
                                        TraceFunction* base,
                                        EventType* ct,
                                        ProfileContext::Type gt)
@@ -190,7 +190,7 @@ CalleeCoverageItem::CalleeCoverageItem(QTreeWidget* parent, Coverage* c,
     setGroupType(gt);
 }
 
-CalleeCoverageItem::CalleeCoverageItem(QTreeWidget* parent, int skipped, Coverage* c,
+CalleeCoverageItem::CalleeCoverageItem(QTreeWidget* parent, int skipped, CoverageValues* c,
                                        TraceFunction* base,
                                        EventType* ct,
                                        ProfileContext::Type gt)
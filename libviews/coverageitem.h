@@ -26,20 +26,21 @@
 #include <QTreeWidget>
 #include "tracedata.h"
 
-class Coverage;
+class CoverageValues;
 
 class CallerCoverageItem: public QTreeWidgetItem
 {
 public:
-    CallerCoverageItem(QTreeWidget* parent, Coverage* c,
+    CallerCoverageItem(QTreeWidget* parent, CoverageValues* c,
                        TraceFunction* base,
                        EventType* ct, ProfileContext::Type gt);
-    CallerCoverageItem(QTreeWidget* parent, int skipped, Coverage* c,
+    CallerCoverageItem(QTreeWidget* parent, int skipped, CoverageValues* c,
                        TraceFunction* base,
                        EventType* ct, ProfileContext::Type gt);
 
     bool operator< ( const QTreeWidgetItem & other ) const override;
     TraceFunction* function() { return (_skipped) ? nullptr : _function; }
+    int skipped() const { return _skipped; }
     void setCostType(EventType* ct);
     void setGroupType(ProfileContext::Type);
     void update();
@@ -52,22 +53,23 @@ private:
     SubCost _cc;
     int _distance, _skipped;
     TraceFunction *_function, *_base;
-    Coverage* _coverage;
+    CoverageValues* _coverage;
 };
 
 
 class CalleeCoverageItem: public QTreeWidgetItem
 {
 public:
-    CalleeCoverageItem(QTreeWidget* parent, Coverage* c,
+    CalleeCoverageItem(QTreeWidget* parent, CoverageValues* c,
                        TraceFunction* base,
                        EventType* ct, ProfileContext::Type gt);
-    CalleeCoverageItem(QTreeWidget* parent, int skipped, Coverage* c,
+    CalleeCoverageItem(QTreeWidget* parent, int skipped, CoverageValues* c,
                        TraceFunction* base,
                        EventType* ct, ProfileContext::Type gt);
 
     bool operator< ( const QTreeWidgetItem & other ) const override;
     TraceFunction* function() { return (_skipped) ? nullptr : _function; }
+    int skipped() const { return _skipped; }
     void setCostType(EventType* ct);
     void setGroupType(ProfileContext::Type);
     void update();
@@ -80,7 +82,7 @@ private:
     SubCost _cc;
     int _distance, _skipped;
     TraceFunction *_function, *_base;
-    Coverage* _coverage;
+    CoverageValues* _coverage;
 };
 
 #endif
@@ -31,6 +31,22 @@
 #include "globalconfig.h"
 #include "coverageitem.h"
 #include "coverage.h"
+#include "computecache.h"
+
+
+/*
+ * Result of a coverage analysis, shared among coverage views.
+ * Holds copies of the values of the Coverage objects, which are
+ * deleted after the analysis. The result may be deleted after the
+ * trace data, so the copies never must refer back to the functions.
+ */
+class CoverageResult: public ComputeResult
+{
+public:
+    ~CoverageResult() override { qDeleteAll(coverage); }
+
+    QHash<TraceFunction*, CoverageValues*> coverage;
+};
 
 
 //
@@ -42,6 +58,8 @@ CoverageView::CoverageView(bool showCallers, TraceItemView* parentView, QWidget*
     : QTreeWidget(parent), TraceItemView(parentView)
 {
     _showCallers = showCallers;
+    _result = nullptr;
+    _listCount = GlobalConfig::maxListCount();
 
     QStringList labels;
     labels  << tr( "Incl." );
@@ -198,8 +216,23 @@ void CoverageView::selectedSlot(QTreeWidgetItem* i, QTreeWidgetItem*)
     }
 }
 
+// if <i> is the item for skipped functions, show more of them
+bool CoverageView::showMore(QTreeWidgetItem* i)
+{
+    int skipped = _showCallers ?
+                      ((CallerCoverageItem*)i)->skipped() :
+                      ((CalleeCoverageItem*)i)->skipped();
+    if (skipped == 0) return false;
+
+    _listCount += GlobalConfig::maxListCount();
+    refresh();
+    return true;
+}
+
 void CoverageView::activatedSlot(QTreeWidgetItem* i, int)
 {
+    if (i && showMore(i)) return;
+
     TraceFunction* f = nullptr;
     if (i) {
         f = _showCallers ?
@@ -230,6 +263,8 @@ void CoverageView::keyPressEvent(QKeyEvent* event)
     if (item && ((event->key() == Qt::Key_Return) ||
                  (event->key() == Qt::Key_Space)))
     {
+        if (showMore(item)) return;
+
         TraceFunction* f;
         f = _showCallers ?
                 ((CallerCoverageItem*)item)->function() :
@@ -299,12 +334,26 @@ void CoverageView::doUpdate(int changeType, bool)
         return;
     }
 
+    if (changeType & activeItemChanged)
+        _listCount = GlobalConfig::maxListCount();
+
     refresh();
 }
 
+CoverageView::~CoverageView()
+{
+    // items refer to the coverage result
+    clear();
+    if (_result) _result->deref();
+}
+
 void CoverageView::refresh()
 {
     clear();
+    if (_result) {
+        _result->deref();
+        _result = nullptr;
+    }
 
     if (!_data || !_activeItem) return;
 
@@ -316,27 +365,46 @@ void CoverageView::refresh()
 
 
 
-    _hc.clear(GlobalConfig::maxListCount());
+    _hc.clear(_listCount);
     SubCost realSum = f->inclusive()->subCost(_eventType);
 
-    TraceFunctionList l;
-    if (_showCallers)
-        l = Coverage::coverage(f, Coverage::Caller, _eventType);
-    else
-        l = Coverage::coverage(f, Coverage::Called, _eventType);
+    // other views may have done the same analysis already
+    ComputeCache* cache = _data->computeCache();
+    ComputeKey key = cache->key(_showCallers ? ComputeCache::CallerCoverage :
+                                               ComputeCache::CalleeCoverage,
+                                f, _eventType);
+    CoverageResult* r = (CoverageResult*) cache->result(key);
+    if (!r) {
+        // no associations: the data model is not modified
+        CoverageMap map;
+        TraceFunctionList l;
+        if (_showCallers)
+            l = Coverage::coverage(f, Coverage::Caller, _eventType, &map);
+        else
+            l = Coverage::coverage(f, Coverage::Called, _eventType, &map);
+
+        r = new CoverageResult;
+        foreach(TraceFunction* f2, l) {
+            Coverage* c = map.value(f2);
+            if (!c || (c->inclusive()<=0.0)) continue;
 
-    foreach(TraceFunction* f2, l) {
-        Coverage* c = (Coverage*) f2->association(Coverage::Rtti);
-        if (c && (c->inclusive()>0.0))
-            _hc.addCost(f2, SubCost(realSum * c->inclusive()));
+            r->coverage.insert(f2, new CoverageValues(c));
+        }
+        qDeleteAll(map);
+        cache->insert(key, r);
     }
+    _result = r;
+
+    QHash<TraceFunction*, CoverageValues*>::const_iterator it;
+    for(it = r->coverage.constBegin(); it != r->coverage.constEnd(); ++it)
+        _hc.addCost(it.key(), SubCost(realSum * it.value()->inclusive()));
 
     QList<QTreeWidgetItem*> items;
     QTreeWidgetItem* item;
     TraceFunction* ff;
     for(int i=0;i<_hc.realCount();i++) {
         ff = (TraceFunction*) _hc[i];
-        Coverage* c = (Coverage*) ff->association(Coverage::Rtti);
+        CoverageValues* c = r->coverage.value(ff);
         if (_showCallers)
             item = new CallerCoverageItem(nullptr, c, f, _eventType, _groupType);
         else
@@ -346,7 +414,7 @@ void CoverageView::refresh()
     if (_hc.hasMore()) {
         // a placeholder for all the functions skipped ...
         ff = (TraceFunction*) _hc[_hc.maxSize()-1];
-        Coverage* c = (Coverage*) ff->association(Coverage::Rtti);
+        CoverageValues* c = r->coverage.value(ff);
         if (_showCallers)
             item = new CallerCoverageItem(nullptr, _hc.count() - _hc.maxSize(),
                                           c, f, _eventType, _groupType);
@@ -29,6 +29,8 @@
 #include "traceitemview.h"
 #include "listutils.h"
 
+class ComputeResult;
+
 class CoverageView: public QTreeWidget, public TraceItemView
 {
     Q_OBJECT
@@ -36,6 +38,7 @@ class CoverageView: public QTreeWidget, public TraceItemView
 public:
     CoverageView(bool showCallers, TraceItemView* parentView,
                  QWidget* parent = nullptr);
+    ~CoverageView() override;
 
     QWidget* widget() override { return this; }
     QString whatsThis() const override;
@@ -53,9 +56,14 @@ private:
     CostItem* canShow(CostItem*) override;
     void doUpdate(int, bool) override;
     void refresh();
+    bool showMore(QTreeWidgetItem*);
 
     HighestCostList _hc;
     bool _showCallers;
+    // number of functions shown, increased by activating skip item
+    int _listCount;
+    // shared coverage result referenced by our items
+    ComputeResult* _result;
 };
 
 #endif
@@ -20,11 +20,20 @@
 
 #include "globalguiconfig.h"
 #include "listutils.h"
+#include "dominators.h"
+#include "fleetstats.h"
+
+// quantiles shown in the percentile columns 7 - 9
+static const double fleetQuantile[] = { 0.5, 0.9, 0.99 };
 
 FunctionListModel::FunctionListModel()
     : QAbstractItemModel(nullptr)
 {
     _maxCount = 300;
+    _data = nullptr;
+    _eventType = nullptr;
+    _showPercentiles = false;
+    _showDominators = false;
     _sortColumn = 0;
     _sortOrder = Qt::DescendingOrder;
 
@@ -33,7 +42,12 @@ FunctionListModel::FunctionListModel()
             << tr("Self")
             << tr("Called")
             << tr("Function")
-            << tr("Location");
+            << tr("Location")
+            << tr("Dominated")
+            << tr("Dominator")
+            << tr("Incl. P50")
+            << tr("Incl. P90")
+            << tr("Incl. P99");
 
     _max0 = _max1 = _max2 = nullptr;
 }
@@ -43,7 +57,7 @@ FunctionListModel::~FunctionListModel()
 
 int FunctionListModel::columnCount(const QModelIndex& parent) const
 {
-    return (parent.isValid()) ? 0 : 5;
+    return (parent.isValid()) ? 0 : 10;
 }
 
 int FunctionListModel::rowCount(const QModelIndex& parent ) const
@@ -80,7 +94,9 @@ QVariant FunctionListModel::data(const QModelIndex &index, int role) const
     Q_ASSERT(f != nullptr);
     switch(role) {
     case Qt::TextAlignmentRole:
-        return (index.column()<3) ? Qt::AlignRight : Qt::AlignLeft;
+        return ((index.column()<3) || (index.column()==5) ||
+                (index.column()>6)) ?
+                    Qt::AlignRight : Qt::AlignLeft;
 
     case Qt::DecorationRole:
         switch (index.column()) {
@@ -107,6 +123,14 @@ QVariant FunctionListModel::data(const QModelIndex &index, int role) const
             return getName(f);
         case 4:
             return getLocation(f);
+        case 5:
+            return getDominatedCost(f);
+        case 6:
+            return getDominator(f);
+        case 7:
+        case 8:
+        case 9:
+            return getInclPercentile(f, fleetQuantile[index.column() - 7]);
         default:
             break;
         }
@@ -157,7 +181,8 @@ QModelIndex FunctionListModel::indexForFunction(TraceFunction *f, bool add)
              !_filteredList.contains(f) ) return QModelIndex();
 
         // find insertion point with current list order
-        FunctionLessThan lessThan(_sortColumn, _sortOrder, _eventType);
+        FunctionLessThan lessThan(_sortColumn, _sortOrder, _eventType, fleet(),
+                              dominators());
         QList<TraceFunction*>::iterator insertPos;
         insertPos = std::lower_bound(_topList.begin(), _topList.end(),
                                      f, lessThan);
@@ -196,6 +221,7 @@ void FunctionListModel::setFilter(QString filterString)
 void FunctionListModel::setEventType(EventType* et)
 {
     _eventType = et;
+    updateFleet();
     // needed to recalculate max value entries
     computeFilteredList();
     computeTopList();
@@ -208,11 +234,28 @@ void FunctionListModel::setMaxCount(int c)
     computeTopList();
 }
 
+void FunctionListModel::setShowPercentiles(bool show)
+{
+    if (_showPercentiles == show) return;
+    _showPercentiles = show;
+    updateFleet();
+    computeTopList();
+}
+
+void FunctionListModel::setShowDominators(bool show)
+{
+    if (_showDominators == show) return;
+    _showDominators = show;
+    computeTopList();
+}
+
 void FunctionListModel::resetModelData(TraceData *data,
                                        TraceCostItem *group, QString filterString,
                                        EventType * eventType)
 {
+    _data = data;
     _eventType = eventType;
+    updateFleet();
 
     if (!group) {
         _list.clear();
@@ -275,6 +318,25 @@ void FunctionListModel::resetModelData(TraceData *data,
     computeTopList();
 }
 
+void FunctionListModel::updateFleet()
+{
+    if (_showPercentiles && _data && _eventType &&
+        (_data->parts().count() > 1))
+        _data->fleetStatistics(_eventType);
+}
+
+FleetStatistics* FunctionListModel::fleet() const
+{
+    if (!_showPercentiles || !_data || !_eventType) return nullptr;
+    return _data->fleetStatistics(_eventType, false);
+}
+
+Dominators* FunctionListModel::dominators() const
+{
+    if (!_showDominators || !_data) return nullptr;
+    return _data->dominators();
+}
+
 void FunctionListModel::computeFilteredList()
 {
     FunctionLessThan lessThan0(0, Qt::AscendingOrder, _eventType);
@@ -309,7 +371,8 @@ void FunctionListModel::computeTopList()
         return;
     }
 
-    FunctionLessThan lessThan(_sortColumn, _sortOrder, _eventType);
+    FunctionLessThan lessThan(_sortColumn, _sortOrder, _eventType, fleet(),
+                              dominators());
     std::stable_sort(_filteredList.begin(), _filteredList.end(), lessThan);
 
     foreach(TraceFunction* f, _filteredList) {
@@ -412,6 +475,44 @@ QPixmap FunctionListModel::getInclPixmap(TraceFunction *f) const
 }
 
 
+QString FunctionListModel::getDominatedCost(TraceFunction *f) const
+{
+    Dominators* d = dominators();
+    if (!d) return QString();
+
+    double total = f->data()->subCost(_eventType);
+    if (total == 0.0)
+        return QStringLiteral("-");
+
+    SubCost dom = d->dominatedCost(f, _eventType);
+    if (GlobalConfig::showPercentage())
+        return QStringLiteral("%1")
+                .arg(100.0 * dom / total, 0, 'f', GlobalConfig::percentPrecision());
+    else
+        return dom.pretty();
+}
+
+QString FunctionListModel::getDominator(TraceFunction *f) const
+{
+    Dominators* d = dominators();
+    if (!d) return QString();
+
+    TraceFunction* idom = d->immediateDominator(f);
+    return idom ? idom->prettyName() : QString();
+}
+
+QString FunctionListModel::getInclPercentile(TraceFunction *f, double q) const
+{
+    FleetStatistics* fs = fleet();
+    int i = fs ? fs->find(f) : -1;
+    if (i < 0)
+        return QStringLiteral("-");
+
+    return QStringLiteral("%1")
+            .arg(100.0 * fs->inclusive(i, q), 0, 'f',
+                 GlobalConfig::percentPrecision());
+}
+
 QString FunctionListModel::getCallCount(TraceFunction *f) const
 {
     QString str;
@@ -465,6 +566,31 @@ bool FunctionListModel::FunctionLessThan::operator()(TraceFunction *left,
 
     case 4:
         return f1->object()->name() < f2->object()->name();
+
+    case 5:
+    {
+        if (!_dominators) return false;
+        return _dominators->dominatedCost(f1, _eventType) <
+                _dominators->dominatedCost(f2, _eventType);
+    }
+
+    case 6:
+    {
+        if (!_dominators) return false;
+        TraceFunction* d1 = _dominators->immediateDominator(f1);
+        TraceFunction* d2 = _dominators->immediateDominator(f2);
+        return (d1 ? d1->name() : QString()) < (d2 ? d2->name() : QString());
+    }
+
+    case 7:
+    case 8:
+    case 9:
+    {
+        if (!_fleet) return false;
+        double q = fleetQuantile[_column - 7];
+        return _fleet->inclusive(_fleet->find(f1), q) <
+                _fleet->inclusive(_fleet->find(f2), q);
+    }
     }
 
     return false;
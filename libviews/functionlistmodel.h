@@ -27,6 +27,9 @@
 #include "tracedata.h"
 #include "subcost.h"
 
+class FleetStatistics;
+class Dominators;
+
 
 class FunctionListModel : public QAbstractItemModel
 {
@@ -58,6 +61,12 @@ public:
     void setFilter(QString filter);
     void setEventType(EventType*);
     void setMaxCount(int);
+    // percentile columns are calculated only if shown
+    void setShowPercentiles(bool);
+    bool showPercentiles() const { return _showPercentiles; }
+    // same for dominated cost and dominator columns
+    void setShowDominators(bool);
+    bool showDominators() const { return _showDominators; }
 
     TraceFunction* function(const QModelIndex &index);
     // get index of an entry showing a function, optionally adding it if needed
@@ -66,8 +75,11 @@ public:
     class FunctionLessThan
     {
     public:
-        FunctionLessThan(int column, Qt::SortOrder order, EventType* et)
-        { _column = column; _order = order; _eventType = et; }
+        FunctionLessThan(int column, Qt::SortOrder order, EventType* et,
+                         FleetStatistics* fleet = nullptr,
+                         Dominators* dominators = nullptr)
+        { _column = column; _order = order; _eventType = et;
+          _fleet = fleet; _dominators = dominators; }
 
         bool operator()(TraceFunction *left, TraceFunction *right);
 
@@ -75,6 +87,8 @@ public:
         int _column;
         Qt::SortOrder _order;
         EventType* _eventType;
+        FleetStatistics* _fleet;
+        Dominators* _dominators;
     };
 
 private:
@@ -86,7 +100,17 @@ private:
     QPixmap getSelfPixmap(TraceFunction *f) const;
     QString getCallCount(TraceFunction *f) const;
     QString getLocation(TraceFunction *f) const;
+    QString getDominatedCost(TraceFunction *f) const;
+    QString getDominator(TraceFunction *f) const;
     QString getSkippedCost(TraceFunction *f, QPixmap *pixmap) const;
+    QString getInclPercentile(TraceFunction *f, double q) const;
+
+    // percentiles over parts, only with more than one part.
+    // fleet() never calculates: data may be in the middle of loading
+    void updateFleet();
+    FleetStatistics* fleet() const;
+    // nullptr if dominator columns are hidden
+    Dominators* dominators() const;
 
     // compute the list of candidates to show, ignoring order
     void computeFilteredList();
@@ -94,7 +118,10 @@ private:
     void computeTopList();
 
     QList<QVariant> _headerData;
+    TraceData *_data;
     EventType *_eventType;
+    bool _showPercentiles;
+    bool _showDominators;
     ProfileContext::Type _groupType;
     int _maxCount;
 
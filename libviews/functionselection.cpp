@@ -42,6 +42,7 @@
 #include "costlistitem.h"
 #include "globalconfig.h"
 #include "functionlistmodel.h"
+#include "groupcosts.h"
 
 
 // custom item delegate for function list
@@ -306,6 +307,18 @@ void FunctionSelection::functionContext(const QPoint & p)
 
     QMenu* m = popup.addMenu(tr("Grouping"));
     updateGroupingMenu(m);
+
+    // percentiles are expensive to calculate: only on request
+    QAction* percentilesAction = nullptr;
+    if (_data && (_data->parts().count() > 1)) {
+        percentilesAction = popup.addAction(tr("Show Percentiles over Parts"));
+        percentilesAction->setCheckable(true);
+        percentilesAction->setChecked(functionListModel->showPercentiles());
+    }
+    // dominators are expensive, too, and recalculated on cycle changes
+    QAction* dominatorsAction = popup.addAction(tr("Show Dominators"));
+    dominatorsAction->setCheckable(true);
+    dominatorsAction->setChecked(functionListModel->showDominators());
     popup.addSeparator();
     addGoMenu(&popup);
 
@@ -313,6 +326,14 @@ void FunctionSelection::functionContext(const QPoint & p)
     QAction* a = popup.exec(functionList->mapToGlobal(p + pDiff));
     if (a == activateFunctionAction)
         activated(f);
+    else if (a && (a == percentilesAction)) {
+        functionListModel->setShowPercentiles(a->isChecked());
+        setCostColumnWidths();
+    }
+    else if (a && (a == dominatorsAction)) {
+        functionListModel->setShowDominators(a->isChecked());
+        setCostColumnWidths();
+    }
 }
 
 void FunctionSelection::groupContext(const QPoint & p)
@@ -611,10 +632,6 @@ void FunctionSelection::refresh()
     }
 
 
-    TraceObjectMap::Iterator oit;
-    TraceClassMap::Iterator cit;
-    TraceFileMap::Iterator fit;
-
     // Fill up group list.
     // Always show group of current function, even if cost below low limit.
     //
@@ -623,24 +640,15 @@ void FunctionSelection::refresh()
 
     switch(_groupType) {
     case ProfileContext::Object:
-
-        for ( oit = _data->objectMap().begin();
-              oit != _data->objectMap().end(); ++oit )
-            _hc.addCost(&(*oit), (*oit).subCost(_eventType));
-        break;
-
     case ProfileContext::Class:
-
-        for ( cit = _data->classMap().begin();
-              cit != _data->classMap().end(); ++cit )
-            _hc.addCost(&(*cit), (*cit).subCost(_eventType));
-        break;
-
     case ProfileContext::File:
-
-        for ( fit = _data->fileMap().begin();
-              fit != _data->fileMap().end(); ++fit )
-            _hc.addCost(&(*fit), (*fit).subCost(_eventType));
+    {
+        // aggregates of all groups, with event type evaluated in one go
+        const GroupCostColumns& groups = _data->groupCosts()->columns(_groupType);
+        QVector<SubCost> costs = groups.costs(_eventType);
+        for(int i=0; i<groups.count(); i++)
+            _hc.addCost(groups.group(i), costs.at(i));
+    }
         break;
 
     case ProfileContext::FunctionCycle:
@@ -892,11 +900,28 @@ void FunctionSelection::setCostColumnWidths()
         functionList->resizeColumnToContents(0);
     else
         functionList->header()->resizeSection(0, 0);
+    for(int col=5; col<7; col++) {
+        if (functionListModel->showDominators())
+            functionList->resizeColumnToContents(col);
+        else
+            functionList->header()->resizeSection(col, 0);
+    }
+
+    // percentiles over parts are only available with multiple parts
+    bool percentiles = functionListModel->showPercentiles() &&
+                       (_data->parts().count() > 1);
+    for(int col=7; col<10; col++) {
+        if (percentiles)
+            functionList->resizeColumnToContents(col);
+        else
+            functionList->header()->resizeSection(col, 0);
+    }
 }
 
 void FunctionSelection::functionHeaderClicked(int col)
 {
-    if ((_functionListSortOrder== Qt::AscendingOrder) || (col<3))
+    if ((_functionListSortOrder== Qt::AscendingOrder) || (col<3) || (col==5) ||
+        (col>6))
         _functionListSortOrder = Qt::DescendingOrder;
     else
         _functionListSortOrder = Qt::AscendingOrder;
@@ -0,0 +1,439 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Heatmap View
+ */
+
+
+#include "heatmapview.h"
+
+#include <math.h>
+
+#include <QAction>
+#include <QMenu>
+#include <QPainter>
+#include <QImage>
+#include <QScrollBar>
+#include <QHelpEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QToolTip>
+
+#include "globalconfig.h"
+#include "config.h"
+
+#define DEFAULT_MODE "Lines"
+// minimal width of a part column, in pixels
+#define MIN_CELLWIDTH 3
+#define MAX_CELLWIDTH 40
+
+
+//
+// HeatmapView
+//
+
+
+HeatmapView::HeatmapView(TraceItemView* parentView, QWidget* parent)
+    : QAbstractScrollArea(parent), TraceItemView(parentView)
+{
+    _mode = CostHeatmap::Lines;
+    _rowHeight = fontMetrics().height() + 2;
+    _cellWidth = MIN_CELLWIDTH;
+    _labelWidth = 0;
+    _currentRow = -1;
+
+    setMinimumHeight(50);
+    setFocusPolicy(Qt::StrongFocus);
+    verticalScrollBar()->setSingleStep(1);
+
+    this->setWhatsThis( whatsThis() );
+
+    setContextMenuPolicy(Qt::CustomContextMenu);
+    connect( this,
+             &QWidget::customContextMenuRequested,
+             this, &HeatmapView::context);
+}
+
+QString HeatmapView::whatsThis() const
+{
+    return tr( "<b>Cost Heatmap</b>"
+               "<p>This view shows the cost of source lines (or "
+               "instructions) of the current function over time: "
+               "there is one row per line with cost, and one column "
+               "per profile part, e.g. each time slice of a program "
+               "run. The darker the color of a cell, the more cost "
+               "the line has in the part. All parts are shown, "
+               "active ones are marked in the header.</p>"
+
+               "<p>Clicking on a row selects the line, and "
+               "double clicking on a cell restricts all cost views "
+               "to the part of the cell.</p>");
+}
+
+void HeatmapView::context(const QPoint & p)
+{
+    QMenu popup;
+
+    QAction* linesAction = popup.addAction(tr("Source Lines"));
+    linesAction->setCheckable(true);
+    linesAction->setChecked(_mode == CostHeatmap::Lines);
+    QAction* instrAction = popup.addAction(tr("Instructions"));
+    instrAction->setCheckable(true);
+    instrAction->setChecked(_mode == CostHeatmap::Instructions);
+    popup.addSeparator();
+
+    addEventTypeMenu(&popup, false);
+    popup.addSeparator();
+    addGoMenu(&popup);
+
+    QAction* a = popup.exec(mapToGlobal(p));
+    if ((a == linesAction) || (a == instrAction)) {
+        _mode = (a == linesAction) ? CostHeatmap::Lines :
+                                     CostHeatmap::Instructions;
+        refresh();
+    }
+}
+
+CostItem* HeatmapView::canShow(CostItem* i)
+{
+    ProfileContext::Type t = i ? i->type() : ProfileContext::InvalidType;
+
+    switch(t) {
+    case ProfileContext::Function:
+        return i;
+
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+void HeatmapView::doUpdate(int changeType, bool)
+{
+    if (changeType == selectedItemChanged) {
+        int row = -1;
+        if (_selectedItem && (_mode == CostHeatmap::Lines)) {
+            TraceLine* l = nullptr;
+            if (_selectedItem->type() == ProfileContext::Line)
+                l = (TraceLine*) _selectedItem;
+            if (_selectedItem->type() == ProfileContext::Instr)
+                l = ((TraceInstr*)_selectedItem)->line();
+            if (l)
+                row = _heatmap.findRow(l->functionSource(), l->lineno());
+        }
+        if (_selectedItem && (_mode == CostHeatmap::Instructions) &&
+            (_selectedItem->type() == ProfileContext::Instr))
+            row = _heatmap.findRow(((TraceInstr*)_selectedItem)->addr());
+        setCurrentRow(row, false);
+        return;
+    }
+
+    if (changeType == eventTypeChanged) {
+        _heatmap.setEventType(_eventType);
+        viewport()->update();
+        return;
+    }
+
+    // only the header marks active parts
+    if (changeType == partsChanged) {
+        viewport()->update();
+        return;
+    }
+
+    if (changeType == groupTypeChanged) return;
+
+    refresh();
+}
+
+void HeatmapView::refresh()
+{
+    TraceFunction* f = nullptr;
+    if (_activeItem && (_activeItem->type() == ProfileContext::Function))
+        f = (TraceFunction*) _activeItem;
+
+    _heatmap.calculate(f, _mode);
+    _heatmap.setEventType(_eventType);
+    _currentRow = -1;
+
+    // labels of the first rows give the width of the label column
+    QFontMetrics fm = fontMetrics();
+    _labelWidth = fm.boundingRect(QStringLiteral("0x0000000000")).width();
+    for(int row=0; (row<_heatmap.rowCount()) && (row<100); row++)
+        _labelWidth = qMax(_labelWidth,
+                           fm.boundingRect(_heatmap.rowLabel(row)).width());
+    _labelWidth += 8;
+
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    layoutCells();
+    viewport()->update();
+}
+
+// cell width and scroll ranges for current viewport size
+void HeatmapView::layoutCells()
+{
+    int parts = _heatmap.partCount();
+    int available = viewport()->width() - _labelWidth;
+    _cellWidth = (parts > 0) ? available / parts : MIN_CELLWIDTH;
+    if (_cellWidth < MIN_CELLWIDTH) _cellWidth = MIN_CELLWIDTH;
+    if (_cellWidth > MAX_CELLWIDTH) _cellWidth = MAX_CELLWIDTH;
+
+    // vertical scrolling is in rows, horizontal in pixels
+    int visibleRows = (viewport()->height() - _rowHeight) / _rowHeight;
+    if (visibleRows < 1) visibleRows = 1;
+    verticalScrollBar()->setRange(0, qMax(0, _heatmap.rowCount() - visibleRows));
+    verticalScrollBar()->setPageStep(visibleRows);
+
+    int width = parts * _cellWidth;
+    horizontalScrollBar()->setRange(0, qMax(0, width - available));
+    horizontalScrollBar()->setPageStep(qMax(1, available));
+    horizontalScrollBar()->setSingleStep(_cellWidth);
+}
+
+void HeatmapView::resizeEvent(QResizeEvent* e)
+{
+    QAbstractScrollArea::resizeEvent(e);
+    layoutCells();
+}
+
+int HeatmapView::rowAt(int y) const
+{
+    if (y < _rowHeight) return -1;
+    int row = verticalScrollBar()->value() + (y - _rowHeight) / _rowHeight;
+    return (row < _heatmap.rowCount()) ? row : -1;
+}
+
+int HeatmapView::columnAt(int x) const
+{
+    if (x < _labelWidth) return -1;
+    int col = (x - _labelWidth + horizontalScrollBar()->value()) / _cellWidth;
+    return (col < _heatmap.partCount()) ? col : -1;
+}
+
+// light yellow for low cost to dark red for highest cost
+QRgb HeatmapView::cellColor(SubCost cost) const
+{
+    double max = (double) _heatmap.maxCost();
+    double t = (max > 0.0) ? sqrt((double) cost / max) : 0.0;
+    if (t > 1.0) t = 1.0;
+    return QColor::fromHsv((int)(60 * (1.0 - t)), (int)(60 + 195 * t),
+                           (int)(255 - 105 * t)).rgb();
+}
+
+void HeatmapView::paintEvent(QPaintEvent*)
+{
+    QPainter p(viewport());
+    int w = viewport()->width(), h = viewport()->height();
+    p.fillRect(0, 0, w, h, palette().base());
+
+    if (_heatmap.rowCount() == 0) {
+        p.drawText(0, 0, w, h, Qt::AlignCenter,
+                   _heatmap.function() ? tr("(no cost information)") :
+                                         tr("(no function selected)"));
+        return;
+    }
+
+    int firstRow = verticalScrollBar()->value();
+    int xOffset = horizontalScrollBar()->value();
+    int imgWidth = w - _labelWidth, imgHeight = h - _rowHeight;
+    if ((imgWidth <= 0) || (imgHeight <= 0)) return;
+
+    // header: active parts, and part numbers
+    int firstCol = xOffset / _cellWidth;
+    int step = 1;
+    while(step * _cellWidth < 4 * fontMetrics().height()) step *= 2;
+    p.setClipRect(_labelWidth, 0, imgWidth, _rowHeight);
+    for(int col=firstCol; col<_heatmap.partCount(); col++) {
+        int x = _labelWidth + col * _cellWidth - xOffset;
+        if (x >= w) break;
+        if (_partList.contains(_heatmap.part(col)))
+            p.fillRect(x, _rowHeight - 3, _cellWidth, 3,
+                       palette().highlight());
+        if (col % step == 0)
+            p.drawText(x, 0, step * _cellWidth, _rowHeight - 3,
+                       Qt::AlignLeft | Qt::AlignVCenter,
+                       QString::number(col + 1));
+    }
+    p.setClipping(false);
+
+    // cells: only visible ones, written directly into an image
+    QImage img(imgWidth, imgHeight, QImage::Format_RGB32);
+    img.fill(palette().base().color().rgb());
+    int gap = (_cellWidth > 4) ? 1 : 0;
+    int lastRow = firstRow;
+    for(int row=firstRow; row<_heatmap.rowCount(); row++) {
+        int y = (row - firstRow) * _rowHeight;
+        if (y >= imgHeight) break;
+        lastRow = row;
+        int yEnd = qMin(y + _rowHeight - 1, imgHeight);
+
+        for(int cell=_heatmap.cellStart(row); cell<_heatmap.cellEnd(row); cell++) {
+            int x = _heatmap.cellColumn(cell) * _cellWidth - xOffset;
+            if (x + _cellWidth <= 0) continue;
+            if (x >= imgWidth) break;
+            SubCost cost = _heatmap.cellCost(cell);
+            if (cost == 0) continue;
+
+            QRgb c = cellColor(cost);
+            int x1 = qMax(x, 0), x2 = qMin(x + _cellWidth - gap, imgWidth);
+            for(int yy=y; yy<yEnd; yy++) {
+                QRgb* line = (QRgb*) img.scanLine(yy);
+                for(int xx=x1; xx<x2; xx++)
+                    line[xx] = c;
+            }
+        }
+    }
+    p.drawImage(_labelWidth, _rowHeight, img);
+
+    // row labels, current row
+    for(int row=firstRow; row<=lastRow; row++) {
+        QRect r(0, _rowHeight + (row - firstRow) * _rowHeight,
+                _labelWidth - 4, _rowHeight);
+        if (row == _currentRow) {
+            p.fillRect(r, palette().highlight());
+            p.setPen(palette().highlightedText().color());
+        }
+        else
+            p.setPen(palette().text().color());
+        p.drawText(r, Qt::AlignRight | Qt::AlignVCenter,
+                   _heatmap.rowLabel(row));
+    }
+    if ((_currentRow >= firstRow) && (_currentRow <= lastRow)) {
+        p.setPen(palette().highlight().color());
+        p.drawRect(_labelWidth, _rowHeight + (_currentRow - firstRow) * _rowHeight,
+                   imgWidth - 1, _rowHeight - 1);
+    }
+}
+
+void HeatmapView::setCurrentRow(int row, bool select)
+{
+    if ((row < 0) || (row >= _heatmap.rowCount())) {
+        _currentRow = -1;
+        viewport()->update();
+        return;
+    }
+    _currentRow = row;
+
+    // make visible
+    int first = verticalScrollBar()->value();
+    int visible = verticalScrollBar()->pageStep();
+    if (row < first)
+        verticalScrollBar()->setValue(row);
+    else if (row >= first + visible)
+        verticalScrollBar()->setValue(row - visible + 1);
+    viewport()->update();
+
+    if (!select) return;
+
+    CostItem* item = nullptr;
+    if (_mode == CostHeatmap::Lines) {
+        TraceFunctionSource* fs = _heatmap.rowSource(row);
+        if (fs) item = fs->line(_heatmap.rowLine(row), false);
+    }
+    else if (_heatmap.function())
+        item = _heatmap.function()->instr(_heatmap.rowAddr(row), false);
+
+    if (item) {
+        _selectedItem = item;
+        selected(item);
+    }
+}
+
+void HeatmapView::mousePressEvent(QMouseEvent* e)
+{
+    if (e->button() == Qt::LeftButton) {
+        int row = rowAt(e->pos().y());
+        if (row >= 0) setCurrentRow(row, true);
+    }
+    QAbstractScrollArea::mousePressEvent(e);
+}
+
+void HeatmapView::mouseDoubleClickEvent(QMouseEvent* e)
+{
+    int col = columnAt(e->pos().x());
+    TracePart* part = (rowAt(e->pos().y()) >= 0) ? _heatmap.part(col) : nullptr;
+    if (part) {
+        TracePartList l;
+        l.append(part);
+        partsSelected(l);
+    }
+}
+
+void HeatmapView::keyPressEvent(QKeyEvent* e)
+{
+    int row = _currentRow;
+    switch(e->key()) {
+    case Qt::Key_Up:       row--; break;
+    case Qt::Key_Down:     row++; break;
+    case Qt::Key_PageUp:   row -= verticalScrollBar()->pageStep(); break;
+    case Qt::Key_PageDown: row += verticalScrollBar()->pageStep(); break;
+    case Qt::Key_Home:     row = 0; break;
+    case Qt::Key_End:      row = _heatmap.rowCount() - 1; break;
+    default:
+        QAbstractScrollArea::keyPressEvent(e);
+        return;
+    }
+    if (row < 0) row = 0;
+    if (row >= _heatmap.rowCount()) row = _heatmap.rowCount() - 1;
+    setCurrentRow(row, true);
+}
+
+bool HeatmapView::viewportEvent(QEvent* e)
+{
+    if (e->type() == QEvent::ToolTip) {
+        QHelpEvent* he = (QHelpEvent*) e;
+        int row = rowAt(he->pos().y());
+        int col = columnAt(he->pos().x());
+        if ((row >= 0) && (col >= 0)) {
+            QString tip = QStringLiteral("%1\n%2: %3 %4")
+                          .arg(_heatmap.rowLabel(row))
+                          .arg(_heatmap.part(col)->prettyName())
+                          .arg(_heatmap.cost(row, col).pretty())
+                          .arg(_eventType ? _eventType->name() : QString());
+            QToolTip::showText(he->globalPos(), tip, this);
+        }
+        else
+            QToolTip::hideText();
+        return true;
+    }
+    return QAbstractScrollArea::viewportEvent(e);
+}
+
+void HeatmapView::restoreOptions(const QString& prefix, const QString& postfix)
+{
+    ConfigGroup* g = ConfigStorage::group(prefix, postfix);
+
+    QString mode = g->value(QStringLiteral("Mode"),
+                            QStringLiteral(DEFAULT_MODE)).toString();
+    _mode = (mode == QLatin1String("Instructions")) ?
+                CostHeatmap::Instructions : CostHeatmap::Lines;
+    delete g;
+}
+
+void HeatmapView::saveOptions(const QString& prefix, const QString& postfix)
+{
+    ConfigGroup* g = ConfigStorage::group(prefix + postfix);
+
+    g->setValue(QStringLiteral("Mode"),
+                (_mode == CostHeatmap::Instructions) ?
+                    QStringLiteral("Instructions") : QStringLiteral("Lines"),
+                QStringLiteral(DEFAULT_MODE));
+    delete g;
+}
@@ -0,0 +1,82 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Heatmap View
+ */
+
+#ifndef HEATMAPVIEW_H
+#define HEATMAPVIEW_H
+
+#include <QAbstractScrollArea>
+
+#include "tracedata.h"
+#include "traceitemview.h"
+#include "costheatmap.h"
+
+/**
+ * Cost of the source lines or instructions of the active function
+ * over time: one row per line or instruction, one column per profile
+ * part, with cell color showing the cost.
+ *
+ * Only the visible cells are drawn, into an image, so scrolling stays
+ * fast for large functions with many parts.
+ */
+class HeatmapView: public QAbstractScrollArea, public TraceItemView
+{
+    Q_OBJECT
+
+public:
+    explicit HeatmapView(TraceItemView* parentView,
+                         QWidget* parent = nullptr);
+
+    QWidget* widget() override { return this; }
+    QString whatsThis() const override;
+
+    void restoreOptions(const QString& prefix, const QString& postfix) override;
+    void saveOptions(const QString& prefix, const QString& postfix) override;
+
+protected Q_SLOTS:
+    void context(const QPoint &);
+
+protected:
+    void paintEvent(QPaintEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
+    void mousePressEvent(QMouseEvent*) override;
+    void mouseDoubleClickEvent(QMouseEvent*) override;
+    void keyPressEvent(QKeyEvent*) override;
+    bool viewportEvent(QEvent*) override;
+
+private:
+    CostItem* canShow(CostItem*) override;
+    void doUpdate(int, bool) override;
+    void refresh();
+    void layoutCells();
+    void setCurrentRow(int row, bool select);
+    // -1 if outside of cells
+    int rowAt(int y) const;
+    int columnAt(int x) const;
+    QRgb cellColor(SubCost) const;
+
+    CostHeatmap _heatmap;
+    CostHeatmap::Mode _mode;
+    int _rowHeight, _cellWidth, _labelWidth;
+    int _currentRow;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Items of hot lines view.
+ */
+
+#include "hotlinesitem.h"
+
+#include "globalguiconfig.h"
+#include "hotlines.h"
+
+
+// HotLineItem
+
+HotLineItem::HotLineItem(QTreeWidget* parent, HotLines* hl, int index,
+                         EventType* ct, ProfileContext::Type gt)
+    : RankedListItem(parent, hl->data(), hl->line(index).file,
+                     hl->line(index).lineno, hl->line(index).function,
+                     hl->line(index).functionCount)
+{
+    _hotLines = hl;
+    _index = index;
+    hl->addCost(index, &_cost);
+
+    setText(2, QStringLiteral("%1:%2").arg(_file->shortName()).arg(_lineno));
+    setTextAlignment(1, Qt::AlignRight);
+    setCostType(ct);
+    setGroupType(gt);
+}
+
+HotLineItem::HotLineItem(QTreeWidget* parent, int skipped,
+                         HotLines* hl, int index,
+                         EventType* ct, ProfileContext::Type gt)
+    : RankedListItem(parent, skipped, hl->data())
+{
+    _hotLines = hl;
+    _index = index;
+    hl->addCost(index, &_cost);
+
+    //~ singular (%n line skipped)
+    //~ plural (%n lines skipped)
+    setText(2, QObject::tr("(%n line(s) skipped)", "", _skipped));
+    setTextAlignment(1, Qt::AlignRight);
+    setCostType(ct);
+}
+
+void HotLineItem::update()
+{
+    _ratio = _skipped ? -1.0 : _hotLines->missRatio(_index, _costType);
+    RankedListItem::update();
+
+    if ((_ratio < 0.0) || (_pure == 0))
+        setText(1, QString());
+    else
+        setText(1, QStringLiteral("%1 %")
+                .arg(100.0 * _ratio, 0, 'f',
+                     GlobalConfig::percentPrecision()));
+}
+
+
+bool HotLineItem::operator<( const QTreeWidgetItem & other ) const
+{
+    const HotLineItem* hi2 = (HotLineItem*) &other;
+
+    if ((treeWidget()->sortColumn() == 1) && !_skipped && !hi2->_skipped)
+        return _ratio < hi2->_ratio;
+
+    return RankedListItem::operator <(other);
+}
@@ -0,0 +1,50 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Items of hot lines view.
+ */
+
+#ifndef HOTLINESITEM_H
+#define HOTLINESITEM_H
+
+#include "rankedlistitem.h"
+
+class HotLines;
+
+class HotLineItem: public RankedListItem
+{
+public:
+    HotLineItem(QTreeWidget* parent, HotLines* hl, int index,
+                EventType* ct, ProfileContext::Type gt);
+    HotLineItem(QTreeWidget* parent, int skipped, HotLines* hl, int index,
+                EventType* ct, ProfileContext::Type gt);
+
+    bool operator< ( const QTreeWidgetItem & other ) const override;
+    void update() override;
+
+protected:
+    int sourceColumn() const override { return 2; }
+
+private:
+    double _ratio;
+    HotLines* _hotLines;
+    int _index;
+};
+
+#endif
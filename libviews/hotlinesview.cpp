@@ -0,0 +1,92 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Hot Lines View
+ */
+
+
+#include "hotlinesview.h"
+
+#include "hotlinesitem.h"
+
+
+//
+// HotLinesView
+//
+
+
+HotLinesView::HotLinesView(TraceItemView* parentView, QWidget* parent)
+    : RankedListView(parentView, parent, 2)
+{
+    QStringList labels;
+    labels  << tr( "Cost" )
+            << tr( "Miss Ratio" )
+            << tr( "Source Line" )
+            << tr( "Function" );
+    setHeaderLabels(labels);
+
+    this->setWhatsThis( whatsThis() );
+}
+
+QString HotLinesView::whatsThis() const
+{
+    return tr( "<b>Hot Lines</b>"
+               "<p>This list shows the source lines with highest "
+               "cost of the whole program, independent from the "
+               "current selected function. Cost of a line is summed "
+               "up over all functions with code from this line, "
+               "including code inlined into other functions.</p>"
+
+               "<p>For cache and branch miss events, the miss ratio "
+               "is the percentage of misses among the related "
+               "accesses at this line (e.g. D1mr / Dr).</p>"
+
+               "<p>The function shown is the one contributing most "
+               "cost to a line. Selecting a line makes this function "
+               "the current selected one of this information "
+               "panel and shows the line in the source view.</p>");
+}
+
+void HotLinesView::calculate()
+{
+    _hotLines.calculate(_data);
+}
+
+QVector<int> HotLinesView::topEntries(int n, int* total) const
+{
+    return _hotLines.top(_eventType, n, total);
+}
+
+RankedListItem* HotLinesView::newItem(int index, int skipped)
+{
+    if (skipped > 0)
+        return new HotLineItem(nullptr, skipped, &_hotLines, index,
+                               _eventType, _groupType);
+    return new HotLineItem(nullptr, &_hotLines, index, _eventType, _groupType);
+}
+
+void HotLinesView::refresh()
+{
+    RankedListView::refresh();
+
+    if (_eventType && !HotLines::accessType(_eventType)) {
+        // hide miss ratio
+        setColumnWidth(1, 0);
+    }
+}
@@ -0,0 +1,54 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Hot Lines View
+ */
+
+#ifndef HOTLINESVIEW_H
+#define HOTLINESVIEW_H
+
+#include "rankedlistview.h"
+#include "hotlines.h"
+
+/**
+ * List of source lines with highest cost of the whole program,
+ * independent from the active function.
+ */
+class HotLinesView: public RankedListView
+{
+    Q_OBJECT
+
+public:
+    explicit HotLinesView(TraceItemView* parentView,
+                          QWidget* parent = nullptr);
+
+    QString whatsThis() const override;
+
+protected:
+    TraceData* listData() const override { return _hotLines.data(); }
+    void calculate() override;
+    QVector<int> topEntries(int n, int* total) const override;
+    RankedListItem* newItem(int index, int skipped) override;
+    void refresh() override;
+
+private:
+    HotLines _hotLines;
+};
+
+#endif
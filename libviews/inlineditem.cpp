@@ -0,0 +1,82 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Items of inlined hotspots view.
+ */
+
+#include "inlineditem.h"
+
+#include "inlinedindex.h"
+
+
+// InlinedItem
+
+InlinedItem::InlinedItem(QTreeWidget* parent, InlinedIndex* ii, int index,
+                         EventType* ct, ProfileContext::Type gt)
+    : RankedListItem(parent, ii->data(), ii->range(index).file,
+                     ii->range(index).firstLineno, ii->range(index).function,
+                     ii->range(index).functionCount)
+{
+    const InlinedRange& r = ii->range(index);
+
+    _lastLineno = r.lastLineno;
+    _inlinedFunction = r.inlinedFunction;
+    ii->addCost(index, &_cost);
+
+    setText(1, r.name());
+    if (_inlinedFunction)
+        setText(2, _inlinedFunction->prettyName());
+    setCostType(ct);
+    setGroupType(gt);
+}
+
+InlinedItem::InlinedItem(QTreeWidget* parent, int skipped,
+                         InlinedIndex* ii, int index,
+                         EventType* ct, ProfileContext::Type gt)
+    : RankedListItem(parent, skipped, ii->data())
+{
+    _lastLineno = 0;
+    _inlinedFunction = nullptr;
+    ii->addCost(index, &_cost);
+
+    //~ singular (%n range skipped)
+    //~ plural (%n ranges skipped)
+    setText(1, QObject::tr("(%n range(s) skipped)", "", _skipped));
+    setCostType(ct);
+}
+
+bool InlinedItem::contains(TraceFile* file, uint lineno)
+{
+    return !_skipped && (file == _file) &&
+            (lineno >= _lineno) && (lineno <= _lastLineno);
+}
+
+TraceLine* InlinedItem::line()
+{
+    if (_skipped || !_function || !_file) return nullptr;
+
+    // the containing function may not have code from all lines
+    TraceFunctionSource* sf = _function->sourceFile(_file, false);
+    if (!sf) return nullptr;
+    for(uint l = _lineno; l <= _lastLineno; l++) {
+        TraceLine* line = sf->line(l, false);
+        if (line) return line;
+    }
+    return nullptr;
+}
@@ -0,0 +1,54 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Items of inlined hotspots view.
+ */
+
+#ifndef INLINEDITEM_H
+#define INLINEDITEM_H
+
+#include "rankedlistitem.h"
+
+class InlinedIndex;
+
+class InlinedItem: public RankedListItem
+{
+public:
+    InlinedItem(QTreeWidget* parent, InlinedIndex* ii, int index,
+                EventType* ct, ProfileContext::Type gt);
+    InlinedItem(QTreeWidget* parent, int skipped, InlinedIndex* ii, int index,
+                EventType* ct, ProfileContext::Type gt);
+
+    TraceFunction* relatedFunction() override { return inlinedFunction(); }
+    TraceFunction* inlinedFunction()
+    { return (_skipped) ? nullptr : _inlinedFunction; }
+    bool contains(TraceFile* file, uint lineno) override;
+    // first line with cost of function() in range
+    TraceLine* line() override;
+
+protected:
+    int sourceColumn() const override { return 1; }
+
+private:
+    // range is [_lineno, _lastLineno]
+    uint _lastLineno;
+    TraceFunction* _inlinedFunction;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Inlined Hotspots View
+ */
+
+
+#include "inlinedview.h"
+
+#include "inlineditem.h"
+
+
+//
+// InlinedView
+//
+
+
+InlinedView::InlinedView(TraceItemView* parentView, QWidget* parent)
+    : RankedListView(parentView, parent, 1)
+{
+    QStringList labels;
+    labels  << tr( "Cost" )
+            << tr( "Inlined Code" )
+            << tr( "Inlined Function" )
+            << tr( "Containing Function" );
+    setHeaderLabels(labels);
+
+    this->setWhatsThis( whatsThis() );
+}
+
+QString InlinedView::whatsThis() const
+{
+    return tr( "<b>Inlined Hotspots</b>"
+               "<p>This list shows ranges of source lines from "
+               "code which was inlined into other functions, e.g. "
+               "template or inline functions from header files. "
+               "Cost of a range is summed up over all functions "
+               "containing inlined code from it, independent from "
+               "the current selected function.</p>"
+
+               "<p>As profile data has no information about the "
+               "boundaries of inlined functions, ranges are built "
+               "from lines near to each other. If some function "
+               "also has non-inlined code covering a range, it is "
+               "shown as inlined function.</p>"
+
+               "<p>The containing function shown is the one with most "
+               "cost from a range. Selecting a range makes this "
+               "function the current selected one of this information "
+               "panel and shows the range in the source view.</p>");
+}
+
+void InlinedView::calculate()
+{
+    _inlined.calculate(_data);
+}
+
+QVector<int> InlinedView::topEntries(int n, int* total) const
+{
+    return _inlined.top(_eventType, n, total);
+}
+
+RankedListItem* InlinedView::newItem(int index, int skipped)
+{
+    if (skipped > 0)
+        return new InlinedItem(nullptr, skipped, &_inlined, index,
+                               _eventType, _groupType);
+    return new InlinedItem(nullptr, &_inlined, index, _eventType, _groupType);
+}
@@ -0,0 +1,53 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Inlined Hotspots View
+ */
+
+#ifndef INLINEDVIEW_H
+#define INLINEDVIEW_H
+
+#include "rankedlistview.h"
+#include "inlinedindex.h"
+
+/**
+ * List of source line ranges inlined into other functions, with cost
+ * summed up over all functions containing code from a range.
+ */
+class InlinedView: public RankedListView
+{
+    Q_OBJECT
+
+public:
+    explicit InlinedView(TraceItemView* parentView,
+                         QWidget* parent = nullptr);
+
+    QString whatsThis() const override;
+
+protected:
+    TraceData* listData() const override { return _inlined.data(); }
+    void calculate() override;
+    QVector<int> topEntries(int n, int* total) const override;
+    RankedListItem* newItem(int index, int skipped) override;
+
+private:
+    InlinedIndex _inlined;
+};
+
+#endif
@@ -39,6 +39,7 @@
 #include "config.h"
 #include "globalconfig.h"
 #include "instritem.h"
+#include "jumplanes.h"
 
 
 // InstrView defaults
@@ -622,6 +623,7 @@ void InstrView::refresh()
     }
     std::sort(_lowList.begin(), _lowList.end(), instrJumpLowLessThan);
     std::sort(_highList.begin(), _highList.end(), instrJumpHighLessThan);
+    assignJumpLanes(_lowList, _highList, getInstrJumpAddresses, _jumpLane);
     _lowListIter = _lowList.begin(); // iterators to list start
     _highListIter = _highList.begin();
     _arrowLevels = 0;
@@ -698,25 +700,19 @@ void InstrView::updateJumpArray(Addr addr, InstrItem* ii,
         // if this is another jump start, break
         if (ii->instrJump() && (ij != ii->instrJump())) break;
 
-#if 0
-        for(iStart=0;iStart<_arrowLevels;iStart++)
-            if (_jump[iStart] &&
-                (_jump[iStart]->instrTo() == ij->instrTo())) break;
-#else
-        iStart = _arrowLevels;
-#endif
-
-        if (iStart==_arrowLevels) {
-            for(iStart=0; iStart<_arrowLevels; ++iStart)
-                if (_jump[iStart] == nullptr) break;
-            if (iStart==_arrowLevels) {
-                _arrowLevels++;
-                _jump.resize(_arrowLevels);
-            }
-            if (0) qDebug("  new start at %d for %s",
-                          iStart, qPrintable(ij->name()));
-            _jump[iStart] = ij;
+        // lane was assigned in refresh(); without one, do not draw
+        if (!_jumpLane.contains(ij)) {
+            _lowListIter++;
+            continue;
+        }
+        iStart = _jumpLane.value(ij);
+        if (iStart >= _arrowLevels) {
+            _arrowLevels = iStart+1;
+            _jump.resize(_arrowLevels);
         }
+        if (0) qDebug("  new start at %d for %s",
+                      iStart, qPrintable(ij->name()));
+        _jump[iStart] = ij;
         _lowListIter++;
     }
 
@@ -734,13 +730,11 @@ void InstrView::updateJumpArray(Addr addr, InstrItem* ii,
 
         if (highAddr > addr) break;
 
-        for(iEnd=0; iEnd<_arrowLevels; ++iEnd)
-            if (_jump[iEnd] == ij) break;
-        if (iEnd==_arrowLevels) {
-            qDebug() << "InstrView: no jump start for end at 0x"
-                     << highAddr.toString() << " ?";
+        // only clear the slot if still used by this jump: if the row of
+        // the jump end was not shown, a following jump may have got the lane
+        iEnd = _jumpLane.value(ij, -1);
+        if ((iEnd < 0) || (iEnd >= _arrowLevels) || (_jump[iEnd] != ij))
             iEnd = -1;
-        }
 
         if (0 && (iEnd>=0))
             qDebug(" end %d (%s to %s)",
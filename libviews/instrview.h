@@ -23,6 +23,7 @@
 #ifndef INSTRVIEW_H
 #define INSTRVIEW_H
 
+#include <QHash>
 #include <QTreeWidget>
 
 #include "traceitemview.h"
@@ -72,6 +73,7 @@ private:
     int _arrowLevels;
     // temporary needed on creation...
     QVector<TraceInstrJump*> _jump;
+    QHash<TraceInstrJump*, int> _jumpLane;
     TraceInstrJumpList _lowList, _highList;
     TraceInstrJumpList::iterator _lowListIter, _highListIter;
 
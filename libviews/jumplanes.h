@@ -0,0 +1,89 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Lane assignment for jump arrows
+ */
+
+#ifndef JUMPLANES_H
+#define JUMPLANES_H
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include <QHash>
+#include <QList>
+
+/**
+ * Assign arrow lanes to jumps shown in SourceView/InstrView.
+ *
+ * <lowList> and <highList> are the jumps sorted by their lower and
+ * higher end position, as given by <bounds>. In one sweep over the
+ * jumps, each jump gets the lowest lane not used by any jump whose
+ * interval overlaps; lanes of jumps ending before the start of a
+ * jump are collected in a heap of free lanes.
+ * This takes O(J log J) for J jumps, instead of searching for a free
+ * lane on every row.
+ *
+ * Lanes are freed by position, but views only see jump ends on rows
+ * they show: when a jump starts, it takes over its lane even if the
+ * previous jump on that lane did not end on a shown row, and views
+ * clear a lane on a jump end only if it still holds that jump.
+ *
+ * Returns the number of lanes used.
+ */
+template<class Jump, class Pos>
+int assignJumpLanes(const QList<Jump*>& lowList,
+                    const QList<Jump*>& highList,
+                    void (*bounds)(const Jump*, Pos&, Pos&),
+                    QHash<Jump*, int>& lanes)
+{
+    std::priority_queue<int, std::vector<int>, std::greater<int> > freeLanes;
+    int laneCount = 0, h = 0;
+    Pos low, high, endLow, endHigh;
+
+    lanes.clear();
+    lanes.reserve(lowList.count());
+    foreach(Jump* j, lowList) {
+        bounds(j, low, high);
+
+        // release lanes of jumps ending before this one starts
+        while(h < highList.count()) {
+            Jump* e = highList.at(h);
+            bounds(e, endLow, endHigh);
+            if (!(endHigh < low)) break;
+            if (lanes.contains(e))
+                freeLanes.push(lanes.value(e));
+            h++;
+        }
+
+        int lane;
+        if (freeLanes.empty())
+            lane = laneCount++;
+        else {
+            lane = freeLanes.top();
+            freeLanes.pop();
+        }
+        lanes.insert(j, lane);
+    }
+
+    return laneCount;
+}
+
+#endif
@@ -20,13 +20,21 @@ NHEADERS += \
     $$PWD/costlistitem.h \
     $$PWD/coverageitem.h \
     $$PWD/coverageview.h \
+    $$PWD/hotlinesitem.h \
+    $$PWD/hotlinesview.h \
+    $$PWD/heatmapview.h \
+    $$PWD/inlineditem.h \
+    $$PWD/inlinedview.h \
     $$PWD/eventtypeitem.h \
     $$PWD/eventtypeview.h \
     $$PWD/instritem.h \
     $$PWD/instrview.h \
+    $$PWD/jumplanes.h \
     $$PWD/partgraph.h \
     $$PWD/partlistitem.h \
     $$PWD/partview.h \
+    $$PWD/rankedlistitem.h \
+    $$PWD/rankedlistview.h \
     $$PWD/sourceitem.h \
     $$PWD/sourceview.h \
     $$PWD/stackitem.h
@@ -44,6 +52,11 @@ SOURCES += \
     $$PWD/eventtypeview.cpp \
     $$PWD/functionlistmodel.cpp \
     $$PWD/functionselection.cpp \
+    $$PWD/hotlinesitem.cpp \
+    $$PWD/hotlinesview.cpp \
+    $$PWD/heatmapview.cpp \
+    $$PWD/inlineditem.cpp \
+    $$PWD/inlinedview.cpp \
     $$PWD/instritem.cpp \
     $$PWD/instrview.cpp \
     $$PWD/listutils.cpp \
@@ -52,6 +65,8 @@ SOURCES += \
     $$PWD/partlistitem.cpp \
     $$PWD/partselection.cpp \
     $$PWD/partview.cpp \
+    $$PWD/rankedlistitem.cpp \
+    $$PWD/rankedlistview.cpp \
     $$PWD/sourceitem.cpp \
     $$PWD/sourceview.cpp \
     $$PWD/stackitem.cpp \
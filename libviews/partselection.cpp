@@ -32,6 +32,8 @@
 #include "partgraph.h"
 #include "globalconfig.h"
 #include "config.h"
+#include "loadstats.h"
+#include "phasedetection.h"
 
 //
 // PartSelection
@@ -54,6 +56,7 @@ PartSelection::PartSelection( TopLevelBase* top,
     : QWidget(parent), TraceItemView(nullptr, top)
 {
     _inSelectionUpdate = false;
+    _phases = nullptr;
 
     setWindowTitle(tr("Parts Overview"));
 
@@ -101,6 +104,11 @@ PartSelection::PartSelection( TopLevelBase* top,
     setWhatsThis(whatsThis());
 }
 
+PartSelection::~PartSelection()
+{
+    delete _phases;
+}
+
 QString PartSelection::whatsThis() const
 {
     return tr( "<b>The Parts Overview</b>"
@@ -124,13 +132,21 @@ QString PartSelection::whatsThis() const
                "cost of the current selected function in the trace part "
                "is shown. "
                "This is split up into smaller rectangles to show the costs of its "
-               "callees.</li></ul></p>");
+               "callees.</li></ul></p>"
+               "<p>For many parts, e.g. time slices of one run, "
+               "the context menu allows to detect program phases: "
+               "ranges of parts with similar distribution of cost among "
+               "the most expensive functions. A phase can be selected "
+               "with one action.</p>");
 }
 
 void PartSelection::setData(TraceData* data)
 {
     TraceItemView::setData(data);
     _partAreaWidget->setData(data);
+
+    delete _phases;
+    _phases = nullptr;
 }
 
 
@@ -194,9 +210,14 @@ void PartSelection::doUpdate(int changeType, bool)
     if (changeType == eventType2Changed) return;
     if (changeType == selectedItemChanged) return;
 
-    if (changeType & eventTypeChanged)
+    if (changeType & eventTypeChanged) {
         _partAreaWidget->setEventType(_eventType);
 
+        // phases depend on the event type
+        delete _phases;
+        _phases = nullptr;
+    }
+
     if (changeType & groupTypeChanged)
         _partAreaWidget->setGroupType(_groupType);
 
@@ -340,6 +361,8 @@ void PartSelection::contextMenuRequested(TreeMapItem* i,
     QAction* selectAllPartsAction = nullptr;
     QAction* hidePartsAction = nullptr;
     QAction* showPartsAction = nullptr;
+    QAction* detectPhasesAction = nullptr;
+    QList<QAction*> phaseActions;
     if (_data && (_data->parts().count()>1)) {
         s = _partAreaWidget->possibleSelection(i);
         if (!s->text(0).isEmpty()) {
@@ -356,6 +379,26 @@ void PartSelection::contextMenuRequested(TreeMapItem* i,
         hidePartsAction = ppopup->addAction(tr("Hide Selected Parts"));
         showPartsAction = ppopup->addAction(tr("Show Hidden Parts"));
 
+        QMenu* phpopup = popup.addMenu(tr("Phases"));
+        detectPhasesAction = phpopup->addAction(_phases ?
+                                                tr("Detect Phases Again") :
+                                                tr("Detect Phases"));
+        if (_phases && (_phases->count() > 0)) {
+            phpopup->addSeparator();
+            int current = -1;
+            if (s && (s->rtti() == 2))
+                current = _phases->phaseOf(((PartItem*)s)->part());
+            for(int ph=0; ph<_phases->count(); ph++) {
+                str = tr("Select Phase %1: %2").arg(ph+1)
+                      .arg(GlobalConfig::shortenSymbol(_phases->phase(ph).name()));
+                a = phpopup->addAction(str);
+                a->setCheckable(true);
+                a->setChecked(ph == current);
+                a->setData(ph);
+                phaseActions.append(a);
+            }
+        }
+
         popup.addSeparator();
     }
 
@@ -434,6 +477,10 @@ void PartSelection::contextMenuRequested(TreeMapItem* i,
         TreeMapItemList list = *_partAreaWidget->base()->children();
         _partAreaWidget->setRangeSelection(list.first(), list.last(), true);
     }
+    else if (a == detectPhasesAction)
+        detectPhases();
+    else if (a && phaseActions.contains(a))
+        selectPhase(a->data().toInt());
     else if (a == hidePartsAction)
         emit partsHideSelected();
     else if (a == showPartsAction)
@@ -570,6 +617,7 @@ void PartSelection::fillInfo()
 {
     if (!_data) {
         _rangeLabel->setText(tr("(no trace loaded)"));
+        _rangeLabel->setToolTip(QString());
         return;
     }
 
@@ -592,6 +640,55 @@ void PartSelection::fillInfo()
     }
 
 
+    if (_phases && (_phases->count() > 0)) {
+        int ph = i ? _phases->phaseOf(((PartItem*)i)->part()) : -1;
+        if (ph >= 0)
+            info += ", " + tr("Phase %1 of %2").arg(ph+1).arg(_phases->count());
+        else
+            info += ", " + tr("%n Phases", "", _phases->count());
+    }
+
     _rangeLabel->setText(info);
+
+    LoadStatistics* stats = _data->loadStatistics();
+    _rangeLabel->setToolTip(stats ? stats->summary().join('\n') : QString());
+}
+
+void PartSelection::detectPhases()
+{
+    if (!_data) return;
+
+    if (!_phases) _phases = new PhaseDetection(_data);
+    _phases->setEventType(_eventType);
+    int count = _phases->detect();
+
+    if (_topLevel)
+        _topLevel->showMessage(tr("Detected %n phases in %1 parts", "", count)
+                               .arg(_data->parts().count()), 5000);
+    fillInfo();
 }
 
+/* Select exactly the parts of a phase.
+ * Only the last selection change triggers a parts update. */
+void PartSelection::selectPhase(int ph)
+{
+    if (!_phases || (ph < 0) || (ph >= _phases->count())) return;
+
+    const ProgramPhase& phase = _phases->phase(ph);
+    TreeMapItemList* list = _partAreaWidget->base()->children();
+    if (!list || list->isEmpty()) return;
+
+    // hidden parts have no item
+    TreeMapItem *first = nullptr, *last = nullptr;
+    foreach(TreeMapItem* i, *list) {
+        if (!phase.parts.contains(((PartItem*)i)->part())) continue;
+        if (!first) first = i;
+        last = i;
+    }
+    if (!first) return;
+
+    _inSelectionUpdate = true;
+    _partAreaWidget->setRangeSelection(list->first(), list->last(), false);
+    _inSelectionUpdate = false;
+    _partAreaWidget->setRangeSelection(first, last, true);
+}
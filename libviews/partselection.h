@@ -34,6 +34,7 @@ class QLabel;
 class TraceData;
 class TreeMapItem;
 class PartAreaWidget;
+class PhaseDetection;
 
 class PartSelection: public QWidget, public TraceItemView
 {
@@ -41,6 +42,7 @@ class PartSelection: public QWidget, public TraceItemView
 
 public:
     explicit PartSelection(TopLevelBase*, QWidget* parent = nullptr);
+    ~PartSelection() override;
 
     QWidget* widget() override { return this; }
     QString whatsThis() const override;
@@ -73,6 +75,9 @@ private:
     // helper for doUpdate
     void selectParts(const TracePartList& list);
     void fillInfo();
+    // detected phases of the part sequence
+    void detectPhases();
+    void selectPhase(int);
 
     bool _showInfo;
     bool _diagramMode;
@@ -81,6 +86,7 @@ private:
 
     PartAreaWidget* _partAreaWidget;
     QLabel* _rangeLabel;
+    PhaseDetection* _phases;
 };
 
 #endif
@@ -0,0 +1,151 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Items of ranked list views.
+ */
+
+#include "rankedlistitem.h"
+
+#include "globalguiconfig.h"
+#include "listutils.h"
+
+
+// RankedListItem
+
+RankedListItem::RankedListItem(QTreeWidget* parent, TraceData* data,
+                               TraceFile* file, uint lineno,
+                               TraceFunction* function, int functionCount)
+    : QTreeWidgetItem(parent)
+{
+    _skipped = 0;
+    _data = data;
+    _file = file;
+    _lineno = lineno;
+    _function = function;
+    _functionCount = functionCount;
+    _costType = nullptr;
+    _groupType = ProfileContext::InvalidType;
+
+    if (_function) {
+        QString name = _function->prettyName();
+        if (_functionCount > 1)
+            //~ singular %1 (and %n other)
+            //~ plural %1 (and %n others)
+            name = QObject::tr("%1 (and %n other(s))", "",
+                               _functionCount - 1).arg(name);
+        setText(3, name);
+    }
+
+    setTextAlignment(0, Qt::AlignRight);
+}
+
+RankedListItem::RankedListItem(QTreeWidget* parent, int skipped,
+                               TraceData* data)
+    : QTreeWidgetItem(parent)
+{
+    _skipped = skipped;
+    _data = data;
+    _file = nullptr;
+    _lineno = 0;
+    _function = nullptr;
+    _functionCount = 0;
+    _costType = nullptr;
+    _groupType = ProfileContext::InvalidType;
+
+    setTextAlignment(0, Qt::AlignRight);
+}
+
+bool RankedListItem::contains(TraceFile* file, uint lineno)
+{
+    return !_skipped && (file == _file) && (lineno == _lineno);
+}
+
+TraceLine* RankedListItem::line()
+{
+    if (_skipped || !_function || !_file) return nullptr;
+
+    return _function->line(_file, _lineno);
+}
+
+void RankedListItem::setGroupType(ProfileContext::Type gt)
+{
+    if (_skipped || !_function) return;
+    if (_groupType == gt) return;
+    _groupType = gt;
+
+    QColor c = GlobalGUIConfig::functionColor(_groupType, _function);
+    setIcon(3, colorPixmap(10, 10, c));
+}
+
+void RankedListItem::setCostType(EventType* ct)
+{
+    _costType = ct;
+    update();
+}
+
+void RankedListItem::update()
+{
+    _pure = _costType ? _cost.subCost(_costType) : SubCost(0);
+
+    if (_pure == 0) {
+        setText(0, QString());
+        setIcon(0, QPixmap());
+        return;
+    }
+
+    double total = _data->subCost(_costType);
+    QString str;
+    if (GlobalConfig::showPercentage())
+        str = QStringLiteral("%1")
+              .arg(100.0 * _pure / total, 0, 'f',
+                   GlobalConfig::percentPrecision());
+    else
+        str = _pure.pretty();
+
+    if (_skipped) {
+        setText(0, QStringLiteral("< %1").arg(str));
+        return;
+    }
+
+    setText(0, str);
+    setIcon(0, costPixmap(_costType, &_cost, total, false));
+}
+
+
+bool RankedListItem::operator<( const QTreeWidgetItem & other ) const
+{
+    const RankedListItem* ri1 = this;
+    const RankedListItem* ri2 = (RankedListItem*) &other;
+    int col = treeWidget()->sortColumn();
+
+    // a skip entry is always sorted last
+    if (ri1->_skipped) return true;
+    if (ri2->_skipped) return false;
+
+    if (col==0)
+        return ri1->_pure < ri2->_pure;
+
+    if (col==sourceColumn()) {
+        if (ri1->_file != ri2->_file)
+            return ri1->_file->shortName() < ri2->_file->shortName();
+        return ri1->_lineno < ri2->_lineno;
+    }
+
+    return QTreeWidgetItem::operator <(other);
+}
@@ -0,0 +1,74 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Items of ranked list views.
+ */
+
+#ifndef RANKEDLISTITEM_H
+#define RANKEDLISTITEM_H
+
+#include <QTreeWidget>
+#include "tracedata.h"
+
+/**
+ * Base for items of a RankedListView: an entry of a list with
+ * highest cost over the whole program, located at source lines of
+ * <file> starting at <lineno>, with <function> contributing most
+ * cost. Column 0 shows the cost, the last column (3) the function.
+ *
+ * A placeholder item stands for <skipped> entries not shown, and is
+ * always sorted last.
+ */
+class RankedListItem: public QTreeWidgetItem
+{
+public:
+    RankedListItem(QTreeWidget* parent, TraceData* data,
+                   TraceFile* file, uint lineno,
+                   TraceFunction* function, int functionCount);
+    RankedListItem(QTreeWidget* parent, int skipped, TraceData* data);
+
+    bool operator< ( const QTreeWidgetItem & other ) const override;
+    TraceFunction* function() { return (_skipped) ? nullptr : _function; }
+    // another function to go to from the context menu
+    virtual TraceFunction* relatedFunction() { return nullptr; }
+    TraceFile* file() { return (_skipped) ? nullptr : _file; }
+    uint lineno() { return _lineno; }
+    virtual bool contains(TraceFile* file, uint lineno);
+    // line object in data model (created on demand)
+    virtual TraceLine* line();
+    void setCostType(EventType* ct);
+    void setGroupType(ProfileContext::Type);
+    virtual void update();
+
+protected:
+    // column sorted by file name and line number
+    virtual int sourceColumn() const = 0;
+
+    ProfileCostArray _cost;
+    SubCost _pure;
+    EventType* _costType;
+    ProfileContext::Type _groupType;
+    TraceData* _data;
+    TraceFile* _file;
+    uint _lineno;
+    TraceFunction* _function;
+    int _functionCount, _skipped;
+};
+
+#endif
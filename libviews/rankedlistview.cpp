@@ -0,0 +1,237 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Ranked List View
+ */
+
+
+#include "rankedlistview.h"
+
+#include <QAction>
+#include <QMenu>
+#include <QHeaderView>
+#include <QKeyEvent>
+
+#include "globalconfig.h"
+#include "rankedlistitem.h"
+
+
+//
+// RankedListView
+//
+
+
+RankedListView::RankedListView(TraceItemView* parentView, QWidget* parent,
+                               int costColumns)
+    : QTreeWidget(parent), TraceItemView(parentView)
+{
+    _costColumns = costColumns;
+
+    // forbid scaling icon pixmaps to smaller size
+    setIconSize(QSize(99,99));
+    setAllColumnsShowFocus(true);
+    setRootIsDecorated(false);
+    setUniformRowHeights(true);
+    // sorting will be enabled after refresh()
+    sortByColumn(0, Qt::DescendingOrder);
+    setMinimumHeight(50);
+
+    connect( this,
+             &QTreeWidget::currentItemChanged,
+             this, &RankedListView::selectedSlot );
+
+    setContextMenuPolicy(Qt::CustomContextMenu);
+    connect( this,
+             &QWidget::customContextMenuRequested,
+             this, &RankedListView::context);
+
+    connect(this,
+            &QTreeWidget::itemDoubleClicked,
+            this, &RankedListView::activatedSlot);
+
+    connect(header(), &QHeaderView::sectionClicked,
+            this, &RankedListView::headerClicked);
+}
+
+void RankedListView::context(const QPoint & p)
+{
+    int c = columnAt(p.x());
+    QTreeWidgetItem* i = itemAt(p);
+    QMenu popup;
+
+    RankedListItem* item = (RankedListItem*) i;
+    TraceFunction* f = item ? item->function() : nullptr;
+    TraceFunction* rf = item ? item->relatedFunction() : nullptr;
+
+    QAction* activateFunctionAction = nullptr;
+    QAction* activateRelatedAction = nullptr;
+    if (f) {
+        QString menuText = tr("Go to '%1'").arg(GlobalConfig::shortenSymbol(f->prettyName()));
+        activateFunctionAction = popup.addAction(menuText);
+    }
+    if (rf) {
+        QString menuText = tr("Go to '%1'").arg(GlobalConfig::shortenSymbol(rf->prettyName()));
+        activateRelatedAction = popup.addAction(menuText);
+    }
+    if (f || rf)
+        popup.addSeparator();
+
+    if ((c >= 0) && (c < _costColumns)) {
+        addEventTypeMenu(&popup, false);
+        popup.addSeparator();
+    }
+    addGoMenu(&popup);
+
+    QAction* a = popup.exec(mapToGlobal(p + QPoint(0,header()->height())));
+    if (a == nullptr) return;
+    if (a == activateFunctionAction)
+        activateItem(i);
+    else if (a == activateRelatedAction)
+        TraceItemView::activated(rf);
+}
+
+void RankedListView::selectedSlot(QTreeWidgetItem* i, QTreeWidgetItem*)
+{
+    TraceLine* l = i ? ((RankedListItem*)i)->line() : nullptr;
+
+    if (l) {
+        _selectedItem = l;
+        selected(l);
+    }
+}
+
+void RankedListView::activatedSlot(QTreeWidgetItem* i, int)
+{
+    activateItem(i);
+}
+
+// activating an entry is done by activating its function and
+// selecting its line afterwards
+void RankedListView::activateItem(QTreeWidgetItem* i)
+{
+    RankedListItem* item = (RankedListItem*) i;
+    if (!item || !item->function()) return;
+
+    TraceItemView::activated(item->function());
+    TraceLine* l = item->line();
+    if (l) selected(l);
+}
+
+void RankedListView::headerClicked(int col)
+{
+    // other columns should be sortable in both ways
+    if (col >= _costColumns) return;
+
+    // cost columns only descending
+    sortByColumn(col, Qt::DescendingOrder);
+}
+
+void RankedListView::keyPressEvent(QKeyEvent* event)
+{
+    QTreeWidgetItem *item = currentItem();
+    if (item && ((event->key() == Qt::Key_Return) ||
+                 (event->key() == Qt::Key_Space)))
+    {
+        activateItem(item);
+    }
+    QTreeView::keyPressEvent(event);
+}
+
+CostItem* RankedListView::canShow(CostItem* i)
+{
+    // the list does not depend on the active item
+    return data() ? i : nullptr;
+}
+
+void RankedListView::doUpdate(int changeType, bool)
+{
+    // Special case ?
+    if (changeType == selectedItemChanged) {
+
+        if (!_selectedItem) {
+            clearSelection();
+            return;
+        }
+
+        TraceLine* sLine = nullptr;
+        if (_selectedItem->type() == ProfileContext::Line)
+            sLine = (TraceLine*) _selectedItem;
+        if (_selectedItem->type() == ProfileContext::Instr)
+            sLine = ((TraceInstr*)_selectedItem)->line();
+        if (!sLine || !sLine->functionSource()) return;
+
+        TraceFile* file = sLine->functionSource()->file();
+        RankedListItem* item;
+        for (int i=0; i<topLevelItemCount(); i++) {
+            item = (RankedListItem*) topLevelItem(i);
+            if (item->contains(file, sLine->lineno())) {
+                if (item == currentItem()) return;
+                scrollToItem(item);
+                setCurrentItem(item);
+                break;
+            }
+        }
+        return;
+    }
+
+    if (changeType == groupTypeChanged) {
+        for (int i=0; i<topLevelItemCount();i++)
+            ((RankedListItem*)topLevelItem(i))->setGroupType(_groupType);
+        return;
+    }
+
+    // the list only depends on data and active parts
+    if ((changeType == activeItemChanged) &&
+        (listData() == _data))
+        return;
+
+    if ((changeType & (dataChanged | partsChanged)) ||
+        (listData() != _data))
+        calculate();
+
+    refresh();
+}
+
+void RankedListView::refresh()
+{
+    clear();
+
+    if (!_data || !_eventType) return;
+
+    int total;
+    QVector<int> top = topEntries(GlobalConfig::maxListCount(), &total);
+
+    QList<QTreeWidgetItem*> items;
+    foreach(int i, top)
+        items.append(newItem(i, 0));
+
+    if (total > top.count()) {
+        // a placeholder for all the entries skipped ...
+        items.append(newItem(top.last(), total - top.count()));
+    }
+
+    // when inserting, switch off sorting for performance reason
+    setSortingEnabled(false);
+    addTopLevelItems(items);
+    setSortingEnabled(true);
+    // enabling sorting switches on the indicator, but we want it off
+    header()->setSortIndicatorShown(false);
+    // resize to content now (section size still can be interactively changed)
+    header()->resizeSections(QHeaderView::ResizeToContents);
+}
@@ -0,0 +1,80 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2016 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Ranked List View
+ */
+
+#ifndef RANKEDLISTVIEW_H
+#define RANKEDLISTVIEW_H
+
+#include <QTreeWidget>
+
+#include "tracedata.h"
+#include "traceitemview.h"
+
+class RankedListItem;
+
+/**
+ * Base for lists of source positions with highest cost of the whole
+ * program, independent from the active function, limited to
+ * GlobalConfig::maxListCount() entries plus a placeholder item.
+ * The list is recalculated on data or part changes only.
+ *
+ * Subclasses provide the column labels, the index of entries and
+ * the items (see RankedListItem). The first <costColumns> columns
+ * show costs and are only sorted descending.
+ */
+class RankedListView: public QTreeWidget, public TraceItemView
+{
+    Q_OBJECT
+
+public:
+    RankedListView(TraceItemView* parentView, QWidget* parent,
+                   int costColumns);
+
+    QWidget* widget() override { return this; }
+
+protected Q_SLOTS:
+    void context(const QPoint &);
+    void selectedSlot(QTreeWidgetItem*, QTreeWidgetItem*);
+    void activatedSlot(QTreeWidgetItem*, int);
+    void headerClicked(int);
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+
+    // data the index of entries was calculated for
+    virtual TraceData* listData() const = 0;
+    // recalculate the index of entries for current data
+    virtual void calculate() = 0;
+    // up to <n> entries with highest cost, <total> set to count with cost
+    virtual QVector<int> topEntries(int n, int* total) const = 0;
+    // item for entry <index>, or placeholder for <skipped> entries
+    virtual RankedListItem* newItem(int index, int skipped) = 0;
+    virtual void refresh();
+
+private:
+    CostItem* canShow(CostItem*) override;
+    void doUpdate(int, bool) override;
+    void activateItem(QTreeWidgetItem*);
+
+    int _costColumns;
+};
+
+#endif
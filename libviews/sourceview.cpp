@@ -34,6 +34,7 @@
 
 #include "globalconfig.h"
 #include "sourceitem.h"
+#include "jumplanes.h"
 
 
 
@@ -461,32 +462,23 @@ void SourceView::updateJumpArray(uint lineno, SourceItem* si,
 
         if (si->lineJump() && (lj != si->lineJump())) break;
 
-        int asize = (int)_jump.size();
-#if 0
-        for(iStart=0;iStart<asize;iStart++)
-            if (_jump[iStart] &&
-                (_jump[iStart]->lineTo() == lj->lineTo())) break;
-#else
-        iStart = asize;
-#endif
-
-        if (iStart == asize) {
-            for(iStart=0; iStart<asize; ++iStart)
-                if (_jump[iStart] == nullptr) break;
-
-            if (iStart== asize) {
-                asize++;
-                _jump.resize(asize);
-                if (asize > _arrowLevels) _arrowLevels = asize;
-            }
+        // lane was assigned in fillSourceFile(); without one, do not draw
+        if (!_jumpLane.contains(lj)) {
+            _lowListIter++;
+            continue;
+        }
+        iStart = _jumpLane.value(lj);
+        if (iStart >= (int)_jump.size()) {
+            _jump.resize(iStart+1);
+            if (iStart+1 > _arrowLevels) _arrowLevels = iStart+1;
+        }
 
-            if (0) qDebug(" start %d (%s to %s)",
-                          iStart,
-                          qPrintable(lj->lineFrom()->name()),
-                          qPrintable(lj->lineTo()->name()));
+        if (0) qDebug(" start %d (%s to %s)",
+                      iStart,
+                      qPrintable(lj->lineFrom()->name()),
+                      qPrintable(lj->lineTo()->name()));
 
-            _jump[iStart] = lj;
-        }
+        _jump[iStart] = lj;
         _lowListIter++;
     }
 
@@ -503,12 +495,11 @@ void SourceView::updateJumpArray(uint lineno, SourceItem* si,
 
         if (highLineno > lineno) break;
 
-        for(iEnd=0; iEnd< (int)_jump.size(); ++iEnd)
-            if (_jump[iEnd] == lj) break;
-        if (iEnd == (int)_jump.size()) {
-            qDebug("LineView: no jump start for end at %x ?", highLineno);
+        // only clear the slot if still used by this jump: if the row of
+        // the jump end was not shown, a following jump may have got the lane
+        iEnd = _jumpLane.value(lj, -1);
+        if ((iEnd < 0) || (iEnd >= (int)_jump.size()) || (_jump[iEnd] != lj))
             iEnd = -1;
-        }
 
         if (0 && (iEnd>=0))
             qDebug(" end %d (%s to %s)",
@@ -735,6 +726,7 @@ void SourceView::fillSourceFile(TraceFunctionSource* sf, int fileno)
     }
     std::sort(_lowList.begin(), _lowList.end(), lineJumpLowLessThan);
     std::sort(_highList.begin(), _highList.end(), lineJumpHighLessThan);
+    assignJumpLanes(_lowList, _highList, getJumpLines, _jumpLane);
     _lowListIter = _lowList.begin(); // iterators to list start
     _highListIter = _highList.begin();
     _jump.resize(0);
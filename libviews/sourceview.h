@@ -23,6 +23,7 @@
 #ifndef SOURCEVIEW_H
 #define SOURCEVIEW_H
 
+#include <QHash>
 #include <QTreeWidget>
 #include "traceitemview.h"
 
@@ -65,6 +66,7 @@ private:
     int _arrowLevels;
     // temporary needed on creation...
     QVector<TraceLineJump*> _jump;
+    QHash<TraceLineJump*, int> _jumpLane;
     TraceLineJumpList _lowList, _highList;
     TraceLineJumpList::iterator _lowListIter, _highListIter;
 };
@@ -47,6 +47,9 @@
 #include "instrview.h"
 #include "sourceview.h"
 #include "callgraphview.h"
+#include "hotlinesview.h"
+#include "inlinedview.h"
+#include "heatmapview.h"
 
 
 // defaults for subviews in TabView
@@ -56,7 +59,8 @@
     << "CalleeMapView" << "SourceView"
 #define DEFAULT_BOTTOMTABS \
     "PartView" << "CalleeView" << "CallGraphView" \
-    << "AllCalleeView" << "CallerMapView" << "InstrView"
+    << "AllCalleeView" << "CallerMapView" << "InstrView" \
+    << "HotLinesView" << "InlinedView" << "HeatmapView"
 
 #define DEFAULT_ACTIVETOP "CallerView"
 #define DEFAULT_ACTIVEBOTTOM "CalleeView"
@@ -364,6 +368,9 @@ TabView::TabView(TraceItemView* parentView, QWidget* parent)
     SourceView* sourceView = new SourceView(this);
     InstrView* instrView = new InstrView(this);
     PartView* partView = new PartView(this);
+    HotLinesView* hotLinesView = new HotLinesView(this);
+    InlinedView* inlinedView = new InlinedView(this);
+    HeatmapView* heatmapView = new HeatmapView(this);
 
     // Options of visualization views are stored by their view name
     callerView->setObjectName(QStringLiteral("CallerView"));
@@ -373,6 +380,9 @@ TabView::TabView(TraceItemView* parentView, QWidget* parent)
     sourceView->setObjectName(QStringLiteral("SourceView"));
     instrView->setObjectName(QStringLiteral("InstrView"));
     partView->setObjectName(QStringLiteral("PartView"));
+    hotLinesView->setObjectName(QStringLiteral("HotLinesView"));
+    inlinedView->setObjectName(QStringLiteral("InlinedView"));
+    heatmapView->setObjectName(QStringLiteral("HeatmapView"));
 
     // default positions...
     // Keep following order in sync with DEFAULT_xxxTABS defines!
@@ -397,6 +407,9 @@ TabView::TabView(TraceItemView* parentView, QWidget* parent)
                        new CallMapView(true, this, nullptr,
                                        "CallerMapView")));
     addBottom( addTab( tr("Machine Code"), instrView) );
+    addBottom( addTab( tr("Hot Lines"), hotLinesView) );
+    addBottom( addTab( tr("Inlined Hotspots"), inlinedView) );
+    addBottom( addTab( tr("Heatmap"), heatmapView) );
 
     // after all child widgets are created...
     _lastFocus = nullptr;
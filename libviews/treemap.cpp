@@ -36,6 +36,7 @@
 #include <QShowEvent>
 #include <QContextMenuEvent>
 #include <QMouseEvent>
+#include <QHash>
 #include <QToolTip>
 #include <QStylePainter>
 #include <QStyleOptionFocusRect>
@@ -465,14 +466,202 @@ int findBreakBackwards(int& breakPos, QString text, QFontMetrics* fm, int maxWid
 
 
 
+//---------------------------------------------------
+// TextLayoutCache
+
+/*
+ * Key for a field text laid out into given space: the text, the font,
+ * the width of the pixmap drawn in front, the width available in the
+ * first line and in following lines, the number of lines, and flags.
+ * Widths are exact, as breaks and truncation depend on every pixel.
+ */
+struct TextLayoutKey
+{
+    enum { Bottom = 1, AllowBreak = 2, AllowTruncation = 4 };
+
+    QString text;
+    QFont font;
+    int pixW, unused, width, lines, flags;
+
+    bool operator==(const TextLayoutKey& k) const
+    {
+        return (pixW == k.pixW) && (unused == k.unused) &&
+                (width == k.width) && (lines == k.lines) &&
+                (flags == k.flags) && (text == k.text) && (font == k.font);
+    }
+};
+
+inline uint qHash(const TextLayoutKey& k)
+{
+    uint h = qHash(k.text) ^ qHash(k.font);
+    h = 31 * h + (uint)k.pixW;
+    h = 31 * h + (uint)k.unused;
+    h = 31 * h + (uint)k.width;
+    return h ^ ((uint)(k.lines << 3) | (uint)k.flags) * 0x9e3779b9u;
+}
+
+/*
+ * Text runs of a field, one per line, with width including the pixmap.
+ * An empty text means that only the pixmap fits.
+ */
+struct TextLayout
+{
+    QStringList text;
+    QVector<int> width;
+};
+
+/*
+ * Text layout for drawField() needs lots of font metric calls.
+ * The results are shared by all RectDrawing objects: a repaint e.g.
+ * after a selection or hover change lays out the same texts into the
+ * same space, and does no text measurement at all with this cache.
+ * Measurement uses metrics of the font in the key, never those of
+ * the caller. Only used from the GUI thread.
+ */
+class TextLayoutCache
+{
+public:
+    // entries kept before starting from scratch
+    enum { MaxEntries = 20000 };
+
+    static int width(const QFont&, const QString&);
+    static const TextLayout& layout(const TextLayoutKey&);
+
+private:
+    // metrics for <font>, rebuilt only if the font changes
+    static QFontMetrics* metrics(const QFont& font);
+    static void layoutText(TextLayout&, const TextLayoutKey&);
+
+    static QHash<QPair<QString, QFont>, int> _width;
+    static QHash<TextLayoutKey, TextLayout> _layout;
+    // created on first use: QFont needs the application object
+    static QFont* _metricsFont;
+    static QFontMetrics* _metrics;
+};
+
+QHash<QPair<QString, QFont>, int> TextLayoutCache::_width;
+QHash<TextLayoutKey, TextLayout> TextLayoutCache::_layout;
+QFont* TextLayoutCache::_metricsFont = nullptr;
+QFontMetrics* TextLayoutCache::_metrics = nullptr;
+
+QFontMetrics* TextLayoutCache::metrics(const QFont& font)
+{
+    if (!_metricsFont || (*_metricsFont != font)) {
+        delete _metricsFont;
+        delete _metrics;
+        _metricsFont = new QFont(font);
+        _metrics = new QFontMetrics(font);
+    }
+    return _metrics;
+}
+
+int TextLayoutCache::width(const QFont& font, const QString& text)
+{
+    QPair<QString, QFont> key(text, font);
+    QHash<QPair<QString, QFont>, int>::const_iterator it = _width.constFind(key);
+    if (it != _width.constEnd()) return it.value();
+
+    if (_width.count() >= MaxEntries) _width.clear();
+    int w = metrics(font)->boundingRect(text).width();
+    _width.insert(key, w);
+    return w;
+}
+
+const TextLayout& TextLayoutCache::layout(const TextLayoutKey& key)
+{
+    QHash<TextLayoutKey, TextLayout>::const_iterator it = _layout.constFind(key);
+    if (it != _layout.constEnd()) return it.value();
+
+    if (_layout.count() >= MaxEntries) _layout.clear();
+    TextLayout& l = _layout[key];
+    layoutText(l, key);
+    return l;
+}
+
+/* loop over name parts to break up string depending on available width.
+ * every char category change is supposed a possible break,
+ * with the exception Uppercase=>Lowercase.
+ * It is good enough for numbers, Symbols...
+ *
+ * If the text is to be written at the bottom, we start with the
+ * end of the string (so everything is reverted)
+ */
+void TextLayoutCache::layoutText(TextLayout& l, const TextLayoutKey& key)
+{
+    QFontMetrics* fm = metrics(key.font);
+    bool isBottom = (key.flags & TextLayoutKey::Bottom);
+    int pixW = key.pixW;
+    QString name = key.text;
+    QString remaining;
+    int w = pixW + width(key.font, name);
+    int unusedWidth = key.unused;
+    int lines = key.lines;
+    while (lines>0) {
+
+        // more than one line: search for line break
+        if ((key.flags & TextLayoutKey::AllowBreak) &&
+            w>unusedWidth && lines>1) {
+            int breakPos;
+
+            if (!isBottom) {
+                w = pixW + findBreak(breakPos, name, fm, unusedWidth - pixW);
+
+                remaining = name.mid(breakPos);
+                // remove space on break point
+                if (name[breakPos-1].category() == QChar::Separator_Space)
+                    name = name.left(breakPos-1);
+                else
+                    name.truncate(breakPos);
+            }
+            else { // bottom
+                w = pixW + findBreakBackwards(breakPos, name, fm, unusedWidth - pixW);
+
+                remaining = name.left(breakPos);
+                // remove space on break point
+                if (name[breakPos].category() == QChar::Separator_Space)
+                    name = name.mid(breakPos+1);
+                else
+                    name = name.mid(breakPos);
+            }
+        }
+        else
+            remaining = QString();
+
+        /* truncate and add ... if needed */
+        if ((key.flags & TextLayoutKey::AllowTruncation) && w > unusedWidth) {
+            name = fm->elidedText(name, Qt::ElideRight, unusedWidth - pixW);
+            w = fm->boundingRect(name).width() + pixW;
+        }
+
+        if (w > unusedWidth) {
+            name = QString();
+            w = pixW;
+        }
+
+        l.text.append(name);
+        l.width.append(w);
+        lines--;
+
+        if (remaining.isEmpty()) break;
+        name = remaining;
+        w = pixW + width(key.font, name);
+        unusedWidth = key.width;
+    }
+}
+
+
 bool RectDrawing::drawField(QPainter* p, int f, DrawParams* dp)
 {
     if (!dp) dp = drawParams();
 
-    if (!_fm) {
-        _fm = new QFontMetrics(dp->font());
-        _fontHeight = _fm->height();
+    if (!_fm || (_font != dp->font())) {
+        delete _fm;
+        _font = dp->font();
+        _fm = new QFontMetrics(_font);
+        _dotWidth = _fm->boundingRect(QStringLiteral("...")).width();
     }
+    // reset by setRect()
+    _fontHeight = _fm->height();
 
     QRect r = _rect;
 
@@ -611,8 +800,7 @@ bool RectDrawing::drawField(QPainter* p, int f, DrawParams* dp)
     }
 
     // stop as soon as possible when there is no space for "..."
-    static int dotW = 0;
-    if (!dotW) dotW = _fm->boundingRect(QStringLiteral("...")).width();
+    int dotW = _dotWidth;
     if (width < dotW) return false;
 
     // get text and pixmap now, only if we need to, because it is possible
@@ -637,7 +825,7 @@ bool RectDrawing::drawField(QPainter* p, int f, DrawParams* dp)
     }
 
     // width of text and pixmap to be drawn
-    int w = pixW + _fm->boundingRect(name).width();
+    int w = pixW + TextLayoutCache::width(_font, name);
 
     if (0) qDebug() << "  For '" << name << "': Unused " << unused
                     << ", StrW " << w << ", Width " << width;
@@ -673,57 +861,23 @@ bool RectDrawing::drawField(QPainter* p, int f, DrawParams* dp)
     else
         p->translate(r.x()+2, r.y());
 
-    /* loop over name parts to break up string depending on available width.
-     * every char category change is supposed a possible break,
-     * with the exception Uppercase=>Lowercase.
-     * It is good enough for numbers, Symbols...
-     *
-     * If the text is to be written at the bottom, we start with the
-     * end of the string (so everything is reverted)
-     */
-    QString remaining;
+    TextLayoutKey key;
+    key.text = name;
+    key.font = _font;
+    key.pixW = pixW;
+    key.unused = unused;
+    key.width = width;
+    key.lines = lines;
+    key.flags = (isBottom ? TextLayoutKey::Bottom : 0) |
+                (dp->allowBreak(f) ? TextLayoutKey::AllowBreak : 0) |
+                (dp->allowTruncation(f) ? TextLayoutKey::AllowTruncation : 0);
+    const TextLayout& layout = TextLayoutCache::layout(key);
+
     int origLines = lines;
     int unusedWidth = unused;
-    while (lines>0) {
-
-        // more than one line: search for line break
-        if (dp->allowBreak(f) && w>unusedWidth && lines>1) {
-            int breakPos;
-
-            if (!isBottom) {
-                w = pixW + findBreak(breakPos, name, _fm, unusedWidth - pixW);
-
-                remaining = name.mid(breakPos);
-                // remove space on break point
-                if (name[breakPos-1].category() == QChar::Separator_Space)
-                    name = name.left(breakPos-1);
-                else
-                    name.truncate(breakPos);
-            }
-            else { // bottom
-                w = pixW + findBreakBackwards(breakPos, name, _fm, unusedWidth - pixW);
-
-                remaining = name.left(breakPos);
-                // remove space on break point
-                if (name[breakPos].category() == QChar::Separator_Space)
-                    name = name.mid(breakPos+1);
-                else
-                    name = name.mid(breakPos);
-            }
-        }
-        else
-            remaining = QString();
-
-        /* truncate and add ... if needed */
-        if (dp->allowTruncation(f) && w > unusedWidth) {
-            name = _fm->elidedText(name, Qt::ElideRight, unusedWidth - pixW);
-            w = _fm->boundingRect(name).width() + pixW;
-        }
-
-        if (w > unusedWidth) {
-            name = QString();
-            w = pixW;
-        }
+    for(int i=0; i<layout.text.count(); i++) {
+        name = layout.text.at(i);
+        w = layout.width.at(i);
 
         int x = 0;
         if (isCenter)
@@ -751,10 +905,6 @@ bool RectDrawing::drawField(QPainter* p, int f, DrawParams* dp)
                      Qt::AlignLeft, name);
         y = isBottom ? (y-h) : (y+h);
         lines--;
-
-        if (remaining.isEmpty()) break;
-        name = remaining;
-        w = pixW + _fm->boundingRect(name).width();
         unusedWidth = width;
     }
 
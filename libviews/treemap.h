@@ -195,8 +195,9 @@ private:
     int _usedBottomLeft, _usedBottomCenter, _usedBottomRight;
     QRect _rect;
 
-    // temporary
-    int _fontHeight;
+    // temporary, for the font of last drawField() call
+    QFont _font;
+    int _fontHeight, _dotWidth;
     QFontMetrics* _fm;
     DrawParams* _dp;
 };